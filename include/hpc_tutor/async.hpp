@@ -0,0 +1,372 @@
+#ifndef HPC_TUTOR_ASYNC_HPP_
+#define HPC_TUTOR_ASYNC_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define HPC_TUTOR_HAS_COROUTINES 1
+#endif
+
+#include "linalg.hpp"
+#include "linalg_t.hpp"
+#include "matrix_view.hpp"
+#include "thread_pool.hpp"
+
+namespace tutor {
+
+/**
+ * Memory Access of an Asynchronous Task.
+ *
+ * Describes a region that a task reads or writes.
+ * Two tasks conflict if their regions overlap and at least one writes.
+ * A task waits for every conflicting task submitted before it.
+ *
+ * The region of a MatrixView is the range of memory
+ * between its first and last element,
+ * so views with a row stride may produce false conflicts
+ * but never miss a real one.
+ */
+struct Access {
+  const char* begin;
+  const char* end;
+  bool write;
+
+  template <typename T>
+  static Access Read(const T* data, size_t n) {
+    return Region(data, n, false);
+  }
+
+  template <typename T>
+  static Access Write(T* data, size_t n) {
+    return Region(data, n, true);
+  }
+
+  template <typename T>
+  static Access Read(const MatrixView<T>& m) {
+    return Region(m.data(), Extent(m), false);
+  }
+
+  template <typename T>
+  static Access Write(const MatrixView<T>& m) {
+    return Region(m.data(), Extent(m), true);
+  }
+
+  [[nodiscard]] bool ConflictsWith(const Access& other) const noexcept {
+    return (write || other.write) && begin < other.end && other.begin < end;
+  }
+
+ private:
+  template <typename T>
+  static Access Region(const T* data, size_t n, bool write) {
+    const char* p = reinterpret_cast<const char*>(data);
+    return Access{p, p + n * sizeof(T), write};
+  }
+
+  template <typename T>
+  static size_t Extent(const MatrixView<T>& m) {
+    return m.empty() ? 0 : (m.rows() - 1) * m.rowStride() + m.cols();
+  }
+};
+
+namespace detail {
+
+/**
+ * Node of the dynamic task graph built by `Async`.
+ *
+ * A node runs once all the conflicting nodes submitted before it finish.
+ * The node keeps itself alive while it is queued in the pool.
+ */
+struct AsyncNode : Job {
+  ThreadPool* pool = nullptr;
+  std::function<void()> body;
+  std::vector<Access> accesses;
+  std::atomic<size_t> pending{1};
+  std::shared_ptr<AsyncNode> self;
+
+  // Guarded by AsyncGraph::mutex.
+  std::vector<std::shared_ptr<AsyncNode>> successors;
+
+  std::atomic<bool> done{false};
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::function<void()>> continuations;
+
+  AsyncNode() : Job{&AsyncNode::Run} {}
+
+  static void Run(Job* job);
+
+  void Release() {
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      pool->Submit(this);
+    }
+  }
+};
+
+/**
+ * Tracks the nodes in flight to derive the dependencies of new ones.
+ */
+class AsyncGraph {
+ public:
+  static AsyncGraph& Global() {
+    static AsyncGraph graph;
+    return graph;
+  }
+
+  void Launch(std::shared_ptr<AsyncNode> node) {
+    node->self = node;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& other : inFlight_) {
+        if (Conflict(*node, *other)) {
+          node->pending.fetch_add(1, std::memory_order_relaxed);
+          other->successors.push_back(node);
+        }
+      }
+      inFlight_.push_back(node);
+    }
+    node->Release();
+  }
+
+  void Finish(AsyncNode* node) {
+    std::vector<std::shared_ptr<AsyncNode>> successors;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      successors.swap(node->successors);
+      auto it = std::find_if(inFlight_.begin(), inFlight_.end(),
+                             [&](const auto& n) { return n.get() == node; });
+      std::swap(*it, inFlight_.back());
+      inFlight_.pop_back();
+    }
+    for (auto& s : successors) s->Release();
+  }
+
+ private:
+  static bool Conflict(const AsyncNode& a, const AsyncNode& b) {
+    for (const auto& x : a.accesses) {
+      for (const auto& y : b.accesses) {
+        if (x.ConflictsWith(y)) return true;
+      }
+    }
+    return false;
+  }
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<AsyncNode>> inFlight_;
+};
+
+inline void AsyncNode::Run(Job* job) {
+  auto* node = static_cast<AsyncNode*>(job);
+  node->body();
+  node->body = nullptr;
+  AsyncGraph::Global().Finish(node);
+  std::vector<std::function<void()>> continuations;
+  {
+    std::lock_guard<std::mutex> lock(node->mutex);
+    node->done.store(true, std::memory_order_release);
+    continuations.swap(node->continuations);
+  }
+  node->cv.notify_all();
+  for (auto& c : continuations) c();
+  // May destroy the node.
+  node->self.reset();
+}
+
+template <typename T>
+struct AsyncResult {
+  T value{};
+  template <typename F>
+  void Compute(F& f) {
+    value = f();
+  }
+  T Take() { return std::move(value); }
+};
+
+template <>
+struct AsyncResult<void> {
+  template <typename F>
+  void Compute(F& f) {
+    f();
+  }
+  void Take() {}
+};
+
+template <typename T>
+struct AsyncState {
+  std::shared_ptr<AsyncNode> node;
+  AsyncResult<T> result;
+  std::exception_ptr error;
+};
+
+}  // namespace detail
+
+/**
+ * Result of an Asynchronous Call.
+ *
+ * A Future refers to a task launched by `Async` or one of the `...Async`
+ * routines. Waiting on a future from a pool thread runs other pending
+ * tasks meanwhile, so it never blocks a worker.
+ * With C++20 coroutines a future can also be `co_await`ed;
+ * the coroutine is resumed by the thread that completes the task.
+ */
+template <typename T>
+class Future {
+ public:
+  Future() = default;
+
+  explicit Future(std::shared_ptr<detail::AsyncState<T>> state)
+      : state_(std::move(state)) {}
+
+  /**
+   * Checks if the future refers to a task.
+   */
+  [[nodiscard]] bool valid() const noexcept { return state_ != nullptr; }
+
+  /**
+   * Checks if the task has finished.
+   */
+  [[nodiscard]] bool ready() const noexcept {
+    return state_->node->done.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Waits for the task to finish.
+   */
+  void wait() const {
+    detail::AsyncNode* node = state_->node.get();
+    node->pool->HelpUntil([node] {
+      return node->done.load(std::memory_order_acquire);
+    });
+  }
+
+  /**
+   * Waits for the task and returns its result.
+   * Rethrows the exception thrown by the task, if any.
+   * The future is no longer valid after the call.
+   */
+  T get() {
+    wait();
+    auto state = std::move(state_);
+    if (state->error) std::rethrow_exception(state->error);
+    return state->result.Take();
+  }
+
+#ifdef HPC_TUTOR_HAS_COROUTINES
+  bool await_ready() const noexcept { return ready(); }
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    detail::AsyncNode* node = state_->node.get();
+    std::lock_guard<std::mutex> lock(node->mutex);
+    if (node->done.load(std::memory_order_relaxed)) return false;
+    node->continuations.emplace_back([h] { h.resume(); });
+    return true;
+  }
+
+  T await_resume() { return get(); }
+#endif
+
+ private:
+  std::shared_ptr<detail::AsyncState<T>> state_;
+};
+
+/**
+ * Launches `f()` on `pool` as a task that accesses the given regions.
+ *
+ * The task starts once every task submitted earlier
+ * with a conflicting access has finished.
+ */
+template <typename F>
+auto Async(ThreadPool& pool, std::initializer_list<Access> accesses, F&& f)
+    -> Future<std::invoke_result_t<F>> {
+  using R = std::invoke_result_t<F>;
+  auto state = std::make_shared<detail::AsyncState<R>>();
+  auto node = std::make_shared<detail::AsyncNode>();
+  node->pool = &pool;
+  node->accesses.assign(accesses.begin(), accesses.end());
+  // The body is dropped once run, which breaks the state -> node cycle.
+  node->body = [s = state, f = std::forward<F>(f)]() mutable {
+    try {
+      s->result.Compute(f);
+    } catch (...) {
+      s->error = std::current_exception();
+    }
+  };
+  state->node = node;
+  detail::AsyncGraph::Global().Launch(std::move(node));
+  return Future<R>(std::move(state));
+}
+
+/**
+ * Launches `f()` on the global pool as a task that accesses the given regions.
+ */
+template <typename F>
+auto Async(std::initializer_list<Access> accesses, F&& f) {
+  return Async(ThreadPool::Global(), accesses, std::forward<F>(f));
+}
+
+/**
+ * Element Search in Vector (asynchronous).
+ */
+template <typename T>
+Future<size_t> FindAsync(T* v, size_t n, T val) {
+  auto& pool = ThreadPool::Global();
+  return Async(pool, {Access::Read(v, n)},
+               [&pool, v, n, val] { return Find_t(pool, v, n, val); });
+}
+
+/**
+ * Vector (Merge)Sort (asynchronous).
+ */
+template <typename T>
+Future<void> MergeSortAsync(T* v, size_t n) {
+  return Async({Access::Write(v, n)}, [v, n] { MergeSort(v, n); });
+}
+
+/**
+ * Matrix by Vector Multiplication (asynchronous).
+ */
+template <typename T>
+Future<void> MatrixEvalAsync(T* ret, const MatrixView<T>& m, const T* v) {
+  auto& pool = ThreadPool::Global();
+  return Async(pool,
+               {Access::Write(ret, m.rows()), Access::Read(m),
+                Access::Read(v, m.cols())},
+               [&pool, ret, m, v] { MatrixEval_t(pool, ret, m, v); });
+}
+
+/**
+ * General Matrix Multiplication (asynchronous).
+ *
+ * Adds (not stores) `lhs * rhs` to `ret` once the call runs.
+ */
+template <typename T>
+Future<void> GemmAsync(MatrixView<T> ret, const MatrixView<T>& lhs,
+                       const MatrixView<T>& rhs) {
+  auto& pool = ThreadPool::Global();
+  return Async(pool,
+               {Access::Write(ret), Access::Read(lhs), Access::Read(rhs)},
+               [&pool, ret, lhs, rhs] { Gemm_t(pool, ret, lhs, rhs); });
+}
+
+/**
+ * Transposes a matrix in place (asynchronous).
+ */
+template <typename T>
+Future<void> TransposeAsync(MatrixView<T> m) {
+  return Async({Access::Write(m)}, [m] { Transpose(m); });
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_ASYNC_HPP_
@@ -0,0 +1,283 @@
+#ifndef HPC_TUTOR_BASELINE_HPP_
+#define HPC_TUTOR_BASELINE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tutor {
+
+/**
+ * Result of a one-sided Mann-Whitney U test.
+ */
+struct RankTest {
+  double u = 0;  ///< Pairs (x[i], y[j]) with x[i] > y[j], ties count 1/2.
+  double z = 0;  ///< Standard score of `u`.
+  double pGreater = 1;  ///< P-value of "x tends to be larger than y".
+  double pLess = 1;     ///< P-value of "x tends to be smaller than y".
+};
+
+/**
+ * Mann-Whitney U test of samples `x` and `y`.
+ *
+ * It only assumes that the samples are independent, not that they are
+ * normal, which suits benchmark times: they are skewed and have outliers.
+ * P-values use the normal approximation, corrected for ties
+ * and continuity, which is accurate from about 8 samples each.
+ */
+inline RankTest MannWhitney(const std::vector<double>& x,
+                            const std::vector<double>& y) {
+  RankTest ret;
+  size_t n1 = x.size(), n2 = y.size(), n = n1 + n2;
+  if (n1 == 0 || n2 == 0) return ret;
+
+  // Ranks of the pooled samples, ties get their mean rank.
+  std::vector<std::pair<double, bool>> pooled;
+  pooled.reserve(n);
+  for (double v : x) pooled.emplace_back(v, true);
+  for (double v : y) pooled.emplace_back(v, false);
+  std::sort(pooled.begin(), pooled.end());
+  double rankSum = 0, ties = 0;
+  for (size_t i = 0; i < n;) {
+    size_t j = i;
+    while (j < n && pooled[j].first == pooled[i].first) ++j;
+    double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; ++k) rankSum += pooled[k].second ? rank : 0;
+    double t = j - i;
+    ties += t * t * t - t;
+    i = j;
+  }
+  ret.u = rankSum - n1 * (n1 + 1) / 2.0;
+
+  double mean = n1 * n2 / 2.0;
+  double variance = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1.0)));
+  if (variance <= 0) {
+    // All values equal: no evidence either way.
+    ret.pGreater = ret.pLess = 0.5;
+    return ret;
+  }
+  double sd = std::sqrt(variance);
+  ret.z = (ret.u - mean) / sd;
+  ret.pGreater = 0.5 * std::erfc((ret.u - mean - 0.5) / sd / std::sqrt(2.0));
+  ret.pLess = 0.5 * std::erfc((mean - ret.u - 0.5) / sd / std::sqrt(2.0));
+  return ret;
+}
+
+/**
+ * Returns the median of `v`, or 0 if it is empty.
+ */
+inline double Median(std::vector<double> v) {
+  if (v.empty()) return 0;
+  size_t h = v.size() / 2;
+  std::nth_element(v.begin(), v.begin() + h, v.end());
+  if (v.size() % 2 == 1) return v[h];
+  return (v[h] + *std::max_element(v.begin(), v.begin() + h)) / 2;
+}
+
+/**
+ * HPC Tutor Benchmark Results.
+ *
+ * Sample times, in seconds, of named benchmarks: a stored baseline,
+ * or the results of a new run to compare with it.
+ * Files are line-based text, one benchmark per line:
+ *
+ *     samples <count> <seconds>... <name>
+ *
+ * The name is the rest of the line, so it may hold spaces.
+ * Lines starting with '#' are comments.
+ */
+class BenchmarkResults {
+ public:
+  /**
+   * Parses results. Throws `std::invalid_argument` on malformed lines.
+   */
+  static BenchmarkResults Read(std::istream& is) {
+    BenchmarkResults ret;
+    std::string line;
+    for (size_t number = 1; std::getline(is, line); ++number) {
+      std::istringstream fields(line);
+      std::string key;
+      if (!(fields >> key) || key[0] == '#') continue;
+      size_t count = 0;
+      bool ok = key == "samples" && static_cast<bool>(fields >> count);
+      std::vector<double> samples(count);
+      for (size_t i = 0; ok && i < count; ++i) {
+        ok = static_cast<bool>(fields >> samples[i]);
+      }
+      std::string name;
+      if (ok) std::getline(fields >> std::ws, name);
+      if (!ok || name.empty()) {
+        throw std::invalid_argument("benchmark results line " +
+                                    std::to_string(number) + ": " + line);
+      }
+      ret.Set(name, std::move(samples));
+    }
+    return ret;
+  }
+
+  /**
+   * Reads the results in the file `path`.
+   */
+  static BenchmarkResults Read(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    return Read(file);
+  }
+
+  void Write(std::ostream& os) const {
+    // Round trips: 17 significant digits, enough for any double.
+    auto precision = os.precision(17);
+    for (const auto& [name, samples] : samples_) {
+      os << "samples " << samples.size();
+      for (double s : samples) os << " " << s;
+      os << " " << name << "\n";
+    }
+    os.precision(precision);
+  }
+
+  void Write(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    Write(file);
+    if (!file) throw std::runtime_error("cannot write " + path);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return samples_.empty(); }
+
+  /**
+   * Sets the samples of benchmark `name`, replacing earlier ones.
+   */
+  void Set(const std::string& name, std::vector<double> samples) {
+    samples_[name] = std::move(samples);
+  }
+
+  /**
+   * Sets the samples of every benchmark of `other`.
+   */
+  void Merge(const BenchmarkResults& other) {
+    for (const auto& [name, samples] : other.samples_) Set(name, samples);
+  }
+
+  /**
+   * Returns the samples of each benchmark, by name.
+   */
+  [[nodiscard]] const std::map<std::string, std::vector<double>>& samples()
+      const noexcept {
+    return samples_;
+  }
+
+ private:
+  std::map<std::string, std::vector<double>> samples_;
+};
+
+/**
+ * Thresholds of `CompareBenchmarks`.
+ */
+struct RegressionOptions {
+  /**
+   * Smallest relative change of the median time that counts,
+   * e.g., 0.1 for 10%: smaller ones are within the drift between runs.
+   */
+  double threshold = 0.1;
+
+  /**
+   * Significance level of the Mann-Whitney test.
+   */
+  double alpha = 0.01;
+};
+
+/**
+ * Change of one benchmark between a baseline and a new run.
+ */
+struct BenchmarkChange {
+  enum class Status {
+    kUnchanged,
+    kRegressed,  ///< Significantly slower, by more than the threshold.
+    kImproved,   ///< Significantly faster, by more than the threshold.
+    kNew,        ///< Not in the baseline.
+    kMissing,    ///< Not in the new run.
+  };
+
+  std::string name;
+  Status status = Status::kUnchanged;
+  double baseline = 0;  ///< Median seconds.
+  double current = 0;   ///< Median seconds.
+  double ratio = 1;     ///< current / baseline.
+  RankTest test;        ///< Of the new samples against the baseline.
+};
+
+inline const char* StatusName(BenchmarkChange::Status status) {
+  switch (status) {
+    case BenchmarkChange::Status::kUnchanged:
+      return "unchanged";
+    case BenchmarkChange::Status::kRegressed:
+      return "REGRESSED";
+    case BenchmarkChange::Status::kImproved:
+      return "improved";
+    case BenchmarkChange::Status::kNew:
+      return "new";
+    case BenchmarkChange::Status::kMissing:
+      return "missing";
+  }
+  return "?";
+}
+
+/**
+ * Compares the benchmarks of a new run with a baseline, by name.
+ *
+ * A benchmark regresses when its samples are significantly larger
+ * than those of the baseline (one-sided Mann-Whitney test at `alpha`)
+ * and its median time grew by more than `threshold`.
+ * Both conditions are needed: with many samples, the test flags
+ * changes too small to matter, and with few, the medians are noisy.
+ */
+inline std::vector<BenchmarkChange> CompareBenchmarks(
+    const BenchmarkResults& baseline, const BenchmarkResults& current,
+    const RegressionOptions& options = {}) {
+  using Status = BenchmarkChange::Status;
+  std::vector<BenchmarkChange> ret;
+  for (const auto& [name, samples] : current.samples()) {
+    BenchmarkChange c;
+    c.name = name;
+    c.current = Median(samples);
+    auto base = baseline.samples().find(name);
+    if (base == baseline.samples().end()) {
+      c.status = Status::kNew;
+      ret.push_back(c);
+      continue;
+    }
+    c.baseline = Median(base->second);
+    c.ratio = c.baseline > 0 ? c.current / c.baseline : 1;
+    c.test = MannWhitney(samples, base->second);
+    if (c.test.pGreater < options.alpha &&
+        c.ratio > 1 + options.threshold) {
+      c.status = Status::kRegressed;
+    } else if (c.test.pLess < options.alpha &&
+               c.ratio < 1 / (1 + options.threshold)) {
+      c.status = Status::kImproved;
+    }
+    ret.push_back(c);
+  }
+  for (const auto& [name, samples] : baseline.samples()) {
+    if (current.samples().count(name) != 0) continue;
+    BenchmarkChange c;
+    c.name = name;
+    c.status = Status::kMissing;
+    c.baseline = Median(samples);
+    ret.push_back(c);
+  }
+  return ret;
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_BASELINE_HPP_
@@ -0,0 +1,76 @@
+#ifndef HPC_TUTOR_BINARY_FILE_HPP_
+#define HPC_TUTOR_BINARY_FILE_HPP_
+
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace tutor {
+
+namespace detail {
+
+/**
+ * Owning wrapper of a C file that throws on errors.
+ */
+class BinaryFile {
+ public:
+  BinaryFile(const std::string& path, const char* mode)
+      : path_(path), file_(std::fopen(path.c_str(), mode)) {
+    if (file_ == nullptr) throw std::runtime_error("cannot open " + path);
+  }
+
+  BinaryFile(const BinaryFile&) = delete;
+  BinaryFile& operator=(const BinaryFile&) = delete;
+
+  /**
+   * Closes the file if `Close` was not called, e.g., on exceptions,
+   * ignoring errors.
+   */
+  ~BinaryFile() {
+    if (file_ != nullptr) std::fclose(file_);
+  }
+
+  /**
+   * Flushes and closes the file.
+   * Throws if buffered writes cannot be completed, e.g., on a full disk.
+   */
+  void Close() {
+    if (file_ == nullptr) return;
+    std::FILE* file = std::exchange(file_, nullptr);
+    bool flushed = std::fflush(file) == 0;
+    if (std::fclose(file) != 0 || !flushed) {
+      throw std::runtime_error("cannot write " + path_);
+    }
+  }
+
+  /**
+   * Reads up to `n` elements and returns the number read.
+   */
+  template <typename T>
+  size_t Read(T* data, size_t n) {
+    size_t got = std::fread(data, sizeof(T), n, file_);
+    if (got < n && std::ferror(file_)) {
+      throw std::runtime_error("cannot read " + path_);
+    }
+    return got;
+  }
+
+  template <typename T>
+  void Write(const T* data, size_t n) {
+    if (std::fwrite(data, sizeof(T), n, file_) != n) {
+      throw std::runtime_error("cannot write " + path_);
+    }
+  }
+
+ private:
+  std::string path_;
+  std::FILE* file_;
+};
+
+}  // namespace detail
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_BINARY_FILE_HPP_
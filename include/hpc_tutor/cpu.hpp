@@ -0,0 +1,158 @@
+#ifndef HPC_TUTOR_CPU_HPP_
+#define HPC_TUTOR_CPU_HPP_
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HPC_TUTOR_X86_KERNELS 1
+#endif
+
+namespace tutor {
+
+/**
+ * Instruction set levels of the dispatched kernels.
+ *
+ * Levels are ordered: each one includes the previous ones.
+ */
+enum class Isa {
+  kBaseline,  ///< The compiler flags, e.g., SSE2 on x86-64.
+  kSse42,     ///< SSE4.2 and POPCNT.
+  kAvx2,      ///< AVX2 and FMA.
+  kAvx512,    ///< AVX-512 F, BW, DQ and VL.
+};
+
+/**
+ * Returns the name of `isa`, as accepted by `HPC_TUTOR_ISA`.
+ */
+inline const char* IsaName(Isa isa) {
+  switch (isa) {
+    case Isa::kSse42:
+      return "sse4.2";
+    case Isa::kAvx2:
+      return "avx2";
+    case Isa::kAvx512:
+      return "avx512";
+    default:
+      return "baseline";
+  }
+}
+
+/**
+ * Returns whether the running CPU supports `isa`.
+ */
+inline bool IsaSupported(Isa isa) {
+  switch (isa) {
+    case Isa::kBaseline:
+      return true;
+#ifdef HPC_TUTOR_X86_KERNELS
+    case Isa::kSse42:
+      return __builtin_cpu_supports("sse4.2") &&
+             __builtin_cpu_supports("popcnt");
+    case Isa::kAvx2:
+      return IsaSupported(Isa::kSse42) && __builtin_cpu_supports("avx2") &&
+             __builtin_cpu_supports("fma");
+    case Isa::kAvx512:
+      return IsaSupported(Isa::kAvx2) && __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512dq") &&
+             __builtin_cpu_supports("avx512vl");
+#endif
+    default:
+      return false;
+  }
+}
+
+/**
+ * Returns the level of the dispatched kernels.
+ *
+ * It is the best level supported by the running CPU, detected once.
+ * The environment variable `HPC_TUTOR_ISA` caps it,
+ * e.g., to benchmark the AVX2 kernels on an AVX-512 machine.
+ * Its values are the names of `IsaName`;
+ * other values throw `std::invalid_argument`.
+ */
+inline Isa DetectIsa() {
+  static const Isa isa = [] {
+    Isa cap = Isa::kAvx512;
+    if (const char* env = std::getenv("HPC_TUTOR_ISA")) {
+      std::string name = env;
+      bool known = false;
+      for (auto level : {Isa::kBaseline, Isa::kSse42, Isa::kAvx2,
+                         Isa::kAvx512}) {
+        if (name == IsaName(level)) {
+          cap = level;
+          known = true;
+        }
+      }
+      if (!known) {
+        throw std::invalid_argument(
+            "HPC_TUTOR_ISA must be baseline, sse4.2, avx2 or avx512, not " +
+            name);
+      }
+    }
+    for (auto best : {Isa::kAvx512, Isa::kAvx2, Isa::kSse42}) {
+      if (best <= cap && IsaSupported(best)) return best;
+    }
+    return Isa::kBaseline;
+  }();
+  return isa;
+}
+
+namespace detail {
+
+#ifdef HPC_TUTOR_X86_KERNELS
+
+// Each runner compiles `kernel` and everything it calls for one level:
+// flatten inlines the whole call tree into the target-specific body.
+
+template <typename F>
+__attribute__((target("sse4.2,popcnt"), flatten)) inline auto RunSse42(
+    const F& kernel) {
+  return kernel();
+}
+
+template <typename F>
+__attribute__((target("avx2,fma"), flatten)) inline auto RunAvx2(
+    const F& kernel) {
+  return kernel();
+}
+
+template <typename F>
+__attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma"),
+               flatten)) inline auto RunAvx512(const F& kernel) {
+  return kernel();
+}
+
+#endif  // HPC_TUTOR_X86_KERNELS
+
+/**
+ * Runs `kernel` compiled for the level of `DetectIsa`.
+ *
+ * `kernel` is a lambda with the body of a hot loop.
+ * Its call tree must be inlinable: no recursion, no virtual calls.
+ */
+template <typename F>
+auto Dispatch(const F& kernel) {
+#ifdef HPC_TUTOR_X86_KERNELS
+  switch (DetectIsa()) {
+    case Isa::kAvx512:
+      return RunAvx512(kernel);
+    case Isa::kAvx2:
+      return RunAvx2(kernel);
+    case Isa::kSse42:
+      return RunSse42(kernel);
+    default:
+      break;
+  }
+#endif
+  return kernel();
+}
+
+}  // namespace detail
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_CPU_HPP_
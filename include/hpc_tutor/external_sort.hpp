@@ -0,0 +1,399 @@
+#ifndef HPC_TUTOR_EXTERNAL_SORT_HPP_
+#define HPC_TUTOR_EXTERNAL_SORT_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "async.hpp"
+#include "binary_file.hpp"
+#include "linalg.hpp"
+#include "memory.hpp"
+#include "thread_pool.hpp"
+
+namespace tutor {
+
+/**
+ * Settings of `ExternalSort`.
+ */
+struct ExternalSortOptions {
+  /**
+   * Memory, in bytes, that the sort may use for its buffers.
+   */
+  size_t memoryBytes = size_t(1) << 30;
+
+  /**
+   * Smallest read or write, in bytes, in the merge phase.
+   * Merges with more runs than the budget allows at this size
+   * are done in several passes.
+   */
+  size_t ioBlockBytes = size_t(1) << 20;
+
+  /**
+   * Directory of the temporary run files.
+   * Empty means the system temporary directory.
+   */
+  std::string tempDir;
+};
+
+/**
+ * Timing and traffic of one phase of `ExternalSort`.
+ */
+struct ExternalSortPhase {
+  double seconds = 0;
+  size_t bytesRead = 0;
+  size_t bytesWritten = 0;
+
+  /**
+   * Returns the I/O throughput of the phase in bytes per second.
+   */
+  [[nodiscard]] double throughput() const noexcept {
+    return seconds > 0 ? (bytesRead + bytesWritten) / seconds : 0;
+  }
+};
+
+/**
+ * Report of an `ExternalSort` call.
+ */
+struct ExternalSortStats {
+  ExternalSortPhase runs;   ///< Run formation: read, sort and write runs.
+  ExternalSortPhase merge;  ///< All the merge passes.
+  size_t numRuns = 0;       ///< Runs written by the run formation.
+  size_t mergePasses = 0;   ///< Passes over the data in the merge phase.
+  size_t fanIn = 0;         ///< Largest number of runs merged at once.
+};
+
+namespace detail {
+
+/**
+ * Sequential reader of a run with double buffering:
+ * the next block is read asynchronously while the current one is consumed.
+ */
+template <typename T>
+class RunReader {
+ public:
+  RunReader(const std::string& path, size_t blockElems, ThreadPool& io)
+      : file_(path, "rb"), io_(&io) {
+    for (auto& b : buffers_) b.resize(blockElems);
+    Prefetch();
+    Swap();
+  }
+
+  RunReader(const RunReader&) = delete;
+  RunReader& operator=(const RunReader&) = delete;
+
+  ~RunReader() {
+    if (pending_.valid()) pending_.wait();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return pos_ == size_; }
+
+  [[nodiscard]] const T& front() const noexcept {
+    return buffers_[current_][pos_];
+  }
+
+  void Pop() {
+    if (++pos_ == size_) Swap();
+  }
+
+  [[nodiscard]] size_t bytesRead() const noexcept { return bytesRead_; }
+
+ private:
+  void Prefetch() {
+    auto& next = buffers_[1 - current_];
+    T* data = next.data();
+    size_t n = next.size();
+    BinaryFile* file = &file_;
+    pending_ = Async(*io_, {Access::Write(data, n)},
+                     [file, data, n] { return file->Read(data, n); });
+  }
+
+  void Swap() {
+    if (!pending_.valid()) return;
+    size_ = pending_.get();
+    bytesRead_ += size_ * sizeof(T);
+    current_ = 1 - current_;
+    pos_ = 0;
+    if (size_ == buffers_[current_].size()) Prefetch();
+  }
+
+  BinaryFile file_;
+  ThreadPool* io_;
+  Workspace<T> buffers_[2];
+  size_t current_ = 1;
+  size_t pos_ = 0;
+  size_t size_ = 0;
+  size_t bytesRead_ = 0;
+  Future<size_t> pending_;
+};
+
+/**
+ * Sequential writer with double buffering:
+ * a full block is written asynchronously while the next one is filled.
+ */
+template <typename T>
+class RunWriter {
+ public:
+  RunWriter(const std::string& path, size_t blockElems, ThreadPool& io)
+      : file_(path, "wb"), io_(&io) {
+    for (auto& b : buffers_) b.resize(blockElems);
+  }
+
+  RunWriter(const RunWriter&) = delete;
+  RunWriter& operator=(const RunWriter&) = delete;
+
+  ~RunWriter() {
+    if (pending_.valid()) pending_.wait();
+  }
+
+  void Push(const T& value) {
+    buffers_[current_][size_] = value;
+    if (++size_ == buffers_[current_].size()) Flush();
+  }
+
+  /**
+   * Writes the buffered elements, waits for all the writes
+   * and closes the file.
+   */
+  void Close() {
+    Flush();
+    if (pending_.valid()) pending_.get();
+    file_.Close();
+  }
+
+  [[nodiscard]] size_t bytesWritten() const noexcept { return bytesWritten_; }
+
+ private:
+  void Flush() {
+    if (pending_.valid()) pending_.get();
+    if (size_ == 0) return;
+    const T* data = buffers_[current_].data();
+    size_t n = size_;
+    BinaryFile* file = &file_;
+    pending_ = Async(*io_, {Access::Read(data, n)},
+                     [file, data, n] { file->Write(data, n); });
+    bytesWritten_ += n * sizeof(T);
+    current_ = 1 - current_;
+    size_ = 0;
+  }
+
+  BinaryFile file_;
+  ThreadPool* io_;
+  Workspace<T> buffers_[2];
+  size_t current_ = 0;
+  size_t size_ = 0;
+  size_t bytesWritten_ = 0;
+  Future<void> pending_;
+};
+
+/**
+ * Merges the sorted runs in `inputs` into `output`.
+ */
+template <typename T>
+void MergeRuns(const std::vector<std::string>& inputs,
+               const std::string& output, size_t blockElems, ThreadPool& io,
+               ExternalSortPhase& phase) {
+  size_t k = inputs.size();
+  std::vector<std::unique_ptr<RunReader<T>>> readers;
+  readers.reserve(k);
+  LoserTree<T> tree(k);
+  for (size_t i = 0; i < k; ++i) {
+    readers.push_back(
+        std::make_unique<RunReader<T>>(inputs[i], blockElems, io));
+    if (!readers[i]->empty()) tree.Set(i, readers[i]->front());
+  }
+  RunWriter<T> writer(output, blockElems, io);
+  tree.Build();
+  while (tree.live()) {
+    size_t w = tree.winner();
+    writer.Push(tree.key(w));
+    readers[w]->Pop();
+    if (readers[w]->empty()) {
+      tree.Close(w);
+    } else {
+      tree.Set(w, readers[w]->front());
+    }
+    tree.Replay(w);
+  }
+  writer.Close();
+  for (auto& r : readers) phase.bytesRead += r->bytesRead();
+  phase.bytesWritten += writer.bytesWritten();
+}
+
+/**
+ * Sorts the `n` elements of `data` on the threads of `pool`.
+ *
+ * Chunks, one per thread, are sorted in parallel with `std::sort`
+ * and merged into `aux` with a loser tree.
+ * Returns the sorted elements: `data` if there was a single chunk,
+ * `aux` otherwise.
+ */
+template <typename T>
+const T* SortRun(ThreadPool& pool, T* data, size_t n, T* aux) {
+  // Below this, a chunk is not worth a task.
+  constexpr size_t kMinChunk = size_t(1) << 12;
+  size_t k = std::clamp<size_t>(n / kMinChunk, 1, pool.size());
+  std::vector<size_t> start(k + 1);
+  for (size_t i = 0; i <= k; ++i) start[i] = n * i / k;
+  pool.ParallelFor(0, k, 1, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      std::sort(data + start[i], data + start[i + 1]);
+    }
+  });
+  if (k == 1) return data;
+  LoserTree<T> tree(k);
+  std::vector<size_t> pos(start.begin(), start.end() - 1);
+  for (size_t i = 0; i < k; ++i) tree.Set(i, data[pos[i]]);
+  tree.Build();
+  for (size_t j = 0; tree.live(); ++j) {
+    size_t w = tree.winner();
+    aux[j] = tree.key(w);
+    if (++pos[w] < start[w + 1]) {
+      tree.Set(w, data[pos[w]]);
+    } else {
+      tree.Close(w);
+    }
+    tree.Replay(w);
+  }
+  return aux;
+}
+
+/**
+ * Names temporary files and removes the ones left when destroyed,
+ * e.g., if the sort throws.
+ */
+class TempFiles {
+ public:
+  explicit TempFiles(std::string prefix) : prefix_(std::move(prefix)) {}
+
+  TempFiles(const TempFiles&) = delete;
+  TempFiles& operator=(const TempFiles&) = delete;
+
+  ~TempFiles() {
+    std::error_code ignored;
+    for (const auto& name : names_) std::filesystem::remove(name, ignored);
+  }
+
+  std::string Next() {
+    names_.push_back(prefix_ + std::to_string(names_.size()));
+    return names_.back();
+  }
+
+ private:
+  std::string prefix_;
+  std::vector<std::string> names_;
+};
+
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+}  // namespace detail
+
+/**
+ * External (Out-of-Core) Merge Sort.
+ *
+ * Sorts the binary file `input`, an array of trivially copyable `T`,
+ * into the file `output` in increasing order, using about
+ * `options.memoryBytes` of memory whatever the size of the input.
+ *
+ * The run formation phase reads chunks of half the budget,
+ * sorts them on `ThreadPool::Global()` (see `detail::SortRun`,
+ * whose merge needs the other half) and writes them as sorted runs
+ * to temporary files.
+ * The merge phase merges up to `fanIn` runs at a time with a loser tree;
+ * each run and the output get two blocks of the budget,
+ * so reading and writing the next blocks overlaps with the merge.
+ * Each pass divides the number of runs by the fan-in
+ * until one run, the output, remains.
+ */
+template <typename T>
+ExternalSortStats ExternalSort(const std::string& input,
+                               const std::string& output,
+                               const ExternalSortOptions& options = {}) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "ExternalSort needs trivially copyable elements");
+  namespace fs = std::filesystem;
+  size_t bytes = fs::file_size(input);
+  if (bytes % sizeof(T) != 0) {
+    throw std::invalid_argument(input + " is not an array of elements");
+  }
+  size_t blockBytes = std::max(options.ioBlockBytes, sizeof(T));
+  if (options.memoryBytes < 6 * blockBytes) {
+    throw std::invalid_argument("memory budget below six I/O blocks");
+  }
+  fs::path dir = options.tempDir.empty() ? fs::temp_directory_path()
+                                         : fs::path(options.tempDir);
+  std::string prefix =
+      (dir / ("hpc_tutor_sort_" + std::to_string(std::random_device()()) +
+              "_"))
+          .string();
+  detail::TempFiles temps(prefix);
+
+  ExternalSortStats stats;
+  ThreadPool io(3, false);
+
+  // Run formation.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> runs;
+  {
+    size_t runElems = std::max<size_t>(1, options.memoryBytes / 2 / sizeof(T));
+    detail::Workspace<T> buffer(std::min(runElems, bytes / sizeof(T)));
+    detail::Workspace<T> aux(buffer.size());
+    detail::BinaryFile in(input, "rb");
+    size_t n;
+    while (!buffer.empty() && (n = in.Read(buffer.data(), buffer.size())) > 0) {
+      const T* sorted =
+          detail::SortRun(ThreadPool::Global(), buffer.data(), n, aux.data());
+      runs.push_back(temps.Next());
+      detail::BinaryFile run(runs.back(), "wb");
+      run.Write(sorted, n);
+      run.Close();
+      stats.runs.bytesRead += n * sizeof(T);
+      stats.runs.bytesWritten += n * sizeof(T);
+    }
+  }
+  stats.runs.seconds = detail::SecondsSince(start);
+  stats.numRuns = runs.size();
+
+  // Merge passes.
+  start = std::chrono::steady_clock::now();
+  size_t maxFanIn = options.memoryBytes / (2 * blockBytes) - 1;
+  if (runs.empty()) detail::BinaryFile(output, "wb").Close();
+  while (!runs.empty()) {
+    bool last = runs.size() <= maxFanIn;
+    std::vector<std::string> merged;
+    for (size_t first = 0; first < runs.size(); first += maxFanIn) {
+      size_t end = std::min(runs.size(), first + maxFanIn);
+      std::vector<std::string> group(runs.begin() + first, runs.begin() + end);
+      size_t fanIn = group.size();
+      stats.fanIn = std::max(stats.fanIn, fanIn);
+      // Two blocks per input run and two for the output.
+      size_t blockElems = options.memoryBytes / (2 * (fanIn + 1)) / sizeof(T);
+      merged.push_back(last ? output : temps.Next());
+      detail::MergeRuns<T>(group, merged.back(), blockElems, io, stats.merge);
+      for (const auto& r : group) fs::remove(r);
+    }
+    ++stats.mergePasses;
+    if (last) break;
+    runs.swap(merged);
+  }
+  stats.merge.seconds = detail::SecondsSince(start);
+  return stats;
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_EXTERNAL_SORT_HPP_
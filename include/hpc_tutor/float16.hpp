@@ -0,0 +1,515 @@
+#ifndef HPC_TUTOR_FLOAT16_HPP_
+#define HPC_TUTOR_FLOAT16_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+
+#include "cpu.hpp"
+#include "matrix_view.hpp"
+#include "memory.hpp"
+
+namespace tutor {
+
+namespace detail {
+
+inline uint32_t FloatBits(float f) {
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+inline float BitsFloat(uint32_t u) {
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+/**
+ * Rounds to nearest even. NaNs stay (quiet) NaNs.
+ */
+inline uint16_t FloatToBf16Bits(float f) {
+  uint32_t u = FloatBits(f);
+  if ((u & 0x7fffffffu) > 0x7f800000u) {
+    return static_cast<uint16_t>((u >> 16) | 0x40u);
+  }
+  u += 0x7fffu + ((u >> 16) & 1u);
+  return static_cast<uint16_t>(u >> 16);
+}
+
+inline float Bf16BitsToFloat(uint16_t h) {
+  return BitsFloat(static_cast<uint32_t>(h) << 16);
+}
+
+/**
+ * Rounds to nearest even. Values from 65520 on overflow to infinity.
+ */
+inline uint16_t FloatToHalfBits(float f) {
+  constexpr uint32_t kInf = 255u << 23;
+  constexpr uint32_t kOverflow = (127u + 16) << 23;
+  constexpr uint32_t kMinNormal = (127u - 14) << 23;
+  constexpr uint32_t kHalf = 126u << 23;  // 0.5, whose ulp is 2^-24.
+  uint32_t u = FloatBits(f);
+  uint32_t sign = u & 0x80000000u;
+  u ^= sign;
+  uint32_t h;
+  if (u >= kOverflow) {
+    h = u > kInf ? 0x7e00u : 0x7c00u;
+  } else if (u < kMinNormal) {
+    // The float addition rounds to the subnormal half steps of 2^-24.
+    h = FloatBits(BitsFloat(u) + BitsFloat(kHalf)) - kHalf;
+  } else {
+    uint32_t odd = (u >> 13) & 1u;
+    h = (u - (112u << 23) + 0xfffu + odd) >> 13;
+  }
+  return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+inline float HalfBitsToFloat(uint16_t h) {
+  constexpr uint32_t kExp = 0x7c00u << 13;
+  uint32_t u = (h & 0x7fffu) << 13;
+  uint32_t exp = u & kExp;
+  u += 112u << 23;
+  if (exp == kExp) {
+    u += 112u << 23;  // Infinity or NaN.
+  } else if (exp == 0) {
+    // Subnormal: renormalize with a float subtraction.
+    u = FloatBits(BitsFloat(u + (1u << 23)) - BitsFloat(113u << 23));
+  }
+  return BitsFloat(u | ((h & 0x8000u) << 16));
+}
+
+}  // namespace detail
+
+/**
+ * Brain floating point number: 16-bit storage of a `float`.
+ *
+ * It keeps the 8-bit exponent of `float` and 7 bits of its mantissa:
+ * the range of `float` with about 3 significant digits.
+ * Conversions from `float` round to nearest even.
+ * There is no 16-bit arithmetic: values convert implicitly to `float`.
+ */
+class BFloat16 {
+ public:
+  /**
+   * Default constructor. Value initialization gives +0.
+   */
+  BFloat16() = default;
+
+  explicit BFloat16(float f) noexcept : bits_(detail::FloatToBf16Bits(f)) {}
+
+  operator float() const noexcept { return detail::Bf16BitsToFloat(bits_); }
+
+  /**
+   * Returns the number with the given bit pattern.
+   */
+  static constexpr BFloat16 FromBits(uint16_t bits) noexcept {
+    return BFloat16(bits, 0);
+  }
+
+  [[nodiscard]] constexpr uint16_t bits() const noexcept { return bits_; }
+
+ private:
+  constexpr BFloat16(uint16_t bits, int) noexcept : bits_(bits) {}
+
+  uint16_t bits_;
+};
+
+/**
+ * IEEE 754 half precision number: 16-bit storage of a `float`.
+ *
+ * It has a 5-bit exponent and 10 bits of mantissa:
+ * about 3 significant digits, and magnitudes up to 65504.
+ * Conversions from `float` round to nearest even.
+ * There is no 16-bit arithmetic: values convert implicitly to `float`.
+ */
+class Half {
+ public:
+  /**
+   * Default constructor. Value initialization gives +0.
+   */
+  Half() = default;
+
+  explicit Half(float f) noexcept : bits_(detail::FloatToHalfBits(f)) {}
+
+  operator float() const noexcept { return detail::HalfBitsToFloat(bits_); }
+
+  /**
+   * Returns the number with the given bit pattern.
+   */
+  static constexpr Half FromBits(uint16_t bits) noexcept {
+    return Half(bits, 0);
+  }
+
+  [[nodiscard]] constexpr uint16_t bits() const noexcept { return bits_; }
+
+ private:
+  constexpr Half(uint16_t bits, int) noexcept : bits_(bits) {}
+
+  uint16_t bits_;
+};
+
+static_assert(sizeof(BFloat16) == 2 && std::is_trivial_v<BFloat16>);
+static_assert(sizeof(Half) == 2 && std::is_trivial_v<Half>);
+
+inline std::ostream& operator<<(std::ostream& os, BFloat16 x) {
+  return os << static_cast<float>(x);
+}
+
+inline std::ostream& operator<<(std::ostream& os, Half x) {
+  return os << static_cast<float>(x);
+}
+
+/**
+ * Instruction sets of the 16-bit floating point kernels.
+ */
+enum class Float16Isa {
+  kPortable,    ///< Software conversions, any target.
+  kAvx2,        ///< F16C conversions and FMA on 8 floats.
+  kAvx512Bf16,  ///< 16 floats, bf16 products with vdpbf16ps.
+};
+
+/**
+ * Returns whether the running CPU supports `isa`.
+ */
+inline bool Float16IsaSupported(Float16Isa isa) {
+  switch (isa) {
+    case Float16Isa::kPortable:
+      return true;
+#ifdef HPC_TUTOR_X86_KERNELS
+    case Float16Isa::kAvx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+             __builtin_cpu_supports("f16c");
+    case Float16Isa::kAvx512Bf16:
+      return Float16IsaSupported(Float16Isa::kAvx2) &&
+             __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bf16");
+#endif
+    default:
+      return false;
+  }
+}
+
+/**
+ * Returns the best instruction set supported by the running CPU
+ * within the level of `DetectIsa`, so `HPC_TUTOR_ISA` caps it too.
+ */
+inline Float16Isa DetectFloat16Isa() {
+  static const Float16Isa isa = [] {
+    if (DetectIsa() >= Isa::kAvx512 &&
+        Float16IsaSupported(Float16Isa::kAvx512Bf16)) {
+      return Float16Isa::kAvx512Bf16;
+    }
+    if (DetectIsa() >= Isa::kAvx2 && Float16IsaSupported(Float16Isa::kAvx2)) {
+      return Float16Isa::kAvx2;
+    }
+    return Float16Isa::kPortable;
+  }();
+  return isa;
+}
+
+namespace detail {
+
+template <typename T>
+inline constexpr bool kIsFloat16 =
+    std::is_same_v<T, BFloat16> || std::is_same_v<T, Half>;
+
+/**
+ * Dot product of 16-bit or float vectors, accumulated in float.
+ */
+template <typename A, typename B>
+float DotPortable(const A* a, const B* b, size_t n) {
+  float sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += static_cast<float>(a[i]) * static_cast<float>(b[i]);
+  }
+  return sum;
+}
+
+#ifdef HPC_TUTOR_X86_KERNELS
+
+__attribute__((target("avx2,fma,f16c"))) inline __m256 Load8(const float* p) {
+  return _mm256_loadu_ps(p);
+}
+
+__attribute__((target("avx2,fma,f16c"))) inline __m256 Load8(const Half* p) {
+  return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+/**
+ * A bf16 is the top half of a float: widen and shift.
+ */
+__attribute__((target("avx2,fma,f16c"))) inline __m256 Load8(
+    const BFloat16* p) {
+  __m256i w = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(w, 16));
+}
+
+__attribute__((target("avx2,fma,f16c"))) inline void Store8(Half* p,
+                                                             __m256 v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                   _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+/**
+ * Rounds to nearest even with integer arithmetic, as `FloatToBf16Bits`.
+ */
+__attribute__((target("avx2,fma,f16c"))) inline void Store8(BFloat16* p,
+                                                             __m256 v) {
+  __m256i u = _mm256_castps_si256(v);
+  __m256i top = _mm256_srli_epi32(u, 16);
+  __m256i odd = _mm256_and_si256(top, _mm256_set1_epi32(1));
+  __m256i rounded = _mm256_srli_epi32(
+      _mm256_add_epi32(u, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7fff))),
+      16);
+  __m256i quiet = _mm256_or_si256(top, _mm256_set1_epi32(0x40));
+  __m256 nan = _mm256_cmp_ps(v, v, _CMP_UNORD_Q);
+  __m256i bits =
+      _mm256_blendv_epi8(rounded, quiet, _mm256_castps_si256(nan));
+  // The packing works within 128-bit lanes: gather the halves.
+  bits = _mm256_permute4x64_epi64(_mm256_packus_epi32(bits, bits), 0xd8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                   _mm256_castsi256_si128(bits));
+}
+
+__attribute__((target("avx2,fma,f16c"))) inline float Sum8(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_movehdup_ps(s));
+  return _mm_cvtss_f32(s);
+}
+
+template <typename A, typename B>
+__attribute__((target("avx2,fma,f16c"))) float DotAvx2(const A* a,
+                                                        const B* b, size_t n) {
+  __m256 acc[4];
+  for (auto& v : acc) v = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    for (size_t r = 0; r < 4; ++r) {
+      acc[r] = _mm256_fmadd_ps(Load8(a + i + 8 * r), Load8(b + i + 8 * r),
+                               acc[r]);
+    }
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc[0] = _mm256_fmadd_ps(Load8(a + i), Load8(b + i), acc[0]);
+  }
+  float sum = Sum8(_mm256_add_ps(_mm256_add_ps(acc[0], acc[1]),
+                                 _mm256_add_ps(acc[2], acc[3])));
+  return sum + DotPortable(a + i, b + i, n - i);
+}
+
+template <typename H>
+__attribute__((target("avx2,fma,f16c"))) void ToFloatAvx2(float* dst,
+                                                          const H* src,
+                                                          size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) _mm256_storeu_ps(dst + i, Load8(src + i));
+  for (; i < n; ++i) dst[i] = src[i];
+}
+
+template <typename H>
+__attribute__((target("avx2,fma,f16c"))) void FromFloatAvx2(H* dst,
+                                                            const float* src,
+                                                            size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) Store8(dst + i, _mm256_loadu_ps(src + i));
+  for (; i < n; ++i) dst[i] = H(src[i]);
+}
+
+// GCC 12 warns about the undefined pass-through operands
+// of its AVX-512 intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f,avx512bf16,f16c"))) inline __m512 Load16(
+    const float* p) {
+  return _mm512_loadu_ps(p);
+}
+
+__attribute__((target("avx512f,avx512bf16,f16c"))) inline __m512 Load16(
+    const Half* p) {
+  return _mm512_cvtph_ps(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+}
+
+__attribute__((target("avx512f,avx512bf16,f16c"))) inline __m512 Load16(
+    const BFloat16* p) {
+  __m512i w = _mm512_cvtepu16_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(w, 16));
+}
+
+template <typename A, typename B>
+__attribute__((target("avx512f,avx512bf16,f16c"))) float DotAvx512(
+    const A* a, const B* b, size_t n) {
+  __m512 acc[4];
+  for (auto& v : acc) v = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    for (size_t r = 0; r < 4; ++r) {
+      acc[r] = _mm512_fmadd_ps(Load16(a + i + 16 * r), Load16(b + i + 16 * r),
+                               acc[r]);
+    }
+  }
+  for (; i + 16 <= n; i += 16) {
+    acc[0] = _mm512_fmadd_ps(Load16(a + i), Load16(b + i), acc[0]);
+  }
+  float sum = _mm512_reduce_add_ps(_mm512_add_ps(
+      _mm512_add_ps(acc[0], acc[1]), _mm512_add_ps(acc[2], acc[3])));
+  return sum + DotPortable(a + i, b + i, n - i);
+}
+
+/**
+ * Each vdpbf16ps multiplies 32 pairs of bf16 and adds the pair sums
+ * to 16 float lanes. Subnormal inputs and results are flushed to zero.
+ */
+__attribute__((target("avx512f,avx512bf16,f16c"))) inline float DotBf16Avx512(
+    const BFloat16* a, const BFloat16* b, size_t n) {
+  __m512 acc[4];
+  for (auto& v : acc) v = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 128 <= n; i += 128) {
+    for (size_t r = 0; r < 4; ++r) {
+      acc[r] = _mm512_dpbf16_ps(
+          acc[r], (__m512bh)_mm512_loadu_si512(a + i + 32 * r),
+          (__m512bh)_mm512_loadu_si512(b + i + 32 * r));
+    }
+  }
+  float sum = _mm512_reduce_add_ps(_mm512_add_ps(
+      _mm512_add_ps(acc[0], acc[1]), _mm512_add_ps(acc[2], acc[3])));
+  return sum + DotAvx512(a + i, b + i, n - i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif  // HPC_TUTOR_X86_KERNELS
+
+template <typename A, typename B>
+float Dot(const A* a, const B* b, size_t n, Float16Isa isa) {
+#ifdef HPC_TUTOR_X86_KERNELS
+  if (isa == Float16Isa::kAvx512Bf16) {
+    if constexpr (std::is_same_v<A, BFloat16> && std::is_same_v<B, BFloat16>) {
+      return DotBf16Avx512(a, b, n);
+    } else {
+      return DotAvx512(a, b, n);
+    }
+  }
+  if (isa == Float16Isa::kAvx2) return DotAvx2(a, b, n);
+#endif
+  return DotPortable(a, b, n);
+}
+
+}  // namespace detail
+
+/**
+ * Converts `n` 16-bit numbers to `float`.
+ */
+template <typename H, std::enable_if_t<detail::kIsFloat16<H>, bool> = true>
+void Convert(float* dst, const H* src, size_t n,
+             Float16Isa isa = DetectFloat16Isa()) {
+#ifdef HPC_TUTOR_X86_KERNELS
+  if (isa != Float16Isa::kPortable) {
+    detail::ToFloatAvx2(dst, src, n);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; ++i) dst[i] = src[i];
+}
+
+/**
+ * Converts `n` floats to 16-bit numbers, rounding to nearest even.
+ */
+template <typename H, std::enable_if_t<detail::kIsFloat16<H>, bool> = true>
+void Convert(H* dst, const float* src, size_t n,
+             Float16Isa isa = DetectFloat16Isa()) {
+#ifdef HPC_TUTOR_X86_KERNELS
+  if (isa != Float16Isa::kPortable) {
+    detail::FromFloatAvx2(dst, src, n);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; ++i) dst[i] = H(src[i]);
+}
+
+/**
+ * Vector Inner Product of 16-bit vectors, accumulated in `float`.
+ *
+ * The summation order depends on `isa`, and so may the last bits.
+ */
+inline float Inner(const BFloat16* lhs, const BFloat16* rhs, size_t n,
+                   Float16Isa isa = DetectFloat16Isa()) {
+  return detail::Dot(lhs, rhs, n, isa);
+}
+
+/**
+ * Vector Inner Product of 16-bit vectors, accumulated in `float`.
+ *
+ * The summation order depends on `isa`, and so may the last bits.
+ */
+inline float Inner(const Half* lhs, const Half* rhs, size_t n,
+                   Float16Isa isa = DetectFloat16Isa()) {
+  return detail::Dot(lhs, rhs, n, isa);
+}
+
+/**
+ * Matrix by Vector Multiplication with a 16-bit matrix.
+ *
+ * Elements of `m` are converted to `float` in registers,
+ * so the matrix is read from memory at half the cost of a float one.
+ */
+template <typename H, std::enable_if_t<detail::kIsFloat16<H>, bool> = true>
+void MatrixEval(float* ret, const MatrixView<H>& m, const float* v,
+                Float16Isa isa = DetectFloat16Isa()) {
+  for (size_t i = 0; i < m.rows(); ++i) {
+    ret[i] = detail::Dot(m[i], v, m.cols(), isa);
+  }
+}
+
+/**
+ * General Matrix Multiplication of 16-bit matrices into `float`.
+ *
+ * Adds (not stores) `lhs` times `rhs` to `ret`, as `Gemm`.
+ * Blocks of `nbs` x `lbs` of `lhs` and `lbs` x `mbs` of `rhs`
+ * are converted to `float` once and multiplied in cache.
+ */
+template <typename H, std::enable_if_t<detail::kIsFloat16<H>, bool> = true>
+void Gemm_b(MatrixView<float> ret, const MatrixView<H>& lhs,
+            const MatrixView<H>& rhs, size_t nbs, size_t mbs, size_t lbs,
+            Float16Isa isa = DetectFloat16Isa()) {
+  detail::Dispatch([&] {
+    detail::Workspace<float> a(nbs * lbs), b(lbs * mbs);
+    for (size_t jj = 0; jj < ret.cols(); jj += mbs) {
+      size_t mb = std::min(mbs, ret.cols() - jj);
+      for (size_t kk = 0; kk < lhs.cols(); kk += lbs) {
+        size_t lb = std::min(lbs, lhs.cols() - kk);
+        for (size_t k = 0; k < lb; ++k) {
+          Convert(b.data() + k * mb, rhs[kk + k] + jj, mb, isa);
+        }
+        for (size_t ii = 0; ii < ret.rows(); ii += nbs) {
+          size_t nb = std::min(nbs, ret.rows() - ii);
+          for (size_t i = 0; i < nb; ++i) {
+            Convert(a.data() + i * lb, lhs[ii + i] + kk, lb, isa);
+          }
+          for (size_t i = 0; i < nb; ++i) {
+            float* r = ret[ii + i] + jj;
+            for (size_t k = 0; k < lb; ++k) {
+              float aik = a[i * lb + k];
+              const float* bk = b.data() + k * mb;
+              for (size_t j = 0; j < mb; ++j) r[j] += aik * bk[j];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_FLOAT16_HPP_
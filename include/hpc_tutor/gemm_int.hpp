@@ -0,0 +1,418 @@
+#ifndef HPC_TUTOR_GEMM_INT_HPP_
+#define HPC_TUTOR_GEMM_INT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "cpu.hpp"
+#include "matrix_view.hpp"
+#include "memory.hpp"
+
+namespace tutor {
+
+/**
+ * Instruction sets of the integer GEMM kernels.
+ */
+enum class IntGemmIsa {
+  kPortable,    ///< Plain C++, any target.
+  kAvx2,        ///< 16-bit products with vpmaddwd.
+  kAvx512Vnni,  ///< 8-bit products with vpdpbusd, 16-bit with vpdpwssd.
+};
+
+/**
+ * Returns whether the running CPU supports `isa`.
+ */
+inline bool IntGemmIsaSupported(IntGemmIsa isa) {
+  switch (isa) {
+    case IntGemmIsa::kPortable:
+      return true;
+#ifdef HPC_TUTOR_X86_KERNELS
+    case IntGemmIsa::kAvx2:
+      return __builtin_cpu_supports("avx2");
+    case IntGemmIsa::kAvx512Vnni:
+      return __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512vnni");
+#endif
+    default:
+      return false;
+  }
+}
+
+/**
+ * Returns the best instruction set supported by the running CPU
+ * within the level of `DetectIsa`, so `HPC_TUTOR_ISA` caps it too.
+ */
+inline IntGemmIsa DetectIntGemmIsa() {
+  static const IntGemmIsa isa = [] {
+    if (DetectIsa() >= Isa::kAvx512 &&
+        IntGemmIsaSupported(IntGemmIsa::kAvx512Vnni)) {
+      return IntGemmIsa::kAvx512Vnni;
+    }
+    if (DetectIsa() >= Isa::kAvx2 && IntGemmIsaSupported(IntGemmIsa::kAvx2)) {
+      return IntGemmIsa::kAvx2;
+    }
+    return IntGemmIsa::kPortable;
+  }();
+  return isa;
+}
+
+namespace detail {
+
+template <typename T>
+inline constexpr bool kIsGemmInt = std::is_same_v<T, int8_t> ||
+                                   std::is_same_v<T, uint8_t> ||
+                                   std::is_same_v<T, int16_t>;
+
+/**
+ * Packed layouts of the integer kernels.
+ */
+enum class IntFormat {
+  kInt32,  ///< Row-major int32 copy, for the portable kernel.
+  kS16,    ///< Pairs of consecutive k, products of 16-bit values.
+  kU8S8,   ///< Groups of 4 consecutive k, unsigned by signed 8-bit products.
+};
+
+/**
+ * Rows of a register tile; lhs blocks are padded with zero rows to it.
+ */
+inline constexpr size_t kIntTileRows = 4;
+
+/**
+ * Rows of lhs packed at a time.
+ */
+inline constexpr size_t kIntRowBlock = 64;
+
+/**
+ * Returns the number of consecutive k in a group of `format`.
+ */
+constexpr size_t IntGroup(IntFormat format) {
+  return format == IntFormat::kU8S8 ? 4 : format == IntFormat::kS16 ? 2 : 1;
+}
+
+/**
+ * Returns the columns of a register tile of `isa`: two vectors of int32.
+ */
+constexpr size_t IntTileCols(IntGemmIsa isa) {
+  return isa == IntGemmIsa::kAvx512Vnni ? 32 : 16;
+}
+
+#ifdef HPC_TUTOR_X86_KERNELS
+
+inline int32_t LoadGroup(const void* p) {
+  int32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/**
+ * 4 x 32 tile of 8-bit products: each vpdpbusd multiplies 4 unsigned by
+ * 4 signed bytes and adds them to an int32 lane, without saturation.
+ */
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) inline void
+KernelU8S8Vnni512(const uint8_t* a, size_t lda, const int8_t* b,
+                  size_t groups, int32_t* tile) {
+  __m512i acc[kIntTileRows][2];
+  for (auto& row : acc) row[0] = row[1] = _mm512_setzero_si512();
+  for (size_t g = 0; g < groups; ++g, b += 128) {
+    __m512i b0 = _mm512_loadu_si512(b);
+    __m512i b1 = _mm512_loadu_si512(b + 64);
+    for (size_t r = 0; r < kIntTileRows; ++r) {
+      __m512i ar = _mm512_set1_epi32(LoadGroup(a + r * lda + 4 * g));
+      acc[r][0] = _mm512_dpbusd_epi32(acc[r][0], ar, b0);
+      acc[r][1] = _mm512_dpbusd_epi32(acc[r][1], ar, b1);
+    }
+  }
+  for (size_t r = 0; r < kIntTileRows; ++r) {
+    _mm512_storeu_si512(tile + 32 * r, acc[r][0]);
+    _mm512_storeu_si512(tile + 32 * r + 16, acc[r][1]);
+  }
+}
+
+/**
+ * 4 x 32 tile of 16-bit products with vpdpwssd.
+ */
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) inline void
+KernelS16Vnni512(const int16_t* a, size_t lda, const int16_t* b,
+                 size_t groups, int32_t* tile) {
+  __m512i acc[kIntTileRows][2];
+  for (auto& row : acc) row[0] = row[1] = _mm512_setzero_si512();
+  for (size_t g = 0; g < groups; ++g, b += 64) {
+    __m512i b0 = _mm512_loadu_si512(b);
+    __m512i b1 = _mm512_loadu_si512(b + 32);
+    for (size_t r = 0; r < kIntTileRows; ++r) {
+      __m512i ar = _mm512_set1_epi32(LoadGroup(a + r * lda + 2 * g));
+      acc[r][0] = _mm512_dpwssd_epi32(acc[r][0], ar, b0);
+      acc[r][1] = _mm512_dpwssd_epi32(acc[r][1], ar, b1);
+    }
+  }
+  for (size_t r = 0; r < kIntTileRows; ++r) {
+    _mm512_storeu_si512(tile + 32 * r, acc[r][0]);
+    _mm512_storeu_si512(tile + 32 * r + 16, acc[r][1]);
+  }
+}
+
+/**
+ * 4 x 16 tile of 16-bit products with vpmaddwd.
+ * 8-bit inputs are widened when packed: vpmaddubsw would saturate
+ * its 16-bit sums of two products.
+ */
+__attribute__((target("avx2"))) inline void KernelS16Avx2(
+    const int16_t* a, size_t lda, const int16_t* b, size_t groups,
+    int32_t* tile) {
+  __m256i acc[kIntTileRows][2];
+  for (auto& row : acc) row[0] = row[1] = _mm256_setzero_si256();
+  for (size_t g = 0; g < groups; ++g, b += 32) {
+    __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16));
+    for (size_t r = 0; r < kIntTileRows; ++r) {
+      __m256i ar = _mm256_set1_epi32(LoadGroup(a + r * lda + 2 * g));
+      acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(ar, b0));
+      acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(ar, b1));
+    }
+  }
+  for (size_t r = 0; r < kIntTileRows; ++r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + 16 * r), acc[r][0]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + 16 * r + 8),
+                        acc[r][1]);
+  }
+}
+
+#endif  // HPC_TUTOR_X86_KERNELS
+
+}  // namespace detail
+
+/**
+ * Right operand of the integer `Gemm`, packed for its kernels.
+ *
+ * Packing reorders `rhs` so that each load of the kernels
+ * brings the consecutive k of a group for a whole row of lanes:
+ * groups of 4 bytes for vpdpbusd, pairs of 16-bit values otherwise.
+ * Pack a matrix once to multiply it by many left operands,
+ * e.g., the weights of a scoring model.
+ * `A` is the type of the left operands; 8-bit products are used
+ * when both are 8-bit and `rhs` is signed, otherwise 16-bit ones.
+ */
+template <typename A, typename B>
+class PackedIntRhs {
+  static_assert(detail::kIsGemmInt<A> && detail::kIsGemmInt<B>,
+                "integer Gemm takes int8_t, uint8_t or int16_t operands");
+
+ public:
+  /**
+   * Packs `rhs` for `isa`, which must be supported by the CPU.
+   */
+  explicit PackedIntRhs(const MatrixView<B>& rhs,
+                        IntGemmIsa isa = DetectIntGemmIsa())
+      : rows_(rhs.rows()), cols_(rhs.cols()), isa_(isa) {
+    if (!IntGemmIsaSupported(isa)) {
+      throw std::invalid_argument("integer Gemm ISA not supported by the CPU");
+    }
+    if (isa == IntGemmIsa::kPortable) {
+      format_ = detail::IntFormat::kInt32;
+    } else if (isa == IntGemmIsa::kAvx512Vnni && sizeof(A) == 1 &&
+               std::is_same_v<B, int8_t>) {
+      format_ = detail::IntFormat::kU8S8;
+    } else {
+      format_ = detail::IntFormat::kS16;
+    }
+    if (format_ == detail::IntFormat::kInt32) {
+      wide_.resize(rows_ * cols_);
+      for (size_t k = 0; k < rows_; ++k) {
+        std::copy(rhs[k], rhs[k] + cols_, wide_.data() + k * cols_);
+      }
+    } else if (format_ == detail::IntFormat::kS16) {
+      Pack(rhs, half_);
+    } else {
+      Pack(rhs, byte_);
+      // (a + 128) b = a b + 128 b: int8 lhs are shifted to unsigned
+      // and the column sums of rhs correct the result.
+      colSums_.assign(cols_, 0);
+      for (size_t k = 0; k < rows_; ++k) {
+        for (size_t j = 0; j < cols_; ++j) {
+          colSums_[j] += static_cast<uint32_t>(static_cast<int32_t>(rhs[k][j]));
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] size_t rows() const noexcept { return rows_; }
+  [[nodiscard]] size_t cols() const noexcept { return cols_; }
+  [[nodiscard]] IntGemmIsa isa() const noexcept { return isa_; }
+
+  /**
+   * Adds lhs rows [lo, hi) times this matrix to the same rows of `ret`.
+   */
+  void MultiplyRows(MatrixView<int32_t> ret, const MatrixView<A>& lhs,
+                    size_t lo, size_t hi) const {
+    if (format_ == detail::IntFormat::kInt32) {
+      MultiplyPortable(ret, lhs, lo, hi);
+      return;
+    }
+#ifdef HPC_TUTOR_X86_KERNELS
+    if (format_ == detail::IntFormat::kS16) {
+      MultiplyPacked(ret, lhs, lo, hi, half_);
+    } else {
+      MultiplyPacked(ret, lhs, lo, hi, byte_);
+    }
+#endif
+  }
+
+ private:
+  size_t groups() const { return (rows_ + group() - 1) / group(); }
+  size_t group() const { return detail::IntGroup(format_); }
+  size_t tileCols() const { return detail::IntTileCols(isa_); }
+
+  /**
+   * Layout: column panels of `tileCols()`; within a panel, by groups of k,
+   * a row of `group()` values of rhs column per lane, zero padded.
+   */
+  template <typename P>
+  void Pack(const MatrixView<B>& rhs, detail::Workspace<P>& out) {
+    size_t g = group(), w = tileCols();
+    size_t panels = (cols_ + w - 1) / w;
+    out.assign(panels * groups() * w * g, P(0));
+    for (size_t k = 0; k < rows_; ++k) {
+      for (size_t j = 0; j < cols_; ++j) {
+        size_t panel = j / w, lane = j % w;
+        out[((panel * groups() + k / g) * w + lane) * g + k % g] =
+            static_cast<P>(rhs[k][j]);
+      }
+    }
+  }
+
+  /**
+   * Uses uint32 arithmetic: sums wrap modulo 2^32 as in the SIMD kernels.
+   */
+  void MultiplyPortable(MatrixView<int32_t> ret, const MatrixView<A>& lhs,
+                        size_t lo, size_t hi) const {
+    detail::Workspace<uint32_t> acc(cols_);
+    for (size_t i = lo; i < hi; ++i) {
+      for (size_t j = 0; j < cols_; ++j) acc[j] = ret[i][j];
+      for (size_t k = 0; k < rows_; ++k) {
+        auto a = static_cast<uint32_t>(static_cast<int32_t>(lhs[i][k]));
+        const int32_t* b = wide_.data() + k * cols_;
+        for (size_t j = 0; j < cols_; ++j) {
+          acc[j] += a * static_cast<uint32_t>(b[j]);
+        }
+      }
+      for (size_t j = 0; j < cols_; ++j) {
+        ret[i][j] = static_cast<int32_t>(acc[j]);
+      }
+    }
+  }
+
+#ifdef HPC_TUTOR_X86_KERNELS
+  template <typename P>
+  void MultiplyPacked(MatrixView<int32_t> ret, const MatrixView<A>& lhs,
+                      size_t lo, size_t hi,
+                      const detail::Workspace<P>& packed) const {
+    using L = std::conditional_t<std::is_same_v<P, int8_t>, uint8_t, int16_t>;
+    constexpr size_t kRows = detail::kIntTileRows;
+    constexpr bool kShift = std::is_same_v<L, uint8_t> &&
+                            std::is_same_v<A, int8_t>;
+    size_t g = group(), w = tileCols(), ng = groups(), lda = ng * g;
+    size_t panels = (cols_ + w - 1) / w;
+    detail::Workspace<L> block(detail::kIntRowBlock * lda);
+    alignas(64) int32_t tile[kRows * 32];
+    for (size_t i0 = lo; i0 < hi; i0 += detail::kIntRowBlock) {
+      size_t mb = std::min(detail::kIntRowBlock, hi - i0);
+      size_t mp = (mb + kRows - 1) / kRows * kRows;
+      // Pack the rows, padded with zeros to whole groups and tiles.
+      std::fill(block.begin(), block.begin() + mp * lda, L(0));
+      for (size_t r = 0; r < mb; ++r) {
+        L* dst = block.data() + r * lda;
+        for (size_t k = 0; k < rows_; ++k) {
+          dst[k] = static_cast<L>(kShift ? lhs[i0 + r][k] + 128
+                                         : lhs[i0 + r][k]);
+        }
+      }
+      for (size_t p = 0; p < panels; ++p) {
+        const P* b = packed.data() + p * ng * w * g;
+        size_t j0 = p * w, nc = std::min(w, cols_ - j0);
+        for (size_t r0 = 0; r0 < mb; r0 += kRows) {
+          const L* a = block.data() + r0 * lda;
+          if constexpr (std::is_same_v<P, int8_t>) {
+            detail::KernelU8S8Vnni512(a, lda, b, ng, tile);
+          } else if (w == 32) {
+            detail::KernelS16Vnni512(a, lda, b, ng, tile);
+          } else {
+            detail::KernelS16Avx2(a, lda, b, ng, tile);
+          }
+          for (size_t r = 0; r < std::min(kRows, mb - r0); ++r) {
+            int32_t* c = ret[i0 + r0 + r] + j0;
+            for (size_t j = 0; j < nc; ++j) {
+              auto v = static_cast<uint32_t>(tile[r * w + j]);
+              if constexpr (kShift) v -= 128u * colSums_[j0 + j];
+              c[j] = static_cast<int32_t>(static_cast<uint32_t>(c[j]) + v);
+            }
+          }
+        }
+      }
+    }
+  }
+#endif
+
+  size_t rows_, cols_;
+  IntGemmIsa isa_;
+  detail::IntFormat format_;
+  detail::Workspace<int8_t> byte_;
+  detail::Workspace<int16_t> half_;
+  detail::Workspace<int32_t> wide_;
+  detail::Workspace<uint32_t> colSums_;
+};
+
+/**
+ * Integer Matrix Multiplication with a packed right operand.
+ *
+ * Adds (not stores) `lhs` times `rhs` to `ret`, as the generic `Gemm`,
+ * accumulating in int32 modulo 2^32.
+ * The sizes of `ret`, `lhs` and `rhs` must be (n, m), (n, l) and (l, m).
+ */
+template <typename A, typename B>
+void Gemm(MatrixView<int32_t> ret, const MatrixView<A>& lhs,
+          const PackedIntRhs<A, B>& rhs) {
+  rhs.MultiplyRows(ret, lhs, 0, ret.rows());
+}
+
+/**
+ * Integer Matrix Multiplication.
+ *
+ * Multiplies `int8_t`, `uint8_t` or `int16_t` matrices into `int32_t`:
+ * packs `rhs` (see `PackedIntRhs`) and adds the product to `ret`.
+ */
+template <typename A, typename B,
+          std::enable_if_t<detail::kIsGemmInt<A> && detail::kIsGemmInt<B>,
+                           bool> = true>
+void Gemm(MatrixView<int32_t> ret, const MatrixView<A>& lhs,
+          const MatrixView<B>& rhs, IntGemmIsa isa = DetectIntGemmIsa()) {
+  Gemm(ret, lhs, PackedIntRhs<A, B>(rhs, isa));
+}
+
+/**
+ * Integer Matrix Multiplication with a packed right operand
+ * (with thread-level parallelism).
+ *
+ * Same result as `Gemm`. Threads work on disjoint row blocks of `lhs`.
+ * Runs serially in targets built without OpenMP.
+ */
+template <typename A, typename B>
+void Gemm_t(MatrixView<int32_t> ret, const MatrixView<A>& lhs,
+            const PackedIntRhs<A, B>& rhs) {
+  size_t nb = (ret.rows() + detail::kIntRowBlock - 1) / detail::kIntRowBlock;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (size_t b = 0; b < nb; ++b) {
+    size_t lo = b * detail::kIntRowBlock;
+    rhs.MultiplyRows(ret, lhs, lo,
+                     std::min(ret.rows(), lo + detail::kIntRowBlock));
+  }
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_GEMM_INT_HPP_
@@ -0,0 +1,583 @@
+#ifndef HPC_TUTOR_KRYLOV_HPP_
+#define HPC_TUTOR_KRYLOV_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "linalg.hpp"
+#include "linalg_t.hpp"
+#include "matrix_view.hpp"
+#include "memory.hpp"
+
+namespace tutor {
+
+/**
+ * Settings of the iterative solvers `Cg_t` and `Gmres_t`.
+ */
+struct KrylovOptions {
+  /**
+   * Largest number of iterations (matrix applications, restarts aside).
+   */
+  size_t maxIterations = 1000;
+
+  /**
+   * Convergence threshold on the relative residual ||b - Ax|| / ||b||,
+   * or on ||b - Ax|| if b is zero.
+   */
+  double tolerance = 1e-8;
+
+  /**
+   * GMRES: size of the Krylov basis between restarts.
+   */
+  size_t restart = 30;
+
+  /**
+   * CG: use the pipelined variant (Ghysels and Vanroose, 2014),
+   * which computes both inner products of an iteration in one reduction
+   * fused with the vector updates, instead of two separate reductions.
+   * It trades some numerical stability for fewer synchronizations.
+   */
+  bool pipelined = false;
+};
+
+/**
+ * Report of an iterative solve.
+ */
+struct KrylovStats {
+  size_t iterations = 0;  ///< Iterations performed.
+  bool converged = false;
+  double seconds = 0;     ///< Wall time of the whole solve.
+
+  /**
+   * Relative residual norm before the first iteration and after each one,
+   * as estimated by the recurrences of the method.
+   */
+  std::vector<double> residualHistory;
+
+  /**
+   * Wall time of each iteration.
+   */
+  std::vector<double> iterationSeconds;
+
+  /**
+   * Returns the last relative residual norm.
+   */
+  [[nodiscard]] double residual() const noexcept {
+    return residualHistory.empty() ? 0 : residualHistory.back();
+  }
+};
+
+namespace detail {
+
+/**
+ * Elements processed at a time by the multi-vector kernels,
+ * small enough for a block of every basis vector to stay in cache.
+ */
+inline constexpr size_t kKrylovBlock = 512;
+
+/**
+ * Inner product of short vectors.
+ * The SIMD reduction reorders the sum, so it vectorizes without fast-math;
+ * the kernels below use the same kind of reduction.
+ */
+template <typename T>
+T BlockInner(const T* lhs, const T* rhs, size_t n) {
+  T sum = 0;
+#pragma omp simd reduction(+ : sum)
+  for (size_t i = 0; i < n; ++i) sum += lhs[i] * rhs[i];
+  return sum;
+}
+
+/**
+ * Fixed number of sums reduced together, for use with `Partials`.
+ */
+template <typename T, size_t K>
+struct Sums {
+  T v[K] = {};
+
+  Sums& operator+=(const Sums& other) {
+    for (size_t k = 0; k < K; ++k) v[k] += other.v[k];
+    return *this;
+  }
+};
+
+/**
+ * Variable number of sums reduced together, for use with `Partials`.
+ */
+template <typename T>
+struct SumVector {
+  std::vector<T> v;
+
+  SumVector& operator+=(const SumVector& other) {
+    v.resize(std::max(v.size(), other.v.size()));
+    for (size_t k = 0; k < other.v.size(); ++k) v[k] += other.v[k];
+    return *this;
+  }
+};
+
+/**
+ * Dense operator y = Ax with thread-level parallelism by rows.
+ */
+template <typename T>
+class DenseOperator {
+ public:
+  explicit DenseOperator(const MatrixView<T>& a) : a_(a) {}
+
+  void Apply(T* y, const T* x) const { ApplyDot(y, x); }
+
+  /**
+   * Computes y = Ax and returns x^T y in the same pass.
+   */
+  T ApplyDot(T* y, const T* x) const {
+    Partials<T> partials;
+#pragma omp parallel if (a_.rows() * a_.cols() >= kParallelVectorElements)
+    {
+      auto [lo, hi] = StaticChunk<T>(a_.rows());
+      T dot = 0;
+      for (size_t i = lo; i < hi; ++i) {
+        y[i] = BlockInner(a_[i], x, a_.cols());
+        dot += x[i] * y[i];
+      }
+      partials.Set(dot);
+    }
+    return partials.Combine();
+  }
+
+ private:
+  MatrixView<T> a_;
+};
+
+/**
+ * Matrix-free operator given by a callable `op(y, x)` computing y = Ax.
+ */
+template <typename T, typename F>
+class FunctionOperator {
+ public:
+  FunctionOperator(F op, size_t n) : op_(std::move(op)), n_(n) {}
+
+  void Apply(T* y, const T* x) const { op_(y, x); }
+
+  T ApplyDot(T* y, const T* x) const {
+    op_(y, x);
+    return Inner_t(x, y, n_);
+  }
+
+ private:
+  F op_;
+  size_t n_;
+};
+
+/**
+ * r = b - r (r holds Ax on entry); returns r^T r.
+ */
+template <typename T>
+T ResidualFrom(T* r, const T* b, size_t n) {
+  Partials<T> partials;
+#pragma omp parallel if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    T rr = 0;
+#pragma omp simd reduction(+ : rr)
+    for (size_t i = lo; i < hi; ++i) {
+      r[i] = b[i] - r[i];
+      rr += r[i] * r[i];
+    }
+    partials.Set(rr);
+  }
+  return partials.Combine();
+}
+
+/**
+ * CG residual update r -= alpha q; returns the new r^T r.
+ */
+template <typename T>
+T CgResidualUpdate(T* r, const T* q, T alpha, size_t n) {
+  Partials<T> partials;
+#pragma omp parallel if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    T rr = 0;
+#pragma omp simd reduction(+ : rr)
+    for (size_t i = lo; i < hi; ++i) {
+      r[i] -= alpha * q[i];
+      rr += r[i] * r[i];
+    }
+    partials.Set(rr);
+  }
+  return partials.Combine();
+}
+
+/**
+ * CG solution and direction updates x += alpha p, p = r + beta p.
+ */
+template <typename T>
+void CgSearchUpdate(T* x, T* p, const T* r, T alpha, T beta, size_t n) {
+#pragma omp parallel if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    for (size_t i = lo; i < hi; ++i) {
+      x[i] += alpha * p[i];
+      p[i] = r[i] + beta * p[i];
+    }
+  }
+}
+
+/**
+ * All the vector updates of a pipelined CG iteration in one pass.
+ * Returns r^T r and w^T r of the updated vectors.
+ */
+template <typename T>
+Sums<T, 2> PipelinedCgUpdate(T* x, T* r, T* w, T* p, T* s, T* z, const T* q,
+                             T alpha, T beta, size_t n) {
+  Partials<Sums<T, 2>> partials;
+#pragma omp parallel if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    T rr = 0, wr = 0;
+#pragma omp simd reduction(+ : rr, wr)
+    for (size_t i = lo; i < hi; ++i) {
+      z[i] = q[i] + beta * z[i];
+      s[i] = w[i] + beta * s[i];
+      p[i] = r[i] + beta * p[i];
+      x[i] += alpha * p[i];
+      r[i] -= alpha * s[i];
+      w[i] -= alpha * z[i];
+      rr += r[i] * r[i];
+      wr += w[i] * r[i];
+    }
+    partials.Set({{rr, wr}});
+  }
+  return partials.Combine();
+}
+
+/**
+ * Returns r^T r and w^T r.
+ */
+template <typename T>
+Sums<T, 2> PipelinedCgDots(const T* r, const T* w, size_t n) {
+  Partials<Sums<T, 2>> partials;
+#pragma omp parallel if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    T rr = 0, wr = 0;
+#pragma omp simd reduction(+ : rr, wr)
+    for (size_t i = lo; i < hi; ++i) {
+      rr += r[i] * r[i];
+      wr += w[i] * r[i];
+    }
+    partials.Set({{rr, wr}});
+  }
+  return partials.Combine();
+}
+
+/**
+ * Classical Gram-Schmidt projection: h = V^T w
+ * for the `k` basis vectors stored as rows of `v`.
+ * All the inner products are computed in one pass over memory.
+ */
+template <typename T>
+std::vector<T> ArnoldiProject(const MatrixView<T>& v, size_t k, const T* w) {
+  size_t n = v.cols();
+  Partials<SumVector<T>> partials;
+#pragma omp parallel if (n * k >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    SumVector<T> h{std::vector<T>(k)};
+    for (size_t b = lo; b < hi; b += kKrylovBlock) {
+      size_t nb = std::min(kKrylovBlock, hi - b);
+      for (size_t l = 0; l < k; ++l) {
+        h.v[l] += BlockInner(v[l] + b, w + b, nb);
+      }
+    }
+    partials.Set(std::move(h));
+  }
+  auto h = partials.Combine().v;
+  h.resize(k);
+  return h;
+}
+
+/**
+ * Fused Gram-Schmidt correction and reorthogonalization projection:
+ * w -= V h, then returns V^T w followed by w^T w, all in one pass.
+ */
+template <typename T>
+std::vector<T> ArnoldiCorrect(const MatrixView<T>& v, size_t k, T* w,
+                              const std::vector<T>& h) {
+  size_t n = v.cols();
+  Partials<SumVector<T>> partials;
+#pragma omp parallel if (n * k >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    SumVector<T> h2{std::vector<T>(k + 1)};
+    for (size_t b = lo; b < hi; b += kKrylovBlock) {
+      size_t nb = std::min(kKrylovBlock, hi - b);
+      for (size_t l = 0; l < k; ++l) {
+        const T* vl = v[l] + b;
+        T hl = h[l];
+        for (size_t i = 0; i < nb; ++i) w[b + i] -= hl * vl[i];
+      }
+      for (size_t l = 0; l < k; ++l) {
+        h2.v[l] += BlockInner(v[l] + b, w + b, nb);
+      }
+      h2.v[k] += BlockInner(w + b, w + b, nb);
+    }
+    partials.Set(std::move(h2));
+  }
+  auto h2 = partials.Combine().v;
+  h2.resize(k + 1);
+  return h2;
+}
+
+/**
+ * Final Gram-Schmidt correction and normalization: w = (w - V h) * scale.
+ */
+template <typename T>
+void ArnoldiNormalize(const MatrixView<T>& v, size_t k, T* w,
+                      const std::vector<T>& h, T scale) {
+  size_t n = v.cols();
+#pragma omp parallel if (n * k >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    for (size_t b = lo; b < hi; b += kKrylovBlock) {
+      size_t nb = std::min(kKrylovBlock, hi - b);
+      for (size_t l = 0; l < k; ++l) {
+        const T* vl = v[l] + b;
+        T hl = h[l];
+        for (size_t i = 0; i < nb; ++i) w[b + i] -= hl * vl[i];
+      }
+      for (size_t i = 0; i < nb; ++i) w[b + i] *= scale;
+    }
+  }
+}
+
+/**
+ * x += V^T y for the `k` basis vectors stored as rows of `v`.
+ */
+template <typename T>
+void ArnoldiCombine(T* x, const MatrixView<T>& v, size_t k,
+                    const std::vector<T>& y) {
+  size_t n = v.cols();
+#pragma omp parallel if (n * k >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(n);
+    for (size_t b = lo; b < hi; b += kKrylovBlock) {
+      size_t nb = std::min(kKrylovBlock, hi - b);
+      for (size_t l = 0; l < k; ++l) {
+        const T* vl = v[l] + b;
+        T yl = y[l];
+        for (size_t i = 0; i < nb; ++i) x[b + i] += yl * vl[i];
+      }
+    }
+  }
+}
+
+inline double SecondsBetween(std::chrono::steady_clock::time_point start,
+                             std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+/**
+ * Records the residual and the time of an iteration;
+ * returns whether the solve has converged.
+ */
+inline bool KrylovStep(KrylovStats& stats, double residual, double tolerance,
+                       std::chrono::steady_clock::time_point& last) {
+  auto now = std::chrono::steady_clock::now();
+  stats.iterationSeconds.push_back(SecondsBetween(last, now));
+  last = now;
+  ++stats.iterations;
+  stats.residualHistory.push_back(residual);
+  return stats.converged = residual <= tolerance;
+}
+
+template <typename T, typename Op>
+KrylovStats Cg(const Op& op, size_t n, T* x, const T* b,
+               const KrylovOptions& options) {
+  using std::sqrt;
+  KrylovStats stats;
+  auto start = std::chrono::steady_clock::now(), last = start;
+  T bnorm = sqrt(Inner_t(b, b, n));
+  if (bnorm == T(0)) bnorm = 1;
+  Workspace<T> r(n), q(n), p(n);
+  op.Apply(r.data(), x);
+  T rr = ResidualFrom(r.data(), b, n);
+  stats.residualHistory.push_back(sqrt(rr) / bnorm);
+  stats.converged = stats.residual() <= options.tolerance;
+
+  if (!options.pipelined) {
+    std::copy(r.begin(), r.end(), p.begin());
+    while (!stats.converged && stats.iterations < options.maxIterations) {
+      T alpha = rr / op.ApplyDot(q.data(), p.data());
+      T rrNext = CgResidualUpdate(r.data(), q.data(), alpha, n);
+      T beta = rrNext / rr;
+      CgSearchUpdate(x, p.data(), r.data(), alpha, beta, n);
+      rr = rrNext;
+      KrylovStep(stats, sqrt(rr) / bnorm, options.tolerance, last);
+    }
+  } else {
+    Workspace<T> w(n), s(n, T(0)), z(n, T(0));
+    std::fill(p.begin(), p.end(), T(0));
+    op.Apply(w.data(), r.data());
+    auto dots = PipelinedCgDots(r.data(), w.data(), n);
+    T alpha = 0, gammaPrev = 0;
+    while (!stats.converged && stats.iterations < options.maxIterations) {
+      T gamma = dots.v[0], delta = dots.v[1];
+      op.Apply(q.data(), w.data());
+      T beta = 0;
+      if (stats.iterations == 0) {
+        alpha = gamma / delta;
+      } else {
+        beta = gamma / gammaPrev;
+        alpha = gamma / (delta - beta * gamma / alpha);
+      }
+      dots = PipelinedCgUpdate(x, r.data(), w.data(), p.data(), s.data(),
+                               z.data(), q.data(), alpha, beta, n);
+      gammaPrev = gamma;
+      KrylovStep(stats, sqrt(dots.v[0]) / bnorm, options.tolerance, last);
+    }
+  }
+  stats.seconds = SecondsBetween(start, std::chrono::steady_clock::now());
+  return stats;
+}
+
+template <typename T, typename Op>
+KrylovStats Gmres(const Op& op, size_t n, T* x, const T* b,
+                  const KrylovOptions& options) {
+  using std::abs;
+  using std::sqrt;
+  KrylovStats stats;
+  auto start = std::chrono::steady_clock::now(), last = start;
+  size_t m = std::max<size_t>(1, options.restart);
+  T bnorm = sqrt(Inner_t(b, b, n));
+  if (bnorm == T(0)) bnorm = 1;
+  // Basis vectors are the rows of v; h is the Hessenberg matrix by columns.
+  Workspace<T> basis((m + 1) * n), hess(m * (m + 1));
+  MatrixView<T> v(basis.data(), m + 1, n, n), h(hess.data(), m, m + 1, m + 1);
+  std::vector<T> cs(m), sn(m), g(m + 1);
+  while (true) {
+    op.Apply(v[0], x);
+    T beta = sqrt(ResidualFrom(v[0], b, n));
+    if (stats.residualHistory.empty()) {
+      stats.residualHistory.push_back(beta / bnorm);
+    }
+    stats.converged = beta / bnorm <= options.tolerance;
+    if (stats.converged || stats.iterations >= options.maxIterations) break;
+    ScalarMul_t(v[0], n, T(1) / beta);
+    std::fill(g.begin(), g.end(), T(0));
+    g[0] = beta;
+    size_t k = 0;
+    while (k < m && stats.iterations < options.maxIterations) {
+      // Arnoldi step with classical Gram-Schmidt, applied twice.
+      T* w = v[k + 1];
+      op.Apply(w, v[k]);
+      auto h1 = ArnoldiProject(v, k + 1, w);
+      auto h2 = ArnoldiCorrect(v, k + 1, w, h1);
+      T norm2 = h2[k + 1];
+      for (size_t l = 0; l <= k; ++l) norm2 -= h2[l] * h2[l];
+      T norm = sqrt(std::max(norm2, T(0)));
+      ArnoldiNormalize(v, k + 1, w, h2, norm > T(0) ? T(1) / norm : T(0));
+      T* hk = h[k];
+      for (size_t l = 0; l <= k; ++l) hk[l] = h1[l] + h2[l];
+      hk[k + 1] = norm;
+      // Keep the Hessenberg matrix triangular with Givens rotations.
+      for (size_t l = 0; l < k; ++l) {
+        T t = cs[l] * hk[l] + sn[l] * hk[l + 1];
+        hk[l + 1] = -sn[l] * hk[l] + cs[l] * hk[l + 1];
+        hk[l] = t;
+      }
+      T rho = sqrt(hk[k] * hk[k] + hk[k + 1] * hk[k + 1]);
+      cs[k] = hk[k] / rho;
+      sn[k] = hk[k + 1] / rho;
+      hk[k] = rho;
+      hk[k + 1] = 0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] *= cs[k];
+      ++k;
+      // A zero norm means the Krylov space is invariant: x is exact.
+      if (KrylovStep(stats, abs(g[k]) / bnorm, options.tolerance, last) ||
+          norm == T(0)) {
+        break;
+      }
+    }
+    // Solve the triangular system and update x.
+    std::vector<T> y(k);
+    for (size_t i = k; i-- > 0;) {
+      T sum = g[i];
+      for (size_t j = i + 1; j < k; ++j) sum -= h[j][i] * y[j];
+      y[i] = sum / h[i][i];
+    }
+    ArnoldiCombine(x, v, k, y);
+    if (stats.converged) break;
+  }
+  stats.seconds = SecondsBetween(start, std::chrono::steady_clock::now());
+  return stats;
+}
+
+}  // namespace detail
+
+/**
+ * Conjugate Gradient Solver (with thread-level parallelism).
+ *
+ * Solves Ax = b for a symmetric positive definite matrix `a`,
+ * starting from the guess in `x`, which receives the solution.
+ * Each iteration is a matrix application with the inner product fused in,
+ * a residual update with its norm fused in and one direction update,
+ * instead of a separate memory pass and fork/join per vector operation.
+ * See `KrylovOptions::pipelined` for the pipelined variant.
+ */
+template <typename T>
+KrylovStats Cg_t(const MatrixView<T>& a, T* x, const T* b,
+                 const KrylovOptions& options = {}) {
+  return detail::Cg(detail::DenseOperator<T>(a), a.rows(), x, b, options);
+}
+
+/**
+ * Conjugate Gradient Solver (matrix-free, with thread-level parallelism).
+ *
+ * Same as the dense version for an operator of size n
+ * given by a callable `op(y, x)` that computes y = Ax.
+ */
+template <typename T, typename F>
+KrylovStats Cg_t(F op, size_t n, T* x, const T* b,
+                 const KrylovOptions& options = {}) {
+  return detail::Cg(detail::FunctionOperator<T, F>(std::move(op), n), n, x, b,
+                    options);
+}
+
+/**
+ * Restarted GMRES Solver (with thread-level parallelism).
+ *
+ * Solves Ax = b for a nonsingular matrix `a`,
+ * starting from the guess in `x`, which receives the solution.
+ * The Krylov basis is orthogonalized by classical Gram-Schmidt
+ * applied twice, so all the projections against the basis
+ * take one pass over memory and one reduction,
+ * with the second projection fused into the first correction.
+ * The basis is rebuilt from the current x every `options.restart` steps.
+ */
+template <typename T>
+KrylovStats Gmres_t(const MatrixView<T>& a, T* x, const T* b,
+                    const KrylovOptions& options = {}) {
+  return detail::Gmres(detail::DenseOperator<T>(a), a.rows(), x, b, options);
+}
+
+/**
+ * Restarted GMRES Solver (matrix-free, with thread-level parallelism).
+ *
+ * Same as the dense version for an operator of size n
+ * given by a callable `op(y, x)` that computes y = Ax.
+ */
+template <typename T, typename F>
+KrylovStats Gmres_t(F op, size_t n, T* x, const T* b,
+                    const KrylovOptions& options = {}) {
+  return detail::Gmres(detail::FunctionOperator<T, F>(std::move(op), n), n, x,
+                       b, options);
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_KRYLOV_HPP_
@@ -2,9 +2,15 @@
 #define HPC_TUTOR_LINALG_HPP_
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "cpu.hpp"
 #include "matrix_view.hpp"
+#include "memory.hpp"
 
 namespace tutor {
 
@@ -15,9 +21,11 @@ namespace tutor {
  */
 template <typename T>
 void ScalarMul(T* data, size_t n, T val) {
-  for (size_t i = 0; i < n; ++i) {
-    data[i] *= val;
-  }
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < n; ++i) {
+      data[i] *= val;
+    }
+  });
 }
 
 /**
@@ -25,11 +33,13 @@ void ScalarMul(T* data, size_t n, T val) {
  */
 template <typename T>
 T Accumulate(const T* data, size_t n) {
-  T sum = 0;
-  for (size_t i = 0; i < n; ++i) {
-    sum += data[i];
-  }
-  return sum;
+  return detail::Dispatch([&] {
+    T sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+      sum += data[i];
+    }
+    return sum;
+  });
 }
 
 /**
@@ -37,11 +47,13 @@ T Accumulate(const T* data, size_t n) {
  */
 template <typename T>
 T Inner(const T* lhs, const T* rhs, size_t n) {
-  T sum = 0;
-  for (size_t i = 0; i < n; ++i) {
-    sum += lhs[i] * rhs[i];
-  }
-  return sum;
+  return detail::Dispatch([&] {
+    T sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+      sum += lhs[i] * rhs[i];
+    }
+    return sum;
+  });
 }
 
 /**
@@ -49,8 +61,175 @@ T Inner(const T* lhs, const T* rhs, size_t n) {
  */
 template <typename T>
 void VectorSum(T* ret, const T* lhs, const T* rhs, size_t n) {
-  for (size_t i = 0; i < n; ++i) {
-    ret[i] = lhs[i] + rhs[i];
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < n; ++i) {
+      ret[i] = lhs[i] + rhs[i];
+    }
+  });
+}
+
+namespace detail {
+
+/**
+ * Order-Independent Summation.
+ *
+ * Implements the pre-rounding summation of Demmel and Nguyen
+ * ("Fast Reproducible Floating-Point Summation", ARITH 2013).
+ * Each addend is split into `kFolds` slices,
+ * each slice a multiple of a fixed power of two
+ * that only depends on the largest magnitude and the number of addends.
+ * Slices of the same fold add up without rounding errors,
+ * so the result does not depend on the order of the additions
+ * nor on how the addends are split among threads or processes.
+ * The part of each addend below the last fold is dropped:
+ * the error is below n 2^-(3 (52 - log2 n)) times the largest addend.
+ *
+ * Usage: compute the largest magnitude and the total count of addends,
+ * `Add` the addends in any order and partition, `Merge` the partial sums
+ * and take the `Result`. Do not compile with `-ffast-math`,
+ * which breaks the slicing.
+ */
+class ReproducibleSum {
+ public:
+  static constexpr int kFolds = 3;
+
+  ReproducibleSum(double maxAbs, size_t n) {
+    finite_ = std::isfinite(maxAbs);
+    if (!finite_) return;
+    int log2n = n <= 1 ? 0 : 64 - __builtin_clzll(n - 1);
+    int e;
+    std::frexp(maxAbs, &e);  // maxAbs < 2^e
+    int k = e + log2n + 1;
+    // Huge addends are scaled down by a power of two, which is exact.
+    if (k > kMaxExponent) {
+      scale_ = std::ldexp(1.0, kMaxExponent - k);
+      k = kMaxExponent;
+    }
+    for (int f = 0; f < kFolds; ++f) {
+      sigma_[f] = std::ldexp(1.0, std::max(k, kMinExponent));
+      // The remainders of a fold are at most 2^(k - 53).
+      k += log2n + 1 - 53;
+    }
+  }
+
+  /**
+   * Adds `value(i)` for i in [begin, end).
+   */
+  template <typename F>
+  void Add(size_t begin, size_t end, F value) {
+    double s0 = 0, s1 = 0, s2 = 0;
+    if (!finite_) {
+      // Infinities and NaNs propagate in any order.
+      for (size_t i = begin; i < end; ++i) s0 += value(i);
+      sums_[0] += s0;
+      return;
+    }
+    const double g0 = sigma_[0], g1 = sigma_[1], g2 = sigma_[2];
+    const double scale = scale_;
+#pragma omp simd reduction(+ : s0, s1, s2)
+    for (size_t i = begin; i < end; ++i) {
+      double x = value(i) * scale;
+      double q = (g0 + x) - g0;
+      x -= q;
+      s0 += q;
+      q = (g1 + x) - g1;
+      x -= q;
+      s1 += q;
+      s2 += (g2 + x) - g2;
+    }
+    sums_[0] += s0;
+    sums_[1] += s1;
+    sums_[2] += s2;
+  }
+
+  /**
+   * Adds the partial sum of another accumulator
+   * built with the same maximum and count.
+   */
+  void Merge(const ReproducibleSum& other) {
+    for (int f = 0; f < kFolds; ++f) sums_[f] += other.sums_[f];
+  }
+
+  /**
+   * Returns the per-fold sums, e.g., to add them up across processes.
+   */
+  [[nodiscard]] double* folds() noexcept { return sums_; }
+
+  [[nodiscard]] double Result() const {
+    if (!finite_) return sums_[0];
+    return ((sums_[2] + sums_[1]) + sums_[0]) / scale_;
+  }
+
+ private:
+  static constexpr int kMaxExponent = 1020;
+  static constexpr int kMinExponent = -1000;
+
+  bool finite_;
+  double scale_ = 1;
+  double sigma_[kFolds] = {};
+  double sums_[kFolds] = {};
+};
+
+/**
+ * Returns the largest `|value(i)|` for i in [begin, end).
+ */
+template <typename F>
+double MaxAbs(size_t begin, size_t end, F value) {
+  double m = 0;
+#pragma omp simd reduction(max : m)
+  for (size_t i = begin; i < end; ++i) {
+    double x = std::abs(value(i));
+    m = m < x ? x : m;
+  }
+  return m;
+}
+
+/**
+ * Reproducible sum of `value(i)` for i in [0, n).
+ */
+template <typename F>
+double ReproducibleReduce(size_t n, F value) {
+  return Dispatch([&] {
+    ReproducibleSum sum(MaxAbs(0, n, value), n);
+    sum.Add(0, n, value);
+    return sum.Result();
+  });
+}
+
+}  // namespace detail
+
+/**
+ * Accumulation (reproducible).
+ *
+ * The result is bitwise identical for any order of the elements,
+ * and it matches the one of `Accumulate_rt` for any number of threads.
+ * Floating point values are added in double precision.
+ */
+template <typename T>
+T Accumulate_r(const T* data, size_t n) {
+  if constexpr (std::is_integral_v<T>) {
+    return Accumulate(data, n);
+  } else {
+    return static_cast<T>(detail::ReproducibleReduce(
+        n, [data](size_t i) { return static_cast<double>(data[i]); }));
+  }
+}
+
+/**
+ * Vector Inner Product (reproducible).
+ *
+ * The result is bitwise identical for any order of the elements,
+ * and it matches the one of `Inner_rt` for any number of threads.
+ * Floating point products are rounded to double and added in double.
+ */
+template <typename T>
+T Inner_r(const T* lhs, const T* rhs, size_t n) {
+  if constexpr (std::is_integral_v<T>) {
+    return Inner(lhs, rhs, n);
+  } else {
+    return static_cast<T>(detail::ReproducibleReduce(n, [lhs, rhs](size_t i) {
+      return static_cast<double>(lhs[i]) * static_cast<double>(rhs[i]);
+    }));
   }
 }
 
@@ -104,6 +283,86 @@ void MergeSort(T* v, T* aux, size_t n) {
   std::copy(aux, aux + n, v);
 }
 
+/**
+ * Tournament tree of losers over k sources.
+ *
+ * Internal node i keeps the loser of the match played there,
+ * node 0 keeps the overall winner.
+ * Replacing the winner costs one match per level, log2(k) in total,
+ * with a single comparison each, half of what a binary heap needs.
+ * Ties are won by the source with the lower index,
+ * and exhausted sources lose against everything.
+ */
+template <typename T>
+class LoserTree {
+ public:
+  explicit LoserTree(size_t k) : k_(k), tree_(k), keys_(k), live_(k) {}
+
+  /**
+   * Sets the current key of `source`. Call `Build` or `Replay` after.
+   */
+  void Set(size_t source, const T& key) {
+    keys_[source] = key;
+    live_[source] = true;
+  }
+
+  /**
+   * Marks `source` as exhausted.
+   */
+  void Close(size_t source) { live_[source] = false; }
+
+  /**
+   * Plays the whole tournament.
+   */
+  void Build() { tree_[0] = Play(1); }
+
+  /**
+   * Replays the matches of `source`, which must be the last winner.
+   */
+  void Replay(size_t source) {
+    size_t w = source;
+    for (size_t node = (source + k_) / 2; node > 0; node /= 2) {
+      if (Beats(tree_[node], w)) std::swap(tree_[node], w);
+    }
+    tree_[0] = w;
+  }
+
+  /**
+   * Returns the source with the smallest key.
+   */
+  [[nodiscard]] size_t winner() const noexcept { return tree_[0]; }
+
+  /**
+   * Returns false once every source is exhausted.
+   */
+  [[nodiscard]] bool live() const noexcept { return live_[tree_[0]]; }
+
+  [[nodiscard]] const T& key(size_t source) const { return keys_[source]; }
+
+ private:
+  bool Beats(size_t a, size_t b) const {
+    if (!live_[a]) return false;
+    if (!live_[b]) return true;
+    return keys_[a] < keys_[b] || (!(keys_[b] < keys_[a]) && a < b);
+  }
+
+  /**
+   * Returns the winner below `node`; leaves are nodes k to 2k - 1.
+   */
+  size_t Play(size_t node) {
+    if (node >= k_) return node - k_;
+    size_t a = Play(2 * node), b = Play(2 * node + 1);
+    if (Beats(a, b)) std::swap(a, b);
+    tree_[node] = a;
+    return b;
+  }
+
+  size_t k_;
+  std::vector<size_t> tree_;
+  std::vector<T> keys_;
+  std::vector<char> live_;
+};
+
 }  // namespace detail
 
 /**
@@ -118,7 +377,7 @@ void MergeSort(T* v, T* aux, size_t n) {
  */
 template <typename T>
 void MergeSort(T* v, size_t n) {
-  std::vector<T> aux(n);
+  detail::Workspace<T> aux(n);
   detail::MergeSort(v, aux.data(), n);
 }
 
@@ -127,14 +386,115 @@ void MergeSort(T* v, size_t n) {
  */
 template <typename T>
 void MatrixEval(T* ret, const MatrixView<T>& m, const T* v) {
-  for (size_t i = 0; i < m.rows(); ++i) {
-    ret[i] = 0;
-    for (size_t j = 0; j < m.cols(); ++j) {
-      ret[i] += m[i][j] * v[j];
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < m.rows(); ++i) {
+      ret[i] = 0;
+      for (size_t j = 0; j < m.cols(); ++j) {
+        ret[i] += m[i][j] * v[j];
+      }
+    }
+  });
+}
+
+/**
+ * Number of vectors from which the multi-vector `MatrixEval`
+ * switches to register-blocked GEMM kernels.
+ */
+inline constexpr size_t kMatrixEvalGemmVectors = 4;
+
+namespace detail {
+
+/**
+ * Register-blocked kernel for the multi-vector `MatrixEval`.
+ *
+ * Adds the product of the `mr` x `kc` block of `m` starting at (i, p)
+ * and the `kc` x `nr` block of `vs` starting at (p, j)
+ * to the block of `ret` starting at (i, j).
+ * With `mr` = MR and `nr` = NR the accumulators live in registers.
+ */
+template <size_t MR, size_t NR, typename T>
+void MatrixEvalMicro(MatrixView<T>& ret, const MatrixView<T>& m,
+                     const MatrixView<T>& vs, size_t i, size_t j, size_t p,
+                     size_t kc, size_t mr, size_t nr) {
+  T acc[MR][NR] = {};
+  if (mr == MR && nr == NR) {
+    const T* a[MR];
+    for (size_t r = 0; r < MR; ++r) a[r] = m[i + r];
+    for (size_t q = p; q < p + kc; ++q) {
+      const T* b = vs[q] + j;
+      for (size_t r = 0; r < MR; ++r) {
+        for (size_t c = 0; c < NR; ++c) acc[r][c] += a[r][q] * b[c];
+      }
     }
+  } else {
+    for (size_t q = p; q < p + kc; ++q) {
+      const T* b = vs[q] + j;
+      for (size_t r = 0; r < mr; ++r) {
+        T a = m[i + r][q];
+        for (size_t c = 0; c < nr; ++c) acc[r][c] += a * b[c];
+      }
+    }
+  }
+  for (size_t r = 0; r < mr; ++r) {
+    for (size_t c = 0; c < nr; ++c) ret[i + r][j + c] += acc[r][c];
   }
 }
 
+}  // namespace detail
+
+/**
+ * Matrix by Multi-Vector Multiplication.
+ *
+ * Evaluates `m` on several vectors at once.
+ * The vectors are the columns of `vs` and the results are stored
+ * in the columns of `ret`, so the sizes of `ret`, `m` and `vs`
+ * must be (n, k), (n, l) and (l, k).
+ * Each element of `m` is read from memory once for up to 128 vectors,
+ * and once per block of 128 vectors beyond that.
+ * From `kMatrixEvalGemmVectors` vectors on,
+ * the product is computed with register-blocked GEMM kernels
+ * over cache-sized panels of `vs`.
+ */
+template <typename T>
+void MatrixEval(MatrixView<T> ret, const MatrixView<T>& m,
+                const MatrixView<T>& vs) {
+  detail::Dispatch([&] {
+    size_t k = vs.cols();
+    for (size_t i = 0; i < ret.rows(); ++i) {
+      std::fill(ret[i], ret[i] + k, T(0));
+    }
+    if (k < kMatrixEvalGemmVectors) {
+      for (size_t i = 0; i < m.rows(); ++i) {
+        T* r = ret[i];
+        for (size_t j = 0; j < m.cols(); ++j) {
+          T a = m[i][j];
+          const T* b = vs[j];
+          for (size_t c = 0; c < k; ++c) r[c] += a * b[c];
+        }
+      }
+      return;
+    }
+    // A KC x NC panel of `vs` (256 KiB of doubles) stays in L2,
+    // and each MR x KC micro-panel of `m` stays in L1 while it is
+    // multiplied by all the vectors of that panel.
+    constexpr size_t MR = 4, NR = 8, KC = 256, NC = 128;
+    for (size_t p = 0; p < m.cols(); p += KC) {
+      size_t kc = std::min(KC, m.cols() - p);
+      for (size_t jc = 0; jc < k; jc += NC) {
+        size_t jend = std::min(k, jc + NC);
+        for (size_t i = 0; i < m.rows(); i += MR) {
+          size_t mr = std::min(MR, m.rows() - i);
+          for (size_t j = jc; j < jend; j += NR) {
+            size_t nr = std::min(NR, jend - j);
+            detail::MatrixEvalMicro<MR, NR>(ret, m, vs, i, j, p, kc, mr,
+                                            nr);
+          }
+        }
+      }
+    }
+  });
+}
+
 /**
  * (Trivial) General Matrix Multiplication Routine.
  *
@@ -146,13 +506,150 @@ void MatrixEval(T* ret, const MatrixView<T>& m, const T* v) {
 template <typename T>
 void Gemm(MatrixView<T> ret, const MatrixView<T>& lhs,
           const MatrixView<T>& rhs) {
-  // Gustavson's ordering.
-  for (size_t i = 0; i < ret.rows(); ++i) {
-    for (size_t k = 0; k < lhs.cols(); ++k) {
+  detail::Dispatch([&] {
+    // Gustavson's ordering.
+    for (size_t i = 0; i < ret.rows(); ++i) {
+      for (size_t k = 0; k < lhs.cols(); ++k) {
+        for (size_t j = 0; j < ret.cols(); ++j) {
+          ret[i][j] += lhs[i][k] * rhs[k][j];
+        }
+      }
+    }
+  });
+}
+
+/**
+ * Operation applied to a GEMM operand.
+ */
+enum class Op {
+  kNoTrans,  ///< Use the matrix as is.
+  kTrans,    ///< Use the transpose of the matrix.
+};
+
+/**
+ * Storage layout of the GEMM operands.
+ */
+enum class Layout {
+  kRowMajor,  ///< Views describe the matrices.
+  kColMajor,  ///< Views describe the transposes (see `ColMajorView`).
+};
+
+/**
+ * Returns a view over a column-major matrix.
+ *
+ * Column-major storage of a (rows, cols) matrix with leading dimension `ld`
+ * is the row-major storage of its (cols, rows) transpose.
+ * The returned view describes that transpose.
+ */
+template <typename T>
+constexpr MatrixView<T> ColMajorView(T* data, size_t rows, size_t cols,
+                                     size_t ld) noexcept {
+  return MatrixView<T>(data, cols, rows, ld);
+}
+
+namespace detail {
+
+/**
+ * Scales a row by beta, following the BLAS convention
+ * that beta = 0 overwrites the row (even if it holds NaNs).
+ */
+template <typename T>
+void ScaleRow(T* row, size_t n, T beta) {
+  if (beta == T(1)) return;
+  if (beta == T(0)) {
+    std::fill(row, row + n, T(0));
+    return;
+  }
+  for (size_t j = 0; j < n; ++j) row[j] *= beta;
+}
+
+}  // namespace detail
+
+/**
+ * General Matrix Multiplication Routine (BLAS-like interface).
+ *
+ * Computes `ret := alpha * op(lhs) * op(rhs) + beta * ret`,
+ * where op(X) is X or its transpose as given by `opl` and `opr`.
+ * The sizes of `ret`, op(`lhs`) and op(`rhs`) must be (n, m), (n, l)
+ * and (l, m) for some numbers n, m and l.
+ * Transposed operands are read in their original layout;
+ * no transposed copy is made.
+ * The scaling by beta is fused with the accumulation,
+ * so `ret` is traversed only once.
+ */
+template <typename T>
+void Gemm(MatrixView<T> ret, Op opl, const MatrixView<T>& lhs, Op opr,
+          const MatrixView<T>& rhs, typename MatrixView<T>::value_type alpha,
+          typename MatrixView<T>::value_type beta) {
+  detail::Dispatch([&] {
+    size_t l = opl == Op::kNoTrans ? lhs.cols() : lhs.rows();
+    if (opr == Op::kNoTrans) {
+      // Rows of rhs are contiguous: Gustavson's ordering.
+      for (size_t i = 0; i < ret.rows(); ++i) {
+        T* c = ret[i];
+        detail::ScaleRow(c, ret.cols(), beta);
+        for (size_t k = 0; k < l; ++k) {
+          T a = alpha * (opl == Op::kNoTrans ? lhs[i][k] : lhs[k][i]);
+          const T* b = rhs[k];
+          for (size_t j = 0; j < ret.cols(); ++j) {
+            c[j] += a * b[j];
+          }
+        }
+      }
+    } else if (opl == Op::kNoTrans) {
+      // Rows of lhs and rhs are contiguous: dot products.
+      for (size_t i = 0; i < ret.rows(); ++i) {
+        T* c = ret[i];
+        const T* a = lhs[i];
+        for (size_t j = 0; j < ret.cols(); ++j) {
+          const T* b = rhs[j];
+          T sum = 0;
+          for (size_t k = 0; k < l; ++k) {
+            sum += a[k] * b[k];
+          }
+          c[j] = (beta == T(0) ? T(0) : beta * c[j]) + alpha * sum;
+        }
+      }
+    } else {
+      // ret = alpha * lhs^T rhs^T: build each column of ret contiguously
+      // from the rows of lhs and then scatter it.
+      detail::Workspace<T> col(ret.rows());
       for (size_t j = 0; j < ret.cols(); ++j) {
-        ret[i][j] += lhs[i][k] * rhs[k][j];
+        std::fill(col.begin(), col.end(), T(0));
+        const T* b = rhs[j];
+        for (size_t k = 0; k < l; ++k) {
+          T bk = b[k];
+          const T* a = lhs[k];
+          for (size_t i = 0; i < ret.rows(); ++i) {
+            col[i] += a[i] * bk;
+          }
+        }
+        for (size_t i = 0; i < ret.rows(); ++i) {
+          ret[i][j] = (beta == T(0) ? T(0) : beta * ret[i][j]) + alpha * col[i];
+        }
       }
     }
+  });
+}
+
+/**
+ * General Matrix Multiplication Routine (BLAS-like interface with layout).
+ *
+ * Same as the row-major version,
+ * but if `layout` is `Layout::kColMajor`,
+ * the views describe column-major matrices as returned by `ColMajorView`.
+ */
+template <typename T>
+void Gemm(Layout layout, MatrixView<T> ret, Op opl, const MatrixView<T>& lhs,
+          Op opr, const MatrixView<T>& rhs,
+          typename MatrixView<T>::value_type alpha,
+          typename MatrixView<T>::value_type beta) {
+  if (layout == Layout::kRowMajor) {
+    Gemm(ret, opl, lhs, opr, rhs, alpha, beta);
+  } else {
+    // The views hold ret^T, lhs^T and rhs^T,
+    // and ret^T = op(rhs)^T op(lhs)^T.
+    Gemm(ret, opr, rhs, opl, lhs, alpha, beta);
   }
 }
 
@@ -239,6 +736,451 @@ void Multiply_Lu(T* ret, const MatrixView<T>& l, const MatrixView<T>& u) {
   // TODO(exercise): Implement this for assignment 1.
 }
 
+namespace detail {
+
+/**
+ * Tile Kernels.
+ *
+ * Serial building blocks of the tiled factorizations.
+ * They are named after their LAPACK/BLAS counterparts
+ * and work in place on the tiles given as views.
+ */
+
+/**
+ * Unpivoted LU factorization of a tile (GETRF).
+ *
+ * Same result and storage as `LuFact`.
+ */
+template <typename T>
+void TileGetrf(MatrixView<T> a) {
+  size_t n = std::min(a.rows(), a.cols());
+  for (size_t k = 0; k < n; ++k) {
+    T pivot = a[k][k];
+    for (size_t i = k + 1; i < a.rows(); ++i) {
+      T lik = a[i][k] /= pivot;
+      for (size_t j = k + 1; j < a.cols(); ++j) {
+        a[i][j] -= lik * a[k][j];
+      }
+    }
+  }
+}
+
+/**
+ * Triangular solve B := L^-1 B (TRSM, left, lower, unit diagonal).
+ *
+ * Only the strictly lower part of `l` is accessed.
+ */
+template <typename T>
+void TileTrsmLowerUnit(const MatrixView<T>& l, MatrixView<T> b) {
+  for (size_t k = 0; k < b.rows(); ++k) {
+    for (size_t i = k + 1; i < b.rows(); ++i) {
+      T lik = l[i][k];
+      for (size_t j = 0; j < b.cols(); ++j) {
+        b[i][j] -= lik * b[k][j];
+      }
+    }
+  }
+}
+
+/**
+ * Triangular solve B := B U^-1 (TRSM, right, upper, non-unit diagonal).
+ *
+ * Only the diagonal and the upper part of `u` are accessed.
+ */
+template <typename T>
+void TileTrsmUpperRight(const MatrixView<T>& u, MatrixView<T> b) {
+  for (size_t i = 0; i < b.rows(); ++i) {
+    for (size_t k = 0; k < b.cols(); ++k) {
+      T bik = b[i][k] /= u[k][k];
+      for (size_t j = k + 1; j < b.cols(); ++j) {
+        b[i][j] -= bik * u[k][j];
+      }
+    }
+  }
+}
+
+/**
+ * Trailing update C := C - A B (GEMM).
+ */
+template <typename T>
+void TileGemmSub(MatrixView<T> c, const MatrixView<T>& a,
+                 const MatrixView<T>& b) {
+  Gemm(c, Op::kNoTrans, a, Op::kNoTrans, b, T(-1), T(1));
+}
+
+/**
+ * Cholesky factorization of a tile (POTRF, lower).
+ *
+ * Overwrites the lower part of `a` with L such that A = L L^T.
+ * The strictly upper part is not accessed.
+ */
+template <typename T>
+void TilePotrf(MatrixView<T> a) {
+  using std::sqrt;
+  for (size_t k = 0; k < a.rows(); ++k) {
+    T akk = a[k][k] = sqrt(a[k][k]);
+    for (size_t i = k + 1; i < a.rows(); ++i) a[i][k] /= akk;
+    for (size_t j = k + 1; j < a.rows(); ++j) {
+      T ljk = a[j][k];
+      for (size_t i = j; i < a.rows(); ++i) {
+        a[i][j] -= a[i][k] * ljk;
+      }
+    }
+  }
+}
+
+/**
+ * Triangular solve B := B L^-T (TRSM, right, lower, transposed).
+ *
+ * Only the diagonal and the lower part of `l` are accessed.
+ */
+template <typename T>
+void TileTrsmLowerTransRight(const MatrixView<T>& l, MatrixView<T> b) {
+  for (size_t i = 0; i < b.rows(); ++i) {
+    for (size_t k = 0; k < b.cols(); ++k) {
+      T bik = b[i][k];
+      for (size_t j = 0; j < k; ++j) bik -= b[i][j] * l[k][j];
+      b[i][k] = bik / l[k][k];
+    }
+  }
+}
+
+/**
+ * Symmetric rank-k update C := C - A A^T (SYRK, lower).
+ *
+ * Only the diagonal and the lower part of `c` are updated.
+ */
+template <typename T>
+void TileSyrkSub(MatrixView<T> c, const MatrixView<T>& a) {
+  for (size_t i = 0; i < c.rows(); ++i) {
+    for (size_t j = 0; j <= i; ++j) {
+      T sum = 0;
+      for (size_t k = 0; k < a.cols(); ++k) sum += a[i][k] * a[j][k];
+      c[i][j] -= sum;
+    }
+  }
+}
+
+/**
+ * Trailing update C := C - A B^T (GEMM with transposed right operand).
+ */
+template <typename T>
+void TileGemmSubTrans(MatrixView<T> c, const MatrixView<T>& a,
+                      const MatrixView<T>& b) {
+  Gemm(c, Op::kNoTrans, a, Op::kTrans, b, T(-1), T(1));
+}
+
+/**
+ * Copies the transpose of `a` into `buf` and returns a view of it.
+ */
+template <typename T>
+MatrixView<T> TransposeInto(Workspace<T>& buf, const MatrixView<T>& a) {
+  buf.resize(a.rows() * a.cols());
+  MatrixView<T> at(buf.data(), a.cols(), a.rows(), a.rows());
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < a.cols(); ++j) at[j][i] = a[i][j];
+  }
+  return at;
+}
+
+/**
+ * Trailing update of one block column in a right-looking Cholesky step.
+ *
+ * `trail` is the trailing matrix, `panel` the solved panel to its left
+ * and `panelT` its transpose.
+ * Updates columns [j, j + jb) of `trail` from the diagonal down:
+ * SYRK on the diagonal block and GEMM below it.
+ * The GEMM reads the transposed panel so it runs the row-streaming kernel
+ * instead of dot products.
+ */
+template <typename T>
+void CholeskyUpdate(MatrixView<T> trail, const MatrixView<T>& panel,
+                    const MatrixView<T>& panelT, size_t j, size_t jb) {
+  size_t n = trail.rows(), kb = panel.cols();
+  TileSyrkSub(trail.view(j, j, jb, jb), panel.view(j, 0, jb, kb));
+  if (j + jb < n) {
+    Gemm(trail.view(j + jb, j, n - j - jb, jb), Op::kNoTrans,
+         panel.view(j + jb, 0, n - j - jb, kb), Op::kNoTrans,
+         panelT.view(0, j, kb, jb), T(-1), T(1));
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Solves a matricial equation Lx = b
+ * given by a lower triangular matrix L.
+ * The elements above the diagonal are not accessed.
+ * `x` and `b` may be the same vector.
+ */
+template <typename T>
+void SolveLower(T* x, const MatrixView<T>& l, const T* b) {
+  for (size_t i = 0; i < l.rows(); ++i) {
+    T sum = b[i];
+    for (size_t k = 0; k < i; ++k) sum -= l[i][k] * x[k];
+    x[i] = sum / l[i][i];
+  }
+}
+
+/**
+ * Solves a matricial equation L^T x = b
+ * given by a lower triangular matrix L.
+ * The elements above the diagonal are not accessed.
+ * `x` and `b` may be the same vector.
+ */
+template <typename T>
+void SolveLowerTrans(T* x, const MatrixView<T>& l, const T* b) {
+  size_t n = l.rows();
+  if (x != b) std::copy(b, b + n, x);
+  // Column i of L^T is row i of L, so L is read by rows.
+  for (size_t i = n; i-- > 0;) {
+    T xi = x[i] /= l[i][i];
+    for (size_t k = 0; k < i; ++k) x[k] -= l[i][k] * xi;
+  }
+}
+
+/**
+ * Cholesky Factorization Routine.
+ *
+ * Receives a symmetric positive definite matrix
+ * and overwrites its lower half, diagonal included,
+ * with the lower triangular matrix L such that A = L L^T.
+ * The strictly upper half is not accessed.
+ */
+template <typename T>
+void Cholesky(MatrixView<T> m) {
+  detail::TilePotrf(m);
+}
+
+/**
+ * Cholesky Factorization Routine (block decomposition).
+ *
+ * Same result and requirements as `Cholesky`.
+ * Right-looking: each step factors a `bs` wide diagonal block,
+ * solves the panel below it and updates the trailing matrix
+ * with SYRK on the diagonal blocks and GEMM below them.
+ */
+template <typename T>
+void Cholesky_b(MatrixView<T> m, size_t bs) {
+  size_t n = m.rows();
+  detail::Workspace<T> buf;
+  for (size_t k = 0; k < n; k += bs) {
+    size_t kb = std::min(bs, n - k), rest = n - k - kb;
+    auto akk = m.view(k, k, kb, kb);
+    detail::TilePotrf(akk);
+    if (rest == 0) break;
+    auto panel = m.view(k + kb, k, rest, kb);
+    detail::TileTrsmLowerTransRight(akk, panel);
+    auto panelT = detail::TransposeInto(buf, panel);
+    auto trail = m.view(k + kb, k + kb, rest, rest);
+    for (size_t j = 0; j < rest; j += bs) {
+      detail::CholeskyUpdate(trail, panel, panelT, j, std::min(bs, rest - j));
+    }
+  }
+}
+
+/**
+ * Solves a matricial equation Ax = b given the Cholesky factor L of A,
+ * as computed by `Cholesky`, by solving Ly = b and L^T x = y.
+ * `x` and `b` may be the same vector.
+ */
+template <typename T>
+void CholeskySolve(T* x, const MatrixView<T>& l, const T* b) {
+  SolveLower(x, l, b);
+  SolveLowerTrans(x, l, x);
+}
+
+namespace detail {
+
+/**
+ * Householder QR of a panel (GEQR2).
+ *
+ * Overwrites `a` with R on and above the diagonal
+ * and the reflector vectors v_k below it (v_k[k] = 1 is implicit),
+ * so that A = H_0 H_1 ... with H_k = I - tau_k v_k v_k^T.
+ * `w` is scratch space of `a.cols()` elements.
+ */
+template <typename T>
+void QrPanel(MatrixView<T> a, T* tau, T* w) {
+  using std::sqrt;
+  size_t r = a.rows(), c = a.cols();
+  for (size_t k = 0; k < std::min(r, c); ++k) {
+    T alpha = a[k][k], norm2 = 0;
+    for (size_t i = k + 1; i < r; ++i) norm2 += a[i][k] * a[i][k];
+    if (norm2 == T(0)) {
+      tau[k] = 0;
+      continue;
+    }
+    T beta = sqrt(alpha * alpha + norm2);
+    if (alpha > T(0)) beta = -beta;
+    tau[k] = (beta - alpha) / beta;
+    T scale = T(1) / (alpha - beta);
+    for (size_t i = k + 1; i < r; ++i) a[i][k] *= scale;
+    a[k][k] = beta;
+    // A := H_k A on the columns to the right, streaming rows:
+    // w = v^T A, then A -= tau v w.
+    size_t nc = c - k - 1;
+    std::copy(a[k] + k + 1, a[k] + c, w);
+    for (size_t i = k + 1; i < r; ++i) {
+      T vi = a[i][k];
+      const T* ai = a[i] + k + 1;
+      for (size_t j = 0; j < nc; ++j) w[j] += vi * ai[j];
+    }
+    T t = tau[k];
+    for (size_t j = 0; j < nc; ++j) a[k][k + 1 + j] -= t * w[j];
+    for (size_t i = k + 1; i < r; ++i) {
+      T tvi = t * a[i][k];
+      T* ai = a[i] + k + 1;
+      for (size_t j = 0; j < nc; ++j) ai[j] -= tvi * w[j];
+    }
+  }
+}
+
+/**
+ * Copies the reflectors of a factored panel into `v`
+ * as an explicit unit lower trapezoidal matrix.
+ */
+template <typename T>
+void QrReflectors(const MatrixView<T>& panel, MatrixView<T> v) {
+  for (size_t i = 0; i < panel.rows(); ++i) {
+    for (size_t j = 0; j < panel.cols(); ++j) {
+      v[i][j] = i > j ? panel[i][j] : T(i == j);
+    }
+  }
+}
+
+/**
+ * Builds the upper triangular factor T of the compact WY form
+ * H_0 H_1 ... H_{k-1} = I - V T V^T (LARFT, forward, columnwise).
+ */
+template <typename T>
+void QrTriangularFactor(const MatrixView<T>& v, const T* tau,
+                        MatrixView<T> t) {
+  size_t k = v.cols();
+  for (size_t i = 0; i < k; ++i) {
+    // z = V(:, 0:i)^T v_i, with v_i zero above row i.
+    // Row i of T is not in use yet, so it holds z meanwhile.
+    T* z = t[i];
+    std::fill(z, z + k, T(0));
+    for (size_t l = i; l < v.rows(); ++l) {
+      T vli = v[l][i];
+      for (size_t j = 0; j < i; ++j) z[j] += v[l][j] * vli;
+    }
+    // T(0:i, i) = -tau_i T(0:i, 0:i) z.
+    for (size_t j = 0; j < i; ++j) {
+      T sum = 0;
+      for (size_t l = j; l < i; ++l) sum += t[j][l] * z[l];
+      t[j][i] = -tau[i] * sum;
+    }
+    std::fill(z, z + k, T(0));
+    t[i][i] = tau[i];
+  }
+}
+
+/**
+ * Applies a block reflector from the left: C := (I - V T V^T)^T C.
+ *
+ * Three GEMMs per column strip of C: W = V^T C, W := T^T W and C -= V W.
+ * Strips are sized for C to stay in cache across the first and last GEMM.
+ * `w` must hold 2 * `v.cols()` * `c.cols()` elements.
+ */
+template <typename T>
+void QrApplyBlockTrans(const MatrixView<T>& v, const MatrixView<T>& t,
+                       MatrixView<T> c, T* w) {
+  constexpr size_t kStripBytes = size_t(1) << 18;
+  size_t k = v.cols(), n = c.cols();
+  size_t strip = std::max<size_t>(16, kStripBytes / sizeof(T) / c.rows());
+  for (size_t j = 0; j < n; j += strip) {
+    size_t nj = std::min(strip, n - j);
+    MatrixView<T> w0(w, k, nj, nj), w1(w + k * nj, k, nj, nj);
+    auto cj = c.view(0, j, c.rows(), nj);
+    Gemm(w0, Op::kTrans, v, Op::kNoTrans, cj, T(1), T(0));
+    Gemm(w1, Op::kTrans, t, Op::kNoTrans, w0, T(1), T(0));
+    Gemm(cj, Op::kNoTrans, v, Op::kNoTrans, w1, T(-1), T(1));
+  }
+}
+
+/**
+ * Computes b := Q^T b for the reflectors stored in `qr` and `tau`.
+ */
+template <typename T>
+void QrApplyTrans(const MatrixView<T>& qr, const T* tau, T* b) {
+  for (size_t k = 0; k < std::min(qr.rows(), qr.cols()); ++k) {
+    T s = b[k];
+    for (size_t i = k + 1; i < qr.rows(); ++i) s += qr[i][k] * b[i];
+    s *= tau[k];
+    b[k] -= s;
+    for (size_t i = k + 1; i < qr.rows(); ++i) b[i] -= s * qr[i][k];
+  }
+}
+
+/**
+ * Solves Rx = y for the upper triangle R of `r`.
+ */
+template <typename T>
+void QrBackSubstitute(T* x, const MatrixView<T>& r, const T* y) {
+  for (size_t i = r.cols(); i-- > 0;) {
+    T sum = y[i];
+    for (size_t j = i + 1; j < r.cols(); ++j) sum -= r[i][j] * x[j];
+    x[i] = sum / r[i][i];
+  }
+}
+
+}  // namespace detail
+
+/**
+ * QR Factorization Routine (Householder).
+ *
+ * Computes A = QR and overwrites `m` with R on and above the diagonal
+ * and the Householder vectors of Q below it, as LAPACK's GEQRF does.
+ * `tau` receives the min(rows, cols) reflector scalars.
+ */
+template <typename T>
+void QrFact(MatrixView<T> m, T* tau) {
+  static_assert(std::is_floating_point_v<T>, "QR needs a floating point type");
+  detail::Workspace<T> w(m.cols());
+  detail::QrPanel(m, tau, w.data());
+}
+
+/**
+ * QR Factorization Routine (block decomposition).
+ *
+ * Same result and storage as `QrFact`.
+ * Each `bs` wide panel is factored with `QrFact`
+ * and applied to the trailing columns in compact WY form,
+ * I - V T V^T, so most of the work is GEMM.
+ */
+template <typename T>
+void QrFact_b(MatrixView<T> m, T* tau, size_t bs) {
+  static_assert(std::is_floating_point_v<T>, "QR needs a floating point type");
+  size_t r = m.rows(), c = m.cols(), kmax = std::min(r, c);
+  detail::Workspace<T> work(std::max(c, r * bs + bs * bs + 2 * bs * c));
+  for (size_t k = 0; k < kmax; k += bs) {
+    size_t kb = std::min(bs, kmax - k), rest = c - k - kb;
+    auto panel = m.view(k, k, r - k, kb);
+    detail::QrPanel(panel, tau + k, work.data());
+    if (rest == 0) continue;
+    MatrixView<T> v(work.data(), r - k, kb, kb);
+    MatrixView<T> t(v.data() + (r - k) * kb, kb, kb, kb);
+    detail::QrReflectors(panel, v);
+    detail::QrTriangularFactor(v, tau + k, t);
+    detail::QrApplyBlockTrans(v, t, m.view(k, k + kb, r - k, rest),
+                              t.data() + kb * kb);
+  }
+}
+
+/**
+ * Solves the least squares problem min ||Ax - b||
+ * given the factorization of A (rows >= cols, full rank) by `QrFact`.
+ * `x` receives cols elements; `b` has rows elements.
+ */
+template <typename T>
+void QrSolve(T* x, const MatrixView<T>& qr, const T* tau, const T* b) {
+  detail::Workspace<T> y(b, b + qr.rows());
+  detail::QrApplyTrans(qr, tau, y.data());
+  detail::QrBackSubstitute(x, qr.view(0, 0, qr.cols(), qr.cols()), y.data());
+}
+
 }  // namespace tutor
 
 #endif  // HPC_TUTOR_LINALG_HPP_
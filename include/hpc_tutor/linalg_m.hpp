@@ -0,0 +1,710 @@
+#ifndef HPC_TUTOR_LINALG_M_HPP_
+#define HPC_TUTOR_LINALG_M_HPP_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "linalg.hpp"
+#include "linalg_t.hpp"
+#include "matrix_view.hpp"
+#include "memory.hpp"
+
+namespace tutor {
+
+namespace detail {
+
+/**
+ * Returns the MPI datatype of `T`.
+ */
+template <typename T>
+MPI_Datatype MpiType() {
+  if constexpr (std::is_same_v<T, float>) {
+    return MPI_FLOAT;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return MPI_DOUBLE;
+  } else if constexpr (std::is_same_v<T, long double>) {
+    return MPI_LONG_DOUBLE;
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    if constexpr (sizeof(T) == 1) return MPI_INT8_T;
+    if constexpr (sizeof(T) == 2) return MPI_INT16_T;
+    if constexpr (sizeof(T) == 4) return MPI_INT32_T;
+    if constexpr (sizeof(T) == 8) return MPI_INT64_T;
+  } else if constexpr (std::is_integral_v<T>) {
+    if constexpr (sizeof(T) == 1) return MPI_UINT8_T;
+    if constexpr (sizeof(T) == 2) return MPI_UINT16_T;
+    if constexpr (sizeof(T) == 4) return MPI_UINT32_T;
+    if constexpr (sizeof(T) == 8) return MPI_UINT64_T;
+  } else {
+    static_assert(!sizeof(T), "no MPI datatype for this type");
+  }
+}
+
+/**
+ * Reproducible sum of `value(i)` for i in [0, n) over all the processes
+ * of `comm`, where each process holds its own n addends.
+ *
+ * The result is the same on every process, and it is bitwise identical
+ * to the serial `ReproducibleReduce` of all the addends,
+ * for any number of processes and any distribution of the addends.
+ */
+template <typename F>
+double ReproducibleReduce_cm(size_t n, F value, MPI_Comm comm) {
+  double maxAbs = MaxAbs(0, n, value);
+  uint64_t total = n;
+  MPI_Allreduce(MPI_IN_PLACE, &maxAbs, 1, MPI_DOUBLE, MPI_MAX, comm);
+  MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_UINT64_T, MPI_SUM, comm);
+  ReproducibleSum sum(maxAbs, total);
+  sum.Add(0, n, value);
+  // Partial sums are exact, so the reduction order does not matter.
+  MPI_Allreduce(MPI_IN_PLACE, sum.folds(), ReproducibleSum::kFolds,
+                MPI_DOUBLE, MPI_SUM, comm);
+  return sum.Result();
+}
+
+/**
+ * MPI datatype of `count` contiguous bytes, freed with the object.
+ * Used to move arbitrary trivially copyable types.
+ */
+class MpiBytes {
+ public:
+  explicit MpiBytes(size_t count) {
+    MPI_Type_contiguous(static_cast<int>(count), MPI_BYTE, &type_);
+    MPI_Type_commit(&type_);
+  }
+
+  MpiBytes(const MpiBytes&) = delete;
+  MpiBytes& operator=(const MpiBytes&) = delete;
+
+  ~MpiBytes() { MPI_Type_free(&type_); }
+
+  operator MPI_Datatype() const noexcept { return type_; }
+
+ private:
+  MPI_Datatype type_;
+};
+
+/**
+ * Key of the sample sort, made unique by the rank that holds it
+ * and its position there, so duplicated keys can be split evenly.
+ */
+template <typename T>
+struct SortSample {
+  T key;
+  uint64_t rank;
+  uint64_t pos;
+
+  bool operator<(const SortSample& o) const {
+    if (key < o.key) return true;
+    if (o.key < key) return false;
+    return rank < o.rank || (rank == o.rank && pos < o.pos);
+  }
+};
+
+}  // namespace detail
+
+/**
+ * Load Balance of a Distributed Sort.
+ */
+struct SortBalance {
+  size_t minKeys = 0;     ///< Fewest keys received by a process.
+  size_t maxKeys = 0;     ///< Most keys received by a process.
+  size_t totalKeys = 0;   ///< Keys over all the processes.
+  double imbalance = 1;   ///< maxKeys over the average, 1 is perfect.
+};
+
+/**
+ * Vector Sort (with collective message passing).
+ *
+ * Sorts the keys held by all the processes of `comm`
+ * (`n` on this process) by parallel sorting by regular sampling.
+ * Each process sorts its keys with `MergeSort` and picks regular samples,
+ * about p per average share of keys;
+ * the gathered samples select one splitter per process boundary;
+ * keys are exchanged with `MPI_Alltoallv`
+ * and every process merges the sorted pieces it receives.
+ *
+ * Returns the keys of this process after the sort:
+ * they are sorted, and all of them are not greater
+ * than the keys of the next rank.
+ * Samples are compared by (key, rank, position),
+ * so runs of equal keys are split among processes like distinct keys
+ * and no process receives more than about twice the average.
+ * `balance`, if given, receives the load of the processes.
+ */
+template <typename T>
+std::vector<T> MergeSort_cm(const T* v, size_t n,
+                            MPI_Comm comm = MPI_COMM_WORLD,
+                            SortBalance* balance = nullptr) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "MergeSort_cm needs trivially copyable keys");
+  using Sample = detail::SortSample<T>;
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  size_t p = size;
+
+  std::vector<T> local(v, v + n);
+  MergeSort(local.data(), n);
+
+  // About p regular samples per process share of keys,
+  // so processes with more keys contribute more samples.
+  uint64_t offset = 0, total = n;
+  MPI_Exscan(&total, &offset, 1, MPI_UINT64_T, MPI_SUM, comm);
+  if (rank == 0) offset = 0;
+  MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_UINT64_T, MPI_SUM, comm);
+  size_t stride = std::max<size_t>(1, total / (p * p));
+  std::vector<Sample> samples;
+  for (size_t pos = (stride - offset % stride) % stride; pos < n;
+       pos += stride) {
+    samples.push_back(Sample{local[pos], uint64_t(rank), pos});
+  }
+  int count = static_cast<int>(samples.size());
+  std::vector<int> counts(p), displs(p);
+  MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+  for (size_t r = 1; r < p; ++r) displs[r] = displs[r - 1] + counts[r - 1];
+  std::vector<Sample> all(displs[p - 1] + counts[p - 1]);
+  detail::MpiBytes sampleType(sizeof(Sample));
+  MPI_Allgatherv(samples.data(), count, sampleType, all.data(), counts.data(),
+                 displs.data(), sampleType, comm);
+  std::sort(all.begin(), all.end());
+
+  // Keys before splitter d go to processes up to d.
+  std::vector<int> sendCounts(p), sendDispls(p);
+  size_t begin = 0;
+  for (size_t d = 0; d < p; ++d) {
+    size_t end = n;
+    if (d + 1 < p && !all.empty()) {
+      const Sample& splitter = all[(d + 1) * all.size() / p];
+      // Local keys are sorted, and so are their (key, rank, pos) samples.
+      size_t lo = begin, hi = n;
+      while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (Sample{local[mid], uint64_t(rank), mid} < splitter) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      end = lo;
+    }
+    sendDispls[d] = static_cast<int>(begin);
+    sendCounts[d] = static_cast<int>(end - begin);
+    begin = end;
+  }
+
+  std::vector<int> recvCounts(p), recvDispls(p);
+  MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT,
+               comm);
+  for (size_t r = 1; r < p; ++r) {
+    recvDispls[r] = recvDispls[r - 1] + recvCounts[r - 1];
+  }
+  size_t received = recvDispls[p - 1] + recvCounts[p - 1];
+  std::vector<T> pieces(received);
+  detail::MpiBytes keyType(sizeof(T));
+  MPI_Alltoallv(local.data(), sendCounts.data(), sendDispls.data(), keyType,
+                pieces.data(), recvCounts.data(), recvDispls.data(), keyType,
+                comm);
+
+  // K-way merge of the sorted pieces; ties go to the lower rank.
+  std::vector<T> result;
+  result.reserve(received);
+  detail::LoserTree<T> tree(p);
+  std::vector<size_t> next(p);
+  for (size_t r = 0; r < p; ++r) {
+    next[r] = recvDispls[r];
+    if (recvCounts[r] > 0) tree.Set(r, pieces[next[r]]);
+  }
+  tree.Build();
+  while (tree.live()) {
+    size_t r = tree.winner();
+    result.push_back(tree.key(r));
+    if (++next[r] < size_t(recvDispls[r]) + recvCounts[r]) {
+      tree.Set(r, pieces[next[r]]);
+    } else {
+      tree.Close(r);
+    }
+    tree.Replay(r);
+  }
+
+  if (balance != nullptr) {
+    uint64_t keys[3] = {received, received, received};
+    MPI_Allreduce(MPI_IN_PLACE, &keys[0], 1, MPI_UINT64_T, MPI_MIN, comm);
+    MPI_Allreduce(MPI_IN_PLACE, &keys[1], 1, MPI_UINT64_T, MPI_MAX, comm);
+    MPI_Allreduce(MPI_IN_PLACE, &keys[2], 1, MPI_UINT64_T, MPI_SUM, comm);
+    balance->minKeys = keys[0];
+    balance->maxKeys = keys[1];
+    balance->totalKeys = keys[2];
+    balance->imbalance =
+        keys[2] == 0 ? 1 : static_cast<double>(keys[1]) * p / keys[2];
+  }
+  return result;
+}
+
+/**
+ * Accumulation (with collective message passing).
+ *
+ * Each process passes its part of the vector
+ * and every process receives the total.
+ */
+template <typename T>
+T Accumulate_cm(const T* data, size_t n, MPI_Comm comm = MPI_COMM_WORLD) {
+  T sum = Accumulate(data, n);
+  MPI_Allreduce(MPI_IN_PLACE, &sum, 1, detail::MpiType<T>(), MPI_SUM, comm);
+  return sum;
+}
+
+/**
+ * Vector Inner Product (with collective message passing).
+ *
+ * Each process passes its part of both vectors
+ * and every process receives the total.
+ */
+template <typename T>
+T Inner_cm(const T* lhs, const T* rhs, size_t n,
+           MPI_Comm comm = MPI_COMM_WORLD) {
+  T sum = Inner(lhs, rhs, n);
+  MPI_Allreduce(MPI_IN_PLACE, &sum, 1, detail::MpiType<T>(), MPI_SUM, comm);
+  return sum;
+}
+
+/**
+ * Accumulation (reproducible, with collective message passing).
+ *
+ * Bitwise identical to `Accumulate_r` over the concatenation
+ * of the parts, for any number of processes.
+ */
+template <typename T>
+T Accumulate_rcm(const T* data, size_t n, MPI_Comm comm = MPI_COMM_WORLD) {
+  if constexpr (std::is_integral_v<T>) {
+    return Accumulate_cm(data, n, comm);
+  } else {
+    return static_cast<T>(detail::ReproducibleReduce_cm(
+        n, [data](size_t i) { return static_cast<double>(data[i]); }, comm));
+  }
+}
+
+/**
+ * Vector Inner Product (reproducible, with collective message passing).
+ *
+ * Bitwise identical to `Inner_r` over the concatenation
+ * of the parts, for any number of processes.
+ */
+template <typename T>
+T Inner_rcm(const T* lhs, const T* rhs, size_t n,
+            MPI_Comm comm = MPI_COMM_WORLD) {
+  if constexpr (std::is_integral_v<T>) {
+    return Inner_cm(lhs, rhs, n, comm);
+  } else {
+    return static_cast<T>(detail::ReproducibleReduce_cm(
+        n,
+        [lhs, rhs](size_t i) {
+          return static_cast<double>(lhs[i]) * static_cast<double>(rhs[i]);
+        },
+        comm));
+  }
+}
+
+/**
+ * Distribution of the Rows of a Matrix among Processes.
+ *
+ * Process r owns a contiguous block of rows,
+ * after the blocks of the processes before it.
+ * Building it is collective; keep it to reuse it in repeated calls.
+ */
+class RowBlocks {
+ public:
+  /**
+   * Collects the number of rows owned by each process of `comm`.
+   */
+  explicit RowBlocks(size_t localRows, MPI_Comm comm = MPI_COMM_WORLD)
+      : comm_(comm) {
+    int size;
+    MPI_Comm_rank(comm, &rank_);
+    MPI_Comm_size(comm, &size);
+    int mine = static_cast<int>(localRows);
+    counts_.resize(size);
+    displs_.resize(size);
+    MPI_Allgather(&mine, 1, MPI_INT, counts_.data(), 1, MPI_INT, comm);
+    for (int r = 1; r < size; ++r) displs_[r] = displs_[r - 1] + counts_[r - 1];
+    offset_ = displs_[rank_];
+    rows_ = displs_[size - 1] + counts_[size - 1];
+  }
+
+  /**
+   * Splits `rows` rows evenly among the processes of `comm`.
+   */
+  static RowBlocks Even(size_t rows, MPI_Comm comm = MPI_COMM_WORLD) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    return RowBlocks(rows * (rank + 1) / size - rows * rank / size, comm);
+  }
+
+  /**
+   * Returns the first row owned by this process.
+   */
+  [[nodiscard]] size_t offset() const noexcept { return offset_; }
+
+  /**
+   * Returns the number of rows owned by this process.
+   */
+  [[nodiscard]] size_t localRows() const noexcept { return counts_[rank_]; }
+
+  /**
+   * Returns the total number of rows.
+   */
+  [[nodiscard]] size_t rows() const noexcept { return rows_; }
+
+  [[nodiscard]] const int* counts() const noexcept { return counts_.data(); }
+  [[nodiscard]] const int* displs() const noexcept { return displs_.data(); }
+  [[nodiscard]] MPI_Comm comm() const noexcept { return comm_; }
+
+ private:
+  MPI_Comm comm_;
+  int rank_;
+  std::vector<int> counts_;
+  std::vector<int> displs_;
+  size_t offset_;
+  size_t rows_;
+};
+
+/**
+ * Pending Nonblocking Operation.
+ *
+ * The destructor waits for the operation if it is still pending.
+ */
+class MpiRequest {
+ public:
+  MpiRequest() = default;
+
+  explicit MpiRequest(MPI_Request request) : request_(request) {}
+
+  MpiRequest(MpiRequest&& other) noexcept : request_(other.request_) {
+    other.request_ = MPI_REQUEST_NULL;
+  }
+
+  MpiRequest& operator=(MpiRequest&& other) noexcept {
+    std::swap(request_, other.request_);
+    return *this;
+  }
+
+  ~MpiRequest() { wait(); }
+
+  /**
+   * Checks if the operation has finished.
+   */
+  [[nodiscard]] bool ready() {
+    int flag = 1;
+    if (request_ != MPI_REQUEST_NULL) {
+      MPI_Test(&request_, &flag, MPI_STATUS_IGNORE);
+    }
+    return flag != 0;
+  }
+
+  /**
+   * Waits for the operation to finish.
+   */
+  void wait() {
+    if (request_ != MPI_REQUEST_NULL) MPI_Wait(&request_, MPI_STATUS_IGNORE);
+  }
+
+ private:
+  MPI_Request request_ = MPI_REQUEST_NULL;
+};
+
+/**
+ * Matrix by Vector Multiplication (with collective message passing).
+ *
+ * `m` is the block of rows of this process, as described by `blocks`,
+ * and `v` the whole vector.
+ * Each process computes its rows of the result with `MatrixEval_t`
+ * and `MPI_Allgatherv` assembles the whole result in `ret` on every process,
+ * ready to be the input vector of the next product.
+ */
+template <typename T>
+void MatrixEval_cm(T* ret, const MatrixView<T>& m, const T* v,
+                   const RowBlocks& blocks) {
+  MatrixEval_t(ret + blocks.offset(), m, v);
+  MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, ret, blocks.counts(),
+                 blocks.displs(), detail::MpiType<T>(), blocks.comm());
+}
+
+/**
+ * Matrix by Vector Multiplication (with asynchronous message passing).
+ *
+ * Same as `MatrixEval_cm`, but the result is assembled
+ * with a nonblocking `MPI_Iallgatherv`.
+ * The rows of this process are in `ret` on return;
+ * the rest are there once the returned request completes.
+ * The caller can compute meanwhile, e.g., the next product
+ * of an independent sequence, as in:
+ *
+ *     auto rx = MatrixEval_am(y, a, x, blocks);
+ *     auto rz = MatrixEval_am(w, a, z, blocks);  // Overlaps gather of y.
+ *     rx.wait();
+ *     ...
+ *
+ * `ret` must not be accessed by other calls until the request completes.
+ * Products that depend on the previous one use the overload below.
+ */
+template <typename T>
+[[nodiscard]] MpiRequest MatrixEval_am(T* ret, const MatrixView<T>& m,
+                                       const T* v, const RowBlocks& blocks) {
+  MatrixEval_t(ret + blocks.offset(), m, v);
+  MPI_Request request;
+  MPI_Iallgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, ret, blocks.counts(),
+                  blocks.displs(), detail::MpiType<T>(), blocks.comm(),
+                  &request);
+  return MpiRequest(request);
+}
+
+/**
+ * Matrix by Vector Multiplication (with asynchronous message passing,
+ * on a vector still being gathered).
+ *
+ * Same as above for a square matrix, but `v` is the result
+ * of an earlier `MatrixEval_am` and `pending` its request,
+ * so that the iteration x_{k+1} = A x_k overlaps communication:
+ *
+ *     MpiRequest r;
+ *     for (...) {
+ *       r = MatrixEval_am(y, a, x, r, blocks);  // Overlaps gather of x.
+ *       std::swap(x, y);
+ *     }
+ *     r.wait();
+ *
+ * The rows of `v` owned by this process are ready before the gather
+ * completes, so their columns of `m` are multiplied while it is
+ * in flight; the other columns are added once `pending` completes.
+ * The sums are in a different order than in `MatrixEval_cm`.
+ */
+template <typename T>
+[[nodiscard]] MpiRequest MatrixEval_am(T* ret, const MatrixView<T>& m,
+                                       const T* v, MpiRequest& pending,
+                                       const RowBlocks& blocks) {
+  size_t rows = m.rows(), lo = blocks.offset(), hi = lo + rows;
+  T* mine = ret + lo;
+  MatrixEval_t(mine, m.view(0, lo, rows, hi - lo), v + lo);
+  pending.wait();
+  detail::Workspace<T> part(rows);
+  for (auto [c0, c1] : {std::pair(size_t(0), lo), std::pair(hi, m.cols())}) {
+    if (c0 == c1) continue;
+    MatrixEval_t(part.data(), m.view(0, c0, rows, c1 - c0), v + c0);
+    for (size_t i = 0; i < rows; ++i) mine[i] += part[i];
+  }
+  MPI_Request request;
+  MPI_Iallgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, ret, blocks.counts(),
+                  blocks.displs(), detail::MpiType<T>(), blocks.comm(),
+                  &request);
+  return MpiRequest(request);
+}
+
+/**
+ * Time Spent by a Distributed Matrix Multiplication.
+ */
+struct GemmStats {
+  double computeSeconds = 0;  ///< Local block products.
+  double commSeconds = 0;     ///< Blocked in communication, skew included.
+  double totalSeconds = 0;
+};
+
+namespace detail {
+
+/**
+ * Process grid and contiguous copies of the local blocks for Cannon.
+ */
+template <typename T>
+class CannonGrid {
+ public:
+  CannonGrid(const MatrixView<T>& lhs, const MatrixView<T>& rhs,
+             MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    q_ = static_cast<int>(std::lround(std::sqrt(size)));
+    if (q_ * q_ != size) {
+      throw std::invalid_argument("Cannon needs a square number of processes");
+    }
+    int dims[2] = {q_, q_}, periods[2] = {1, 1};
+    MPI_Cart_create(comm, 2, dims, periods, 0, &cart_);
+    int rank, coords[2];
+    MPI_Comm_rank(cart_, &rank);
+    MPI_Cart_coords(cart_, rank, 2, coords);
+    row_ = coords[0];
+    col_ = coords[1];
+    aRows_ = lhs.rows();
+    aCols_ = lhs.cols();
+    bRows_ = rhs.rows();
+    bCols_ = rhs.cols();
+    a_ = Copy(lhs);
+    b_ = Copy(rhs);
+  }
+
+  CannonGrid(const CannonGrid&) = delete;
+  CannonGrid& operator=(const CannonGrid&) = delete;
+
+  ~CannonGrid() { MPI_Comm_free(&cart_); }
+
+  /**
+   * Aligns the blocks: row i of A moves i places left
+   * and column j of B moves j places up.
+   */
+  void Skew() {
+    ShiftReplace(a_, 1, -row_);
+    ShiftReplace(b_, 0, -col_);
+  }
+
+  MatrixView<T> a() { return MatrixView<T>(a_.data(), aRows_, aCols_, aCols_); }
+  MatrixView<T> b() { return MatrixView<T>(b_.data(), bRows_, bCols_, bCols_); }
+
+  /**
+   * Shifts A one place left and B one place up, blocking.
+   */
+  void Shift() {
+    ShiftReplace(a_, 1, -1);
+    ShiftReplace(b_, 0, -1);
+  }
+
+  /**
+   * Starts shifting A and B into the spare buffers.
+   */
+  void StartShift(MPI_Request* requests) {
+    aNext_.resize(a_.size());
+    bNext_.resize(b_.size());
+    StartShift(a_, aNext_, 1, requests);
+    StartShift(b_, bNext_, 0, requests + 2);
+  }
+
+  /**
+   * Makes the buffers received by `StartShift` current.
+   */
+  void FinishShift() {
+    a_.swap(aNext_);
+    b_.swap(bNext_);
+  }
+
+  [[nodiscard]] int q() const noexcept { return q_; }
+
+ private:
+  static Workspace<T> Copy(const MatrixView<T>& m) {
+    Workspace<T> buf(m.size());
+    for (size_t i = 0; i < m.rows(); ++i) {
+      std::copy(m[i], m[i] + m.cols(), buf.data() + i * m.cols());
+    }
+    return buf;
+  }
+
+  void ShiftReplace(Workspace<T>& buf, int dim, int disp) {
+    int src, dst;
+    MPI_Cart_shift(cart_, dim, disp, &src, &dst);
+    if (src == dst && dst == Rank()) return;
+    MPI_Sendrecv_replace(buf.data(), static_cast<int>(buf.size()),
+                         MpiType<T>(), dst, 0, src, 0, cart_,
+                         MPI_STATUS_IGNORE);
+  }
+
+  void StartShift(Workspace<T>& cur, Workspace<T>& next, int dim,
+                  MPI_Request* requests) {
+    int src, dst;
+    MPI_Cart_shift(cart_, dim, -1, &src, &dst);
+    int n = static_cast<int>(cur.size());
+    MPI_Irecv(next.data(), n, MpiType<T>(), src, dim, cart_, &requests[0]);
+    MPI_Isend(cur.data(), n, MpiType<T>(), dst, dim, cart_, &requests[1]);
+  }
+
+  int Rank() const {
+    int rank;
+    MPI_Comm_rank(cart_, &rank);
+    return rank;
+  }
+
+  MPI_Comm cart_;
+  int q_, row_, col_;
+  size_t aRows_, aCols_, bRows_, bCols_;
+  Workspace<T> a_, b_, aNext_, bNext_;
+};
+
+}  // namespace detail
+
+/**
+ * Matrix Multiplication (Cannon, with synchronous message passing).
+ *
+ * Runs on a q x q grid of processes: the size of `comm` must be a square.
+ * Process r holds the blocks (r / q, r % q) of the three matrices,
+ * all blocks of a matrix with the same size,
+ * and adds (not stores) its block of `lhs * rhs` to `ret`.
+ * After aligning the blocks, each of the q steps multiplies
+ * the local blocks with `Gemm_b`, using block size `bs`,
+ * and then shifts the blocks of `lhs` left and those of `rhs` up.
+ * `lhs` and `rhs` are not modified.
+ */
+template <typename T>
+void Gemm_sm(MatrixView<T> ret, const MatrixView<T>& lhs,
+             const MatrixView<T>& rhs, MPI_Comm comm = MPI_COMM_WORLD,
+             size_t bs = 64, GemmStats* stats = nullptr) {
+  double start = MPI_Wtime();
+  GemmStats s;
+  detail::CannonGrid<T> grid(lhs, rhs, comm);
+  double t = MPI_Wtime();
+  grid.Skew();
+  s.commSeconds += MPI_Wtime() - t;
+  for (int step = 0; step < grid.q(); ++step) {
+    t = MPI_Wtime();
+    Gemm_b(ret, grid.a(), grid.b(), bs, bs, bs);
+    s.computeSeconds += MPI_Wtime() - t;
+    if (step + 1 == grid.q()) break;
+    t = MPI_Wtime();
+    grid.Shift();
+    s.commSeconds += MPI_Wtime() - t;
+  }
+  s.totalSeconds = MPI_Wtime() - start;
+  if (stats != nullptr) *stats = s;
+}
+
+/**
+ * Matrix Multiplication (Cannon, with asynchronous message passing).
+ *
+ * Same result and requirements as `Gemm_sm`.
+ * The blocks of the next step are sent and received with
+ * `MPI_Isend`/`MPI_Irecv` into spare buffers
+ * while the local product of the current step runs,
+ * so only the part of a shift that outlasts the product is exposed
+ * (`GemmStats::commSeconds`).
+ */
+template <typename T>
+void Gemm_am(MatrixView<T> ret, const MatrixView<T>& lhs,
+             const MatrixView<T>& rhs, MPI_Comm comm = MPI_COMM_WORLD,
+             size_t bs = 64, GemmStats* stats = nullptr) {
+  double start = MPI_Wtime();
+  GemmStats s;
+  detail::CannonGrid<T> grid(lhs, rhs, comm);
+  double t = MPI_Wtime();
+  grid.Skew();
+  s.commSeconds += MPI_Wtime() - t;
+  for (int step = 0; step < grid.q(); ++step) {
+    bool last = step + 1 == grid.q();
+    MPI_Request requests[4];
+    if (!last) grid.StartShift(requests);
+    t = MPI_Wtime();
+    Gemm_b(ret, grid.a(), grid.b(), bs, bs, bs);
+    s.computeSeconds += MPI_Wtime() - t;
+    if (last) break;
+    t = MPI_Wtime();
+    MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+    s.commSeconds += MPI_Wtime() - t;
+    grid.FinishShift();
+  }
+  s.totalSeconds = MPI_Wtime() - start;
+  if (stats != nullptr) *stats = s;
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_LINALG_M_HPP_
@@ -1,11 +1,274 @@
 #ifndef HPC_TUTOR_LINALG_T_HPP_
 #define HPC_TUTOR_LINALG_T_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
 #include "linalg.hpp"
+#include "matrix.hpp"
 #include "matrix_view.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 
 namespace tutor {
 
+namespace detail {
+
+/**
+ * Vectors shorter than this are processed by a single thread.
+ */
+inline constexpr size_t kParallelVectorElements = size_t(1) << 15;
+
+/**
+ * Write-only outputs larger than this (in bytes) use non-temporal stores,
+ * since they would only evict useful data from the caches.
+ */
+inline constexpr size_t kStreamingStoreBytes = size_t(1) << 23;
+
+/**
+ * Returns the range of `n` elements assigned to the calling thread.
+ *
+ * The split only depends on `n` and the number of threads,
+ * so a thread touches the same pages in every call,
+ * which keeps them in its NUMA node after the first touch.
+ * Range limits fall on cache line boundaries.
+ */
+template <typename T>
+std::pair<size_t, size_t> StaticChunk(size_t n) {
+#ifdef _OPENMP
+  size_t nt = omp_get_num_threads(), t = omp_get_thread_num();
+#else
+  size_t nt = 1, t = 0;
+#endif
+  constexpr size_t kLine = std::max<size_t>(1, 64 / sizeof(T));
+  size_t chunk = ((n + nt - 1) / nt + kLine - 1) / kLine * kLine;
+  size_t lo = std::min(n, t * chunk);
+  return {lo, std::min(n, lo + chunk)};
+}
+
+/**
+ * Per-thread partial results, padded to avoid false sharing.
+ */
+template <typename T>
+class Partials {
+ public:
+  Partials() {
+#ifdef _OPENMP
+    slots_.resize(omp_get_max_threads());
+#else
+    slots_.resize(1);
+#endif
+  }
+
+  void Set(T value) {
+#ifdef _OPENMP
+    slots_[omp_get_thread_num()].value = value;
+#else
+    slots_[0].value = value;
+#endif
+  }
+
+  /**
+   * Adds the partials pairwise, as a binary tree.
+   * The result only depends on the number of threads.
+   */
+  T Combine() {
+    size_t p = slots_.size();
+    for (size_t s = 1; s < p; s *= 2) {
+      for (size_t i = 0; i + s < p; i += 2 * s) {
+        slots_[i].value += slots_[i + s].value;
+      }
+    }
+    return slots_[0].value;
+  }
+
+ private:
+  struct alignas(64) Slot {
+    T value{};
+  };
+  std::vector<Slot> slots_;
+};
+
+/**
+ * Vector Addition with non-temporal stores to `ret`.
+ *
+ * Callers must issue a store fence before other threads read `ret`.
+ */
+template <typename T>
+void VectorSumStream(T* ret, const T* lhs, const T* rhs, size_t n) {
+  size_t i = 0;
+#ifdef __SSE2__
+  if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>) {
+    constexpr size_t kWidth = 16 / sizeof(T);
+    for (; i < n && reinterpret_cast<uintptr_t>(ret + i) % 16 != 0; ++i) {
+      ret[i] = lhs[i] + rhs[i];
+    }
+    for (; i + kWidth <= n; i += kWidth) {
+      if constexpr (std::is_same_v<T, double>) {
+        _mm_stream_pd(ret + i,
+                      _mm_add_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i)));
+      } else {
+        _mm_stream_ps(ret + i,
+                      _mm_add_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i)));
+      }
+    }
+  }
+#endif
+  VectorSum(ret + i, lhs + i, rhs + i, n - i);
+}
+
+inline void StoreFence() {
+#ifdef __SSE2__
+  _mm_sfence();
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * Vector by Scalar Multiplication (with thread-level parallelism).
+ */
+template <typename T>
+void ScalarMul_t(T* data, size_t n, T val) {
+#pragma omp parallel if (n >= detail::kParallelVectorElements)
+  {
+    auto [lo, hi] = detail::StaticChunk<T>(n);
+    ScalarMul(data + lo, hi - lo, val);
+  }
+}
+
+/**
+ * Accumulation (with thread-level parallelism).
+ *
+ * Each thread adds up a contiguous chunk
+ * and the partial sums are combined pairwise.
+ */
+template <typename T>
+T Accumulate_t(const T* data, size_t n) {
+  detail::Partials<T> partials;
+#pragma omp parallel if (n >= detail::kParallelVectorElements)
+  {
+    auto [lo, hi] = detail::StaticChunk<T>(n);
+    partials.Set(Accumulate(data + lo, hi - lo));
+  }
+  return partials.Combine();
+}
+
+/**
+ * Vector Inner Product (with thread-level parallelism).
+ *
+ * Each thread reduces a contiguous chunk
+ * and the partial sums are combined pairwise.
+ */
+template <typename T>
+T Inner_t(const T* lhs, const T* rhs, size_t n) {
+  detail::Partials<T> partials;
+#pragma omp parallel if (n >= detail::kParallelVectorElements)
+  {
+    auto [lo, hi] = detail::StaticChunk<T>(n);
+    partials.Set(Inner(lhs + lo, rhs + lo, hi - lo));
+  }
+  return partials.Combine();
+}
+
+/**
+ * Vector Addition (with thread-level parallelism).
+ *
+ * Outputs larger than the caches are written with non-temporal stores.
+ * `ret` must not overlap the inputs.
+ */
+template <typename T>
+void VectorSum_t(T* ret, const T* lhs, const T* rhs, size_t n) {
+  bool stream = n * sizeof(T) >= detail::kStreamingStoreBytes;
+#pragma omp parallel if (n >= detail::kParallelVectorElements)
+  {
+    auto [lo, hi] = detail::StaticChunk<T>(n);
+    if (stream) {
+      detail::VectorSumStream(ret + lo, lhs + lo, rhs + lo, hi - lo);
+      detail::StoreFence();
+    } else {
+      VectorSum(ret + lo, lhs + lo, rhs + lo, hi - lo);
+    }
+  }
+}
+
+namespace detail {
+
+/**
+ * Reproducible sum of `value(i)` for i in [0, n)
+ * (with thread-level parallelism).
+ *
+ * Same result as `ReproducibleReduce` for any number of threads.
+ */
+template <typename F>
+double ReproducibleReduce_t(size_t n, F value) {
+  double maxAbs = 0;
+#pragma omp parallel reduction(max : maxAbs) if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<double>(n);
+    maxAbs = MaxAbs(lo, hi, value);
+  }
+  ReproducibleSum total(maxAbs, n);
+#pragma omp parallel if (n >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<double>(n);
+    ReproducibleSum local(maxAbs, n);
+    local.Add(lo, hi, value);
+    // Partial sums are exact, so the merge order does not matter.
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+    total.Merge(local);
+  }
+  return total.Result();
+}
+
+}  // namespace detail
+
+/**
+ * Accumulation (reproducible, with thread-level parallelism).
+ *
+ * Bitwise identical to `Accumulate_r` for any number of threads.
+ */
+template <typename T>
+T Accumulate_rt(const T* data, size_t n) {
+  if constexpr (std::is_integral_v<T>) {
+    return Accumulate_t(data, n);
+  } else {
+    return static_cast<T>(detail::ReproducibleReduce_t(
+        n, [data](size_t i) { return static_cast<double>(data[i]); }));
+  }
+}
+
+/**
+ * Vector Inner Product (reproducible, with thread-level parallelism).
+ *
+ * Bitwise identical to `Inner_r` for any number of threads.
+ */
+template <typename T>
+T Inner_rt(const T* lhs, const T* rhs, size_t n) {
+  if constexpr (std::is_integral_v<T>) {
+    return Inner_t(lhs, rhs, n);
+  } else {
+    return static_cast<T>(
+        detail::ReproducibleReduce_t(n, [lhs, rhs](size_t i) {
+          return static_cast<double>(lhs[i]) * static_cast<double>(rhs[i]);
+        }));
+  }
+}
+
 /**
  * Element Search in Vector (with thread-level parallelism).
  */
@@ -33,6 +296,27 @@ void MatrixEval_t(T* ret, const MatrixView<T>& m, const T* v) {
   MatrixEval(ret, m, v);
 }
 
+/**
+ * Matrix by Multi-Vector Multiplication (with thread-level parallelism).
+ *
+ * Same result and requirements as the multi-vector `MatrixEval`.
+ * Threads work on disjoint row blocks of `m`.
+ */
+template <typename T>
+void MatrixEval_t(MatrixView<T> ret, const MatrixView<T>& m,
+                  const MatrixView<T>& vs) {
+  constexpr size_t kRowBlock = 64;
+  size_t nb = (m.rows() + kRowBlock - 1) / kRowBlock;
+#pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < nb; ++b) {
+    HPC_TUTOR_TRACE_SCOPE("MatrixEval_t block", static_cast<int64_t>(b));
+    size_t i = b * kRowBlock;
+    size_t rows = std::min(kRowBlock, m.rows() - i);
+    MatrixEval(ret.view(i, 0, rows, ret.cols()),
+               m.view(i, 0, rows, m.cols()), vs);
+  }
+}
+
 /**
  * Matrix Multiplication.
  *
@@ -46,6 +330,366 @@ void Gemm_t(MatrixView<T> ret, const MatrixView<T>& lhs,
   Gemm(ret, lhs, rhs);
 }
 
+/**
+ * LU Factorization Routine (with thread-level parallelism).
+ *
+ * Same result and requirements as `LuFact`.
+ * Each step factors the diagonal tile on one thread,
+ * then threads share the panel solves and the trailing update by tiles,
+ * with a barrier in between (bulk-synchronous).
+ */
+template <typename T>
+void LuFact_t(MatrixView<T> m, size_t bs) {
+  size_t nt = (m.rows() + bs - 1) / bs;
+  auto tile = [&](size_t i, size_t j) {
+    return m.view(i * bs, j * bs, std::min(bs, m.rows() - i * bs),
+                  std::min(bs, m.cols() - j * bs));
+  };
+  for (size_t k = 0; k < nt; ++k) {
+    auto akk = tile(k, k);
+    {
+      HPC_TUTOR_TRACE_SCOPE("LuFact_t getrf", static_cast<int64_t>(k));
+      detail::TileGetrf(akk);
+    }
+    size_t rest = nt - k - 1;
+    if (rest == 0) break;
+#pragma omp parallel
+    {
+      // The first `rest` solves are on the row panel, the others on the
+      // column panel.
+#pragma omp for schedule(static)
+      for (size_t b = 0; b < 2 * rest; ++b) {
+        HPC_TUTOR_TRACE_SCOPE("LuFact_t trsm", static_cast<int64_t>(b));
+        if (b < rest) {
+          detail::TileTrsmLowerUnit(akk, tile(k, k + 1 + b));
+        } else {
+          detail::TileTrsmUpperRight(akk, tile(k + 1 + b - rest, k));
+        }
+      }
+#pragma omp for schedule(static)
+      for (size_t b = 0; b < rest * rest; ++b) {
+        HPC_TUTOR_TRACE_SCOPE("LuFact_t update", static_cast<int64_t>(b));
+        size_t i = k + 1 + b / rest, j = k + 1 + b % rest;
+        detail::TileGemmSub(tile(i, j), tile(i, k), tile(k, j));
+      }
+    }
+  }
+}
+
+/**
+ * Cholesky Factorization Routine (with thread-level parallelism).
+ *
+ * Same result and requirements as `Cholesky_b`.
+ * Threads share the panel solve by row blocks
+ * and the trailing update by block columns.
+ */
+template <typename T>
+void Cholesky_t(MatrixView<T> m, size_t bs) {
+  size_t n = m.rows();
+  detail::Workspace<T> buf;
+  for (size_t k = 0; k < n; k += bs) {
+    size_t kb = std::min(bs, n - k), rest = n - k - kb;
+    auto akk = m.view(k, k, kb, kb);
+    {
+      HPC_TUTOR_TRACE_SCOPE("Cholesky_t potrf", static_cast<int64_t>(k));
+      detail::TilePotrf(akk);
+    }
+    if (rest == 0) break;
+    auto panel = m.view(k + kb, k, rest, kb);
+    auto trail = m.view(k + kb, k + kb, rest, rest);
+    buf.resize(kb * rest);
+    MatrixView<T> panelT(buf.data(), kb, rest, rest);
+    size_t nb = (rest + bs - 1) / bs;
+#pragma omp parallel
+    {
+#pragma omp for schedule(static)
+      for (size_t b = 0; b < nb; ++b) {
+        HPC_TUTOR_TRACE_SCOPE("Cholesky_t trsm", static_cast<int64_t>(b));
+        size_t j = b * bs, jb = std::min(bs, rest - j);
+        auto lik = panel.view(j, 0, jb, kb);
+        detail::TileTrsmLowerTransRight(akk, lik);
+        for (size_t i = 0; i < jb; ++i) {
+          for (size_t c = 0; c < kb; ++c) panelT[c][j + i] = lik[i][c];
+        }
+      }
+      // Block columns get shorter to the right.
+#pragma omp for schedule(dynamic, 1)
+      for (size_t b = 0; b < nb; ++b) {
+        HPC_TUTOR_TRACE_SCOPE("Cholesky_t update", static_cast<int64_t>(b));
+        size_t j = b * bs;
+        detail::CholeskyUpdate(trail, panel, panelT, j, std::min(bs, rest - j));
+      }
+    }
+  }
+}
+
+/**
+ * QR Factorization Routine (with thread-level parallelism).
+ *
+ * Same result and storage as `QrFact_b`.
+ * Panels are factored by one thread
+ * and threads share the trailing update by column strips.
+ */
+template <typename T>
+void QrFact_t(MatrixView<T> m, T* tau, size_t bs) {
+  static_assert(std::is_floating_point_v<T>, "QR needs a floating point type");
+  size_t r = m.rows(), c = m.cols(), kmax = std::min(r, c);
+  detail::Workspace<T> work(std::max(c, r * bs + bs * bs));
+  for (size_t k = 0; k < kmax; k += bs) {
+    size_t kb = std::min(bs, kmax - k), rest = c - k - kb;
+    auto panel = m.view(k, k, r - k, kb);
+    MatrixView<T> v(work.data(), r - k, kb, kb);
+    MatrixView<T> t(v.data() + (r - k) * kb, kb, kb, kb);
+    {
+      HPC_TUTOR_TRACE_SCOPE("QrFact_t panel", static_cast<int64_t>(k));
+      detail::QrPanel(panel, tau + k, work.data());
+      if (rest == 0) continue;
+      detail::QrReflectors(panel, v);
+      detail::QrTriangularFactor(v, tau + k, t);
+    }
+#pragma omp parallel if ((r - k) * rest >= detail::kParallelVectorElements)
+    {
+      auto [lo, hi] = detail::StaticChunk<T>(rest);
+      if (lo < hi) {
+        HPC_TUTOR_TRACE_SCOPE("QrFact_t update", static_cast<int64_t>(k));
+        detail::Workspace<T> w(2 * kb * (hi - lo));
+        detail::QrApplyBlockTrans(v, t, m.view(k, k + kb + lo, r - k, hi - lo),
+                                  w.data());
+      }
+    }
+  }
+}
+
+/**
+ * Tall-Skinny QR factorization, as computed by `Tsqr_t`.
+ *
+ * The rows are split in blocks (the leaves) that are factored
+ * independently; then the R factors are stacked in pairs and factored
+ * again, level by level, until a single R remains.
+ * Q is kept implicitly as the reflectors of every leaf and tree node.
+ */
+template <typename T>
+class TsqrFactor {
+ public:
+  /**
+   * Factors `m`, which must have at least as many rows as columns,
+   * in place, with up to `leaves` leaves (0 means one per thread)
+   * factored by `QrFact_b` with block size `bs`.
+   */
+  TsqrFactor(MatrixView<T> m, size_t leaves, size_t bs) : m_(m) {
+    static_assert(std::is_floating_point_v<T>,
+                  "QR needs a floating point type");
+    size_t r = m.rows(), c = m.cols();
+#ifdef _OPENMP
+    if (leaves == 0) leaves = omp_get_max_threads();
+#endif
+    // Every leaf needs a full R, i.e., at least `c` rows.
+    leaves = std::max<size_t>(1, std::min(leaves, c == 0 ? 1 : r / c));
+    for (size_t i = 0; i <= leaves; ++i) leafStart_.push_back(i * r / leaves);
+    leafTau_.resize(leaves * c);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < leaves; ++i) {
+      HPC_TUTOR_TRACE_SCOPE("Tsqr_t leaf", static_cast<int64_t>(i));
+      QrFact_b(Leaf(i), leafTau_.data() + i * c, bs);
+    }
+
+    // Lay out the tree: node j of a level joins items 2j and 2j + 1
+    // of the level below; a node with a single item keeps its R.
+    size_t size = 0;
+    for (size_t count = leaves; count > 1; count = (count + 1) / 2) {
+      levels_.emplace_back();
+      for (size_t j = 0; 2 * j < count; ++j) {
+        size_t kids = std::min<size_t>(2, count - 2 * j);
+        levels_.back().push_back({kids, size});
+        size += (kids * c + 1) * c;
+      }
+    }
+    tree_.resize(size);
+    for (size_t l = 0; l < levels_.size(); ++l) {
+      auto& level = levels_[l];
+#pragma omp parallel for schedule(static)
+      for (size_t j = 0; j < level.size(); ++j) {
+        HPC_TUTOR_TRACE_SCOPE("Tsqr_t node", static_cast<int64_t>(l));
+        auto qr = Qr(level[j]);
+        T* tau = Tau(level[j]);
+        std::fill(qr.data(), qr.data() + qr.rows() * c, T(0));
+        std::fill(tau, tau + c, T(0));
+        for (size_t q = 0; q < level[j].kids; ++q) {
+          auto kid = R(l, 2 * j + q);
+          for (size_t i = 0; i < c; ++i) {
+            std::copy(kid[i] + i, kid[i] + c, qr[q * c + i] + i);
+          }
+        }
+        if (level[j].kids == 2) QrFact_b(qr, tau, bs);
+      }
+    }
+  }
+
+  /**
+   * Returns the number of leaves.
+   */
+  [[nodiscard]] size_t leaves() const noexcept {
+    return leafStart_.size() - 1;
+  }
+
+  /**
+   * Returns the R factor (cols x cols, upper triangular).
+   */
+  [[nodiscard]] Matrix<T> r() const {
+    size_t c = m_.cols();
+    auto root = R(levels_.size(), 0);
+    Matrix<T> ret(c, c);
+    for (size_t i = 0; i < c; ++i) {
+      std::copy(root[i] + i, root[i] + c, ret[i] + i);
+    }
+    return ret;
+  }
+
+  /**
+   * Solves the least squares problem min ||Ax - b||, A of full rank.
+   * `x` receives cols elements; `b` has rows elements.
+   */
+  void Solve(T* x, const T* b) const {
+    size_t c = m_.cols(), nl = leaves();
+    detail::Workspace<T> y(b, b + m_.rows());
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < nl; ++i) {
+      detail::QrApplyTrans(Leaf(i), leafTau_.data() + i * c,
+                           y.data() + leafStart_[i]);
+    }
+    // The top `c` entries of each item are the ones its parent mixes;
+    // siblings are adjacent, so a node applies its Q^T to a slice in place.
+    detail::Workspace<T> cur(nl * c), next;
+    for (size_t i = 0; i < nl; ++i) {
+      std::copy_n(y.data() + leafStart_[i], c, cur.data() + i * c);
+    }
+    for (const auto& level : levels_) {
+      next.resize(level.size() * c);
+      for (size_t j = 0; j < level.size(); ++j) {
+        T* slice = cur.data() + 2 * j * c;
+        detail::QrApplyTrans(Qr(level[j]), Tau(level[j]), slice);
+        std::copy_n(slice, c, next.data() + j * c);
+      }
+      cur.swap(next);
+    }
+    detail::QrBackSubstitute(x, R(levels_.size(), 0), cur.data());
+  }
+
+ private:
+  struct Node {
+    size_t kids;    ///< Stacked R factors, one or two.
+    size_t offset;  ///< Position of the stacked factors, then tau, in tree_.
+  };
+
+  MatrixView<T> Leaf(size_t i) const {
+    return m_.view(leafStart_[i], 0, leafStart_[i + 1] - leafStart_[i],
+                   m_.cols());
+  }
+
+  // MatrixView has no read-only form, hence the casts below.
+  MatrixView<T> Qr(const Node& node) const {
+    size_t c = m_.cols();
+    return MatrixView<T>(const_cast<T*>(tree_.data()) + node.offset,
+                         node.kids * c, c, c);
+  }
+
+  T* Tau(const Node& node) const {
+    size_t c = m_.cols();
+    return const_cast<T*>(tree_.data()) + node.offset + node.kids * c * c;
+  }
+
+  /**
+   * Returns the view whose upper triangle is the R factor of item `i`
+   * of level `l`, where level 0 holds the leaves.
+   */
+  MatrixView<T> R(size_t l, size_t i) const {
+    size_t c = m_.cols();
+    auto qr = l == 0 ? Leaf(i) : Qr(levels_[l - 1][i]);
+    return qr.view(0, 0, c, c);
+  }
+
+  MatrixView<T> m_;
+  std::vector<size_t> leafStart_;
+  detail::Workspace<T> leafTau_;
+  detail::Workspace<T> tree_;
+  std::vector<std::vector<Node>> levels_;
+};
+
+/**
+ * Tall-Skinny QR Factorization Routine (with thread-level parallelism).
+ *
+ * For matrices with many more rows than columns,
+ * where the panels of `QrFact_t` would leave the threads idle.
+ * The leaves are factored in parallel and reduced by a binary tree;
+ * see `TsqrFactor`.
+ * Q is represented by the whole tree rather than in the `QrFact` storage,
+ * so `m` is only meaningful through the returned factor.
+ */
+template <typename T>
+TsqrFactor<T> Tsqr_t(MatrixView<T> m, size_t leaves = 0, size_t bs = 32) {
+  return TsqrFactor<T>(m, leaves, bs);
+}
+
+/**
+ * Element Search in Vector (on a persistent thread pool).
+ *
+ * Inputs smaller than the serial threshold of the pool
+ * are searched by the calling thread.
+ */
+template <typename T>
+size_t Find_t(ThreadPool& pool, T* v, size_t n, const T& val) {
+  if (!pool.ShouldParallelize(n)) return Find(v, n, val);
+  std::atomic<size_t> first(n);
+  pool.ParallelFor(0, n, 0, [&](size_t lo, size_t hi) {
+    // Chunks after an already found element have nothing to report.
+    if (lo >= first.load(std::memory_order_relaxed)) return;
+    size_t i = lo + Find(v + lo, hi - lo, val);
+    if (i == hi) return;
+    size_t cur = first.load(std::memory_order_relaxed);
+    while (i < cur && !first.compare_exchange_weak(cur, i)) {
+    }
+  });
+  return first.load();
+}
+
+/**
+ * Matrix by Vector Multiplication (on a persistent thread pool).
+ *
+ * Matrices smaller than the serial threshold of the pool
+ * are evaluated by the calling thread.
+ */
+template <typename T>
+void MatrixEval_t(ThreadPool& pool, T* ret, const MatrixView<T>& m,
+                  const T* v) {
+  // Empty matrices would have no grain.
+  if (m.cols() == 0 || !pool.ShouldParallelize(m.size())) {
+    MatrixEval(ret, m, v);
+    return;
+  }
+  size_t grain = std::max<size_t>(1, pool.serialThreshold() / m.cols() / 4);
+  pool.ParallelFor(0, m.rows(), grain, [&](size_t lo, size_t hi) {
+    MatrixEval(ret + lo, m.view(lo, 0, hi - lo, m.cols()), v);
+  });
+}
+
+/**
+ * Matrix Multiplication (on a persistent thread pool).
+ *
+ * The rows of `ret` are distributed among the threads of the pool.
+ */
+template <typename T>
+void Gemm_t(ThreadPool& pool, MatrixView<T> ret, const MatrixView<T>& lhs,
+            const MatrixView<T>& rhs) {
+  if (!pool.ShouldParallelize(ret.size() * lhs.cols())) {
+    Gemm(ret, lhs, rhs);
+    return;
+  }
+  pool.ParallelFor(0, ret.rows(), 0, [&](size_t lo, size_t hi) {
+    Gemm(ret.view(lo, 0, hi - lo, ret.cols()),
+         lhs.view(lo, 0, hi - lo, lhs.cols()), rhs);
+  });
+}
+
 }  // namespace tutor
 
 #endif  // HPC_TUTOR_LINALG_T_HPP_
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "matrix_view.hpp"
+#include "memory.hpp"
 
 namespace tutor {
 
@@ -22,12 +23,16 @@ namespace tutor {
  * using offsets on regular pointers to its elements.
  * Both of its dimensions can change dynamically,
  * with their storage being handled automatically by the container.
+ *
+ * Storage is obtained from `Allocator`.
+ * Using `PoolAllocator` makes temporary matrices reuse memory across calls.
  */
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class Matrix {
  public:
   using value_type = T;
   using size_type = size_t;
+  using allocator_type = Allocator;
   using row_reference = T*;
   using const_row_reference = const T*;
 
@@ -45,6 +50,16 @@ class Matrix {
    * Each element is default initialized.
    */
   constexpr Matrix(size_type n, size_type m)
+      : rows_(n), cols_(m), data_(n * m, value_type()) {}
+
+  /**
+   * Uninitialized constructor.
+   *
+   * Constructs a matrix of size n x m.
+   * Elements of trivial types are left uninitialized,
+   * so the memory is not touched until it is written.
+   */
+  constexpr Matrix(size_type n, size_type m, uninitialized_t)
       : rows_(n), cols_(m), data_(n * m) {}
 
   /**
@@ -136,7 +151,7 @@ class Matrix {
     for (const auto& row : ill) {
       cols_ = std::max(cols_, row.size());
     }
-    data_.resize(rows_ * cols_);
+    data_.assign(rows_ * cols_, value_type());
     value_type* rowPtr = data_.data();
     for (const auto& row : ill) {
       value_type* colPtr = rowPtr;
@@ -216,7 +231,7 @@ class Matrix {
    * [data(), data() + size()) or [data(), data() + rows()*cols())
    * is valid.
    */
-  [[nodiscard]] constexpr value_type* data() const noexcept {
+  [[nodiscard]] constexpr const value_type* data() const noexcept {
     return data_.data();
   }
 
@@ -273,7 +288,7 @@ class Matrix {
  private:
   size_type rows_;
   size_type cols_;
-  std::vector<T> data_;
+  std::vector<T, detail::DefaultInitAllocator<T, Allocator>> data_;
 };
 
 }  // namespace tutor
@@ -148,6 +148,13 @@ class MatrixView {
    */
   [[nodiscard]] constexpr size_type cols() const noexcept { return cols_; }
 
+  /**
+   * Returns the distance, in elements, between consecutive rows.
+   */
+  [[nodiscard]] constexpr size_type rowStride() const noexcept {
+    return rowStride_;
+  }
+
  private:
   value_type* data_;
   size_type rows_;
@@ -0,0 +1,278 @@
+#ifndef HPC_TUTOR_MEMORY_HPP_
+#define HPC_TUTOR_MEMORY_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tutor {
+
+/**
+ * Tag type to request uninitialized construction.
+ */
+struct uninitialized_t {
+  explicit uninitialized_t() = default;
+};
+
+/**
+ * Tag to request uninitialized construction,
+ * e.g., `Matrix<double>(n, m, uninitialized)`.
+ */
+inline constexpr uninitialized_t uninitialized{};
+
+/**
+ * HPC Tutor Memory Pool.
+ *
+ * MemoryPool caches freed blocks to serve later requests of similar size,
+ * which saves the allocator calls and the page faults
+ * of repeatedly allocating large temporaries.
+ *
+ * Requests are rounded up to a size class
+ * (four classes per power of two, so at most 25% is wasted)
+ * and blocks are aligned to cache lines.
+ * Each thread keeps a few small blocks of each class
+ * that it can reuse without locking;
+ * other blocks go to a per-class free list shared by all threads.
+ */
+class MemoryPool {
+ public:
+  /**
+   * Alignment, in bytes, of every block.
+   */
+  static constexpr size_t kAlignment = 64;
+
+  /**
+   * Largest block kept in the per-thread caches.
+   */
+  static constexpr size_t kMaxLocalBlock = size_t(1) << 18;
+
+  MemoryPool(const MemoryPool&) = delete;
+  MemoryPool& operator=(const MemoryPool&) = delete;
+
+  ~MemoryPool() { Trim(); }
+
+  /**
+   * Returns the process-wide pool.
+   *
+   * It is never destroyed: worker threads of `ThreadPool::Global()`
+   * return their cached blocks to it when they exit,
+   * which happens during static destruction.
+   */
+  static MemoryPool& Global() {
+    static MemoryPool* pool = new MemoryPool;
+    return *pool;
+  }
+
+  /**
+   * Returns an uninitialized block of at least `bytes` bytes.
+   */
+  void* Allocate(size_t bytes) {
+    size_t c = ClassOf(bytes);
+    if (ClassSize(c) <= kMaxLocalBlock) {
+      LocalCache& local = Local();
+      if (local.count[c] > 0) return local.blocks[c][--local.count[c]];
+    }
+    {
+      FreeList& list = lists_[c];
+      std::lock_guard<std::mutex> lock(list.mutex);
+      if (!list.blocks.empty()) {
+        void* p = list.blocks.back();
+        list.blocks.pop_back();
+        cachedBytes_.fetch_sub(ClassSize(c), std::memory_order_relaxed);
+        return p;
+      }
+    }
+    return ::operator new(ClassSize(c), std::align_val_t(kAlignment));
+  }
+
+  /**
+   * Returns a block obtained from `Allocate(bytes)` to the pool.
+   */
+  void Deallocate(void* p, size_t bytes) {
+    if (p == nullptr) return;
+    size_t c = ClassOf(bytes);
+    if (ClassSize(c) <= kMaxLocalBlock) {
+      LocalCache& local = Local();
+      if (local.count[c] < kLocalBlocks) {
+        local.blocks[c][local.count[c]++] = p;
+        return;
+      }
+    }
+    Release(c, p);
+  }
+
+  /**
+   * Frees the blocks held in the shared free lists.
+   */
+  void Trim() {
+    for (size_t c = 0; c < kNumClasses; ++c) {
+      std::lock_guard<std::mutex> lock(lists_[c].mutex);
+      for (void* p : lists_[c].blocks) {
+        ::operator delete(p, std::align_val_t(kAlignment));
+      }
+      cachedBytes_.fetch_sub(ClassSize(c) * lists_[c].blocks.size(),
+                             std::memory_order_relaxed);
+      lists_[c].blocks.clear();
+    }
+  }
+
+  /**
+   * Returns the bytes held in the shared free lists.
+   */
+  [[nodiscard]] size_t cachedBytes() const noexcept {
+    return cachedBytes_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the size of the blocks used to serve requests of `bytes` bytes.
+   */
+  static size_t BlockSize(size_t bytes) { return ClassSize(ClassOf(bytes)); }
+
+ private:
+  static constexpr size_t kMinBlock = 64;
+  static constexpr size_t kNumClasses = 1 + 4 * 58;
+  static constexpr size_t kLocalBlocks = 4;
+  // Covers every class up to kMaxLocalBlock.
+  static constexpr size_t kNumLocalClasses = 1 + 4 * 13;
+
+  struct FreeList {
+    std::mutex mutex;
+    std::vector<void*> blocks;
+  };
+
+  /**
+   * Blocks cached by a thread.
+   * They go back to the shared lists when the thread exits.
+   */
+  struct LocalCache {
+    void* blocks[kNumLocalClasses][kLocalBlocks];
+    size_t count[kNumLocalClasses] = {};
+    ~LocalCache() {
+      for (size_t c = 0; c < kNumLocalClasses; ++c) {
+        for (size_t k = 0; k < count[c]; ++k) {
+          Global().Release(c, blocks[c][k]);
+        }
+      }
+    }
+  };
+
+  MemoryPool() = default;
+
+  static LocalCache& Local() {
+    static thread_local LocalCache cache;
+    return cache;
+  }
+
+  /**
+   * Classes are 64 bytes and then (5, 6, 7, 8) * 2^(e - 2) for e >= 6.
+   */
+  static size_t ClassOf(size_t bytes) {
+    if (bytes <= kMinBlock) return 0;
+    size_t x = bytes - 1;
+    size_t e = 63 - static_cast<size_t>(__builtin_clzll(x));
+    size_t sub = (x >> (e - 2)) & 3;
+    return 1 + (e - 6) * 4 + sub;
+  }
+
+  static size_t ClassSize(size_t c) {
+    if (c == 0) return kMinBlock;
+    size_t e = 6 + (c - 1) / 4, sub = (c - 1) % 4;
+    return (5 + sub) << (e - 2);
+  }
+
+  void Release(size_t c, void* p) {
+    std::lock_guard<std::mutex> lock(lists_[c].mutex);
+    lists_[c].blocks.push_back(p);
+    cachedBytes_.fetch_add(ClassSize(c), std::memory_order_relaxed);
+  }
+
+  FreeList lists_[kNumClasses];
+  std::atomic<size_t> cachedBytes_{0};
+};
+
+/**
+ * Allocator that draws memory from the global MemoryPool.
+ */
+template <typename T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+
+  PoolAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+  [[nodiscard]] T* allocate(size_t n) {
+    return static_cast<T*>(MemoryPool::Global().Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    MemoryPool::Global().Deallocate(p, n * sizeof(T));
+  }
+
+  friend bool operator==(const PoolAllocator&, const PoolAllocator&) noexcept {
+    return true;
+  }
+
+  friend bool operator!=(const PoolAllocator&, const PoolAllocator&) noexcept {
+    return false;
+  }
+};
+
+namespace detail {
+
+/**
+ * Allocator adaptor that default-initializes (instead of value-initializing)
+ * elements constructed without arguments.
+ * For trivial types such as `double`, that leaves the memory untouched.
+ */
+template <typename T, typename A = std::allocator<T>>
+class DefaultInitAllocator : public A {
+  using Traits = std::allocator_traits<A>;
+
+ public:
+  template <typename U>
+  struct rebind {
+    using other =
+        DefaultInitAllocator<U, typename Traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  DefaultInitAllocator() = default;
+
+  template <typename U, typename B>
+  DefaultInitAllocator(const DefaultInitAllocator<U, B>& other) noexcept
+      : A(static_cast<const B&>(other)) {}
+
+  template <typename U>
+  void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    ::new (static_cast<void*>(p)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    Traits::construct(static_cast<A&>(*this), p, std::forward<Args>(args)...);
+  }
+};
+
+/**
+ * Scratch buffer for library routines.
+ *
+ * Memory comes from the global pool and,
+ * for trivial types, elements are left uninitialized.
+ */
+template <typename T>
+using Workspace = std::vector<T, DefaultInitAllocator<T, PoolAllocator<T>>>;
+
+}  // namespace detail
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_MEMORY_HPP_
@@ -0,0 +1,167 @@
+#ifndef HPC_TUTOR_RANDOM_HPP_
+#define HPC_TUTOR_RANDOM_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "matrix_view.hpp"
+
+namespace tutor {
+
+namespace detail {
+
+/**
+ * Philox4x32-10 Counter-Based Generator.
+ *
+ * Maps a 128-bit counter and a 64-bit key to 128 random bits
+ * (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011).
+ * Since the output only depends on the counter and the key,
+ * any element of a random sequence can be computed independently,
+ * which makes parallel generation reproducible for any thread count.
+ * Only 64 of the output bits are returned, which is all the fills need.
+ */
+inline uint64_t Philox4x32(uint64_t counter, uint64_t stream,
+                           uint64_t seed) noexcept {
+  constexpr uint32_t kMul0 = 0xD2511F53u, kMul1 = 0xCD9E8D57u;
+  constexpr uint32_t kWeyl0 = 0x9E3779B9u, kWeyl1 = 0xBB67AE85u;
+  uint32_t c0 = static_cast<uint32_t>(counter);
+  uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+  uint32_t c2 = static_cast<uint32_t>(stream);
+  uint32_t c3 = static_cast<uint32_t>(stream >> 32);
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int round = 0; round < 10; ++round) {
+    uint64_t p0 = static_cast<uint64_t>(kMul0) * c0;
+    uint64_t p1 = static_cast<uint64_t>(kMul1) * c2;
+    uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    uint32_t n1 = static_cast<uint32_t>(p1);
+    uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    uint32_t n3 = static_cast<uint32_t>(p0);
+    c0 = n0;
+    c1 = n1;
+    c2 = n2;
+    c3 = n3;
+    k0 += kWeyl0;
+    k1 += kWeyl1;
+  }
+  return (static_cast<uint64_t>(c1) << 32) | c0;
+}
+
+/**
+ * Maps 64 random bits to a uniform value in [low, high)
+ * for floating point types or in [low, high] for integral types.
+ */
+template <typename T>
+T UniformFromBits(uint64_t bits, T low, T high) noexcept {
+  if constexpr (std::is_floating_point_v<T>) {
+    // As many bits as the significand holds, so that u < 1 exactly.
+    constexpr int kBits = std::min(std::numeric_limits<T>::digits, 64);
+    constexpr T kScale = T(0.5) / static_cast<T>(uint64_t(1) << (kBits - 1));
+    T u = static_cast<T>(bits >> (64 - kBits)) * kScale;
+    T ret = low + u * (high - low);
+    // The sum can still round up to `high`.
+    return ret < high ? ret : std::nextafter(high, low);
+  } else {
+    using U = std::make_unsigned_t<T>;
+    // In U: the span of a full-range signed type overflows T.
+    U span = static_cast<U>(static_cast<U>(high) - static_cast<U>(low));
+    uint64_t range = static_cast<uint64_t>(span) + 1;
+    // Multiply-shift (Lemire) range reduction. A full 64-bit range wraps to 0.
+    uint64_t offset =
+        range == 0 ? bits
+                   : static_cast<uint64_t>(
+                         (static_cast<unsigned __int128>(bits) * range) >> 64);
+    return static_cast<T>(static_cast<U>(low) + static_cast<U>(offset));
+  }
+}
+
+/**
+ * Fills `data[0..n)` with the values of positions [first, first + n)
+ * of the sequence.
+ */
+template <typename T>
+void FillUniformRange(T* data, size_t n, uint64_t first, T low, T high,
+                      uint64_t seed, uint64_t stream) noexcept {
+#pragma omp simd
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = UniformFromBits(Philox4x32(first + i, stream, seed), low, high);
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Fills a vector with uniformly distributed random values.
+ *
+ * Values are in [low, high) for floating point types
+ * and in [low, high] for integral types.
+ * Element i only depends on `seed`, `stream` and i,
+ * so different streams give independent sequences for the same seed.
+ */
+template <typename T>
+void FillUniform(T* data, size_t n, T low, T high, uint64_t seed,
+                 uint64_t stream = 0) {
+  detail::FillUniformRange(data, n, 0, low, high, seed, stream);
+}
+
+/**
+ * Fills a matrix with uniformly distributed random values.
+ *
+ * The element at (i, j) takes the value of position i * cols + j
+ * of the sequence, regardless of the row stride.
+ */
+template <typename T>
+void FillUniform(MatrixView<T> m, T low, T high, uint64_t seed,
+                 uint64_t stream = 0) {
+  for (size_t i = 0; i < m.rows(); ++i) {
+    detail::FillUniformRange(m[i], m.cols(), i * m.cols(), low, high, seed,
+                             stream);
+  }
+}
+
+/**
+ * Fills a vector with uniformly distributed random values
+ * (with thread-level parallelism).
+ *
+ * Produces the same values as `FillUniform` for any number of threads.
+ */
+template <typename T>
+void FillUniform_t(T* data, size_t n, T low, T high, uint64_t seed,
+                   uint64_t stream = 0) {
+  constexpr size_t kChunk = 4096;
+  size_t nc = (n + kChunk - 1) / kChunk;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (size_t c = 0; c < nc; ++c) {
+    size_t lo = c * kChunk;
+    size_t hi = lo + kChunk < n ? lo + kChunk : n;
+    detail::FillUniformRange(data + lo, hi - lo, lo, low, high, seed, stream);
+  }
+}
+
+/**
+ * Fills a matrix with uniformly distributed random values
+ * (with thread-level parallelism).
+ *
+ * Produces the same values as `FillUniform` for any number of threads.
+ */
+template <typename T>
+void FillUniform_t(MatrixView<T> m, T low, T high, uint64_t seed,
+                   uint64_t stream = 0) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (size_t i = 0; i < m.rows(); ++i) {
+    detail::FillUniformRange(m[i], m.cols(), i * m.cols(), low, high, seed,
+                             stream);
+  }
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_RANDOM_HPP_
@@ -0,0 +1,600 @@
+#ifndef HPC_TUTOR_REDUCE_HPP_
+#define HPC_TUTOR_REDUCE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "async.hpp"
+#include "binary_file.hpp"
+#include "cpu.hpp"
+#include "linalg_t.hpp"
+#include "matrix_view.hpp"
+#include "memory.hpp"
+#include "thread_pool.hpp"
+
+namespace tutor {
+
+namespace detail {
+
+/**
+ * Columns reduced together. Their accumulators, a few KiB, stay in L1
+ * while the rows go by, and each row contributes a contiguous segment,
+ * so the inner loops vectorize instead of striding down a column.
+ */
+inline constexpr size_t kColumnStrip = 256;
+
+/**
+ * Independent partial results of a row reduction, so that it vectorizes.
+ */
+inline constexpr size_t kReduceLanes = 8;
+
+/**
+ * Identity of `min`: +infinity, or the largest value of integers.
+ */
+template <typename T>
+constexpr T MinIdentity() {
+  if constexpr (std::numeric_limits<T>::has_infinity) {
+    return std::numeric_limits<T>::infinity();
+  } else {
+    return std::numeric_limits<T>::max();
+  }
+}
+
+/**
+ * Identity of `max`: -infinity, or the lowest value of integers.
+ */
+template <typename T>
+constexpr T MaxIdentity() {
+  if constexpr (std::numeric_limits<T>::has_infinity) {
+    return -std::numeric_limits<T>::infinity();
+  } else {
+    return std::numeric_limits<T>::lowest();
+  }
+}
+
+/**
+ * Reduces `row` with `op` over `kReduceLanes` lanes,
+ * then combines the lanes and the tail in order.
+ */
+template <typename T, typename Op>
+T ReduceRow(const T* row, size_t n, T identity, const Op& op) {
+  T acc[kReduceLanes];
+  std::fill(acc, acc + kReduceLanes, identity);
+  size_t j = 0;
+  for (; j + kReduceLanes <= n; j += kReduceLanes) {
+    for (size_t k = 0; k < kReduceLanes; ++k) acc[k] = op(acc[k], row[j + k]);
+  }
+  for (size_t s = kReduceLanes / 2; s > 0; s /= 2) {
+    for (size_t k = 0; k < s; ++k) acc[k] = op(acc[k], acc[k + s]);
+  }
+  for (; j < n; ++j) acc[0] = op(acc[0], row[j]);
+  return acc[0];
+}
+
+template <typename T>
+T RowSum(const T* row, size_t n) {
+  return ReduceRow(row, n, T(0), [](T a, T b) { return a + b; });
+}
+
+// NaN are skipped: std::min and std::max keep their first argument
+// when the comparison is false.
+
+template <typename T>
+T RowMin(const T* row, size_t n) {
+  return ReduceRow(row, n, MinIdentity<T>(),
+                   [](T a, T b) { return std::min(a, b); });
+}
+
+template <typename T>
+T RowMax(const T* row, size_t n) {
+  return ReduceRow(row, n, MaxIdentity<T>(),
+                   [](T a, T b) { return std::max(a, b); });
+}
+
+/**
+ * Calls `f(row, j0, j1)` for every row of `m`, one strip
+ * of columns [j0, j1) at a time.
+ */
+template <typename T, typename F>
+void ForColumnStrips(const MatrixView<T>& m, const F& f) {
+  for (size_t j0 = 0; j0 < m.cols(); j0 += kColumnStrip) {
+    size_t j1 = std::min(m.cols(), j0 + kColumnStrip);
+    for (size_t i = 0; i < m.rows(); ++i) f(i, m[i], j0, j1);
+  }
+}
+
+/**
+ * Adds the columns of `m` to `sums`.
+ */
+template <typename T>
+void AddColumns(T* sums, const MatrixView<T>& m) {
+  ForColumnStrips(m, [&](size_t, const T* row, size_t j0, size_t j1) {
+    for (size_t j = j0; j < j1; ++j) sums[j] += row[j];
+  });
+}
+
+template <typename T>
+void MinColumns(T* mins, const MatrixView<T>& m) {
+  ForColumnStrips(m, [&](size_t, const T* row, size_t j0, size_t j1) {
+    for (size_t j = j0; j < j1; ++j) mins[j] = std::min(mins[j], row[j]);
+  });
+}
+
+/**
+ * Updates the maxima of the columns of `m`, and their first row,
+ * where the rows of `m` are numbered from `firstRow`.
+ */
+template <typename T>
+void MaxColumns(T* maxs, size_t* argMaxs, const MatrixView<T>& m,
+                size_t firstRow) {
+  ForColumnStrips(m, [&](size_t i, const T* row, size_t j0, size_t j1) {
+    for (size_t j = j0; j < j1; ++j) {
+      // Selects instead of branching, so that the loop vectorizes.
+      bool greater = row[j] > maxs[j];
+      maxs[j] = greater ? row[j] : maxs[j];
+      argMaxs[j] = greater ? firstRow + i : argMaxs[j];
+    }
+  });
+}
+
+/**
+ * Returns the number of row blocks of the `_t` column reductions.
+ */
+inline size_t MaxThreads() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/**
+ * Calls `f(block, rows, firstRow)` on the row block of each thread,
+ * with `block` the thread number; blocks of idle threads are skipped.
+ */
+template <typename T, typename F>
+void ForRowBlocks_t(const MatrixView<T>& m, const F& f) {
+#pragma omp parallel if (m.size() >= kParallelVectorElements)
+  {
+    auto [lo, hi] = StaticChunk<T>(m.rows());
+#ifdef _OPENMP
+    size_t block = omp_get_thread_num();
+#else
+    size_t block = 0;
+#endif
+    if (lo < hi) f(block, m.view(lo, 0, hi - lo, m.cols()), lo);
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Row Sums: ret[i] is the sum of row i of `m`.
+ *
+ * Each row is added over a few independent lanes, so that it vectorizes.
+ */
+template <typename T>
+void RowSums(T* ret, const MatrixView<T>& m) {
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < m.rows(); ++i) {
+      ret[i] = detail::RowSum(m[i], m.cols());
+    }
+  });
+}
+
+/**
+ * Row Means: ret[i] is the mean of row i of `m`.
+ */
+template <typename T>
+void RowMeans(T* ret, const MatrixView<T>& m) {
+  static_assert(std::is_floating_point_v<T>, "means need floating point");
+  RowSums(ret, m);
+  T scale = T(1) / m.cols();
+  for (size_t i = 0; i < m.rows(); ++i) ret[i] *= scale;
+}
+
+/**
+ * Row Minima. NaN are skipped; empty rows give +infinity.
+ */
+template <typename T>
+void RowMins(T* ret, const MatrixView<T>& m) {
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < m.rows(); ++i) {
+      ret[i] = detail::RowMin(m[i], m.cols());
+    }
+  });
+}
+
+/**
+ * Row Maxima. NaN are skipped; empty rows give -infinity.
+ */
+template <typename T>
+void RowMaxs(T* ret, const MatrixView<T>& m) {
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < m.rows(); ++i) {
+      ret[i] = detail::RowMax(m[i], m.cols());
+    }
+  });
+}
+
+/**
+ * Row Arguments of the Maxima: ret[i] is the first column
+ * holding the maximum of row i. NaN are skipped.
+ */
+template <typename T>
+void RowArgMaxs(size_t* ret, const MatrixView<T>& m) {
+  detail::Dispatch([&] {
+    for (size_t i = 0; i < m.rows(); ++i) {
+      const T* row = m[i];
+      T max = detail::RowMax(row, m.cols());
+      size_t j = 0;
+      while (j < m.cols() && !(row[j] == max)) ++j;
+      ret[i] = j < m.cols() ? j : 0;
+    }
+  });
+}
+
+/**
+ * Column Sums: ret[j] is the sum of column j of `m`.
+ *
+ * Columns are reduced by strips, walking the rows of the strip,
+ * rather than one column at a time.
+ */
+template <typename T>
+void ColSums(T* ret, const MatrixView<T>& m) {
+  std::fill(ret, ret + m.cols(), T(0));
+  detail::Dispatch([&] { detail::AddColumns(ret, m); });
+}
+
+/**
+ * Column Means: ret[j] is the mean of column j of `m`.
+ */
+template <typename T>
+void ColMeans(T* ret, const MatrixView<T>& m) {
+  static_assert(std::is_floating_point_v<T>, "means need floating point");
+  ColSums(ret, m);
+  T scale = T(1) / m.rows();
+  for (size_t j = 0; j < m.cols(); ++j) ret[j] *= scale;
+}
+
+/**
+ * Column Minima. NaN are skipped; empty columns give +infinity.
+ */
+template <typename T>
+void ColMins(T* ret, const MatrixView<T>& m) {
+  std::fill(ret, ret + m.cols(), detail::MinIdentity<T>());
+  detail::Dispatch([&] { detail::MinColumns(ret, m); });
+}
+
+/**
+ * Column Maxima. NaN are skipped; empty columns give -infinity.
+ */
+template <typename T>
+void ColMaxs(T* ret, const MatrixView<T>& m) {
+  detail::Workspace<size_t> argMaxs(m.cols());
+  std::fill(ret, ret + m.cols(), detail::MaxIdentity<T>());
+  detail::Dispatch([&] { detail::MaxColumns(ret, argMaxs.data(), m, 0); });
+}
+
+/**
+ * Column Arguments of the Maxima: ret[j] is the first row
+ * holding the maximum of column j. NaN are skipped.
+ */
+template <typename T>
+void ColArgMaxs(size_t* ret, const MatrixView<T>& m) {
+  detail::Workspace<T> maxs(m.cols());
+  std::fill(maxs.begin(), maxs.end(), detail::MaxIdentity<T>());
+  std::fill(ret, ret + m.cols(), size_t(0));
+  detail::Dispatch([&] { detail::MaxColumns(maxs.data(), ret, m, 0); });
+}
+
+/**
+ * Row Sums (with thread-level parallelism).
+ *
+ * Threads reduce disjoint row blocks; same result as `RowSums`.
+ */
+template <typename T>
+void RowSums_t(T* ret, const MatrixView<T>& m) {
+  detail::ForRowBlocks_t(m, [&](size_t, const MatrixView<T>& rows,
+                                size_t lo) { RowSums(ret + lo, rows); });
+}
+
+/**
+ * Row Means (with thread-level parallelism).
+ */
+template <typename T>
+void RowMeans_t(T* ret, const MatrixView<T>& m) {
+  detail::ForRowBlocks_t(m, [&](size_t, const MatrixView<T>& rows,
+                                size_t lo) { RowMeans(ret + lo, rows); });
+}
+
+/**
+ * Row Minima (with thread-level parallelism).
+ */
+template <typename T>
+void RowMins_t(T* ret, const MatrixView<T>& m) {
+  detail::ForRowBlocks_t(m, [&](size_t, const MatrixView<T>& rows,
+                                size_t lo) { RowMins(ret + lo, rows); });
+}
+
+/**
+ * Row Maxima (with thread-level parallelism).
+ */
+template <typename T>
+void RowMaxs_t(T* ret, const MatrixView<T>& m) {
+  detail::ForRowBlocks_t(m, [&](size_t, const MatrixView<T>& rows,
+                                size_t lo) { RowMaxs(ret + lo, rows); });
+}
+
+/**
+ * Row Arguments of the Maxima (with thread-level parallelism).
+ */
+template <typename T>
+void RowArgMaxs_t(size_t* ret, const MatrixView<T>& m) {
+  detail::ForRowBlocks_t(m, [&](size_t, const MatrixView<T>& rows,
+                                size_t lo) { RowArgMaxs(ret + lo, rows); });
+}
+
+/**
+ * Column Sums (with thread-level parallelism).
+ *
+ * Each thread reduces a row block into its own partial sums,
+ * which are then added in thread order,
+ * so the result only depends on the number of threads.
+ */
+template <typename T>
+void ColSums_t(T* ret, const MatrixView<T>& m) {
+  size_t cols = m.cols();
+  detail::Workspace<T> partials(detail::MaxThreads() * cols);
+  std::fill(partials.begin(), partials.end(), T(0));
+  detail::ForRowBlocks_t(
+      m, [&](size_t block, const MatrixView<T>& rows, size_t) {
+        detail::Dispatch(
+            [&] { detail::AddColumns(partials.data() + block * cols, rows); });
+      });
+  std::fill(ret, ret + cols, T(0));
+  for (size_t b = 0; b < detail::MaxThreads(); ++b) {
+    for (size_t j = 0; j < cols; ++j) ret[j] += partials[b * cols + j];
+  }
+}
+
+/**
+ * Column Means (with thread-level parallelism).
+ */
+template <typename T>
+void ColMeans_t(T* ret, const MatrixView<T>& m) {
+  static_assert(std::is_floating_point_v<T>, "means need floating point");
+  ColSums_t(ret, m);
+  T scale = T(1) / m.rows();
+  for (size_t j = 0; j < m.cols(); ++j) ret[j] *= scale;
+}
+
+/**
+ * Column Minima (with thread-level parallelism).
+ */
+template <typename T>
+void ColMins_t(T* ret, const MatrixView<T>& m) {
+  size_t cols = m.cols();
+  detail::Workspace<T> partials(detail::MaxThreads() * cols);
+  std::fill(partials.begin(), partials.end(), detail::MinIdentity<T>());
+  detail::ForRowBlocks_t(
+      m, [&](size_t block, const MatrixView<T>& rows, size_t) {
+        detail::Dispatch(
+            [&] { detail::MinColumns(partials.data() + block * cols, rows); });
+      });
+  std::fill(ret, ret + cols, detail::MinIdentity<T>());
+  for (size_t b = 0; b < detail::MaxThreads(); ++b) {
+    for (size_t j = 0; j < cols; ++j) {
+      ret[j] = std::min(ret[j], partials[b * cols + j]);
+    }
+  }
+}
+
+namespace detail {
+
+/**
+ * Column maxima and their first rows (with thread-level parallelism).
+ * Blocks are merged in row order, so ties keep the first row.
+ */
+template <typename T>
+void MaxColumns_t(T* maxs, size_t* argMaxs, const MatrixView<T>& m) {
+  size_t cols = m.cols();
+  Workspace<T> partials(MaxThreads() * cols);
+  Workspace<size_t> partialArgs(MaxThreads() * cols);
+  std::fill(partials.begin(), partials.end(), MaxIdentity<T>());
+  std::fill(partialArgs.begin(), partialArgs.end(), size_t(0));
+  ForRowBlocks_t(m, [&](size_t block, const MatrixView<T>& rows, size_t lo) {
+    Dispatch([&] {
+      MaxColumns(partials.data() + block * cols,
+                 partialArgs.data() + block * cols, rows, lo);
+    });
+  });
+  std::fill(maxs, maxs + cols, MaxIdentity<T>());
+  std::fill(argMaxs, argMaxs + cols, size_t(0));
+  for (size_t b = 0; b < MaxThreads(); ++b) {
+    for (size_t j = 0; j < cols; ++j) {
+      if (partials[b * cols + j] > maxs[j]) {
+        maxs[j] = partials[b * cols + j];
+        argMaxs[j] = partialArgs[b * cols + j];
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Column Maxima (with thread-level parallelism).
+ */
+template <typename T>
+void ColMaxs_t(T* ret, const MatrixView<T>& m) {
+  detail::Workspace<size_t> argMaxs(m.cols());
+  detail::MaxColumns_t(ret, argMaxs.data(), m);
+}
+
+/**
+ * Column Arguments of the Maxima (with thread-level parallelism).
+ */
+template <typename T>
+void ColArgMaxs_t(size_t* ret, const MatrixView<T>& m) {
+  detail::Workspace<T> maxs(m.cols());
+  detail::MaxColumns_t(maxs.data(), ret, m);
+}
+
+/**
+ * Running column reductions of a matrix that arrives in row chunks,
+ * e.g., from a file, so that it never needs to be in memory at once.
+ *
+ * Each chunk is reduced in one pass for all the statistics.
+ */
+template <typename T>
+class ColumnStats {
+ public:
+  explicit ColumnStats(size_t cols)
+      : sums_(cols, T(0)),
+        mins_(cols, detail::MinIdentity<T>()),
+        maxs_(cols, detail::MaxIdentity<T>()),
+        argMaxs_(cols, 0) {}
+
+  /**
+   * Adds the rows of `chunk`, which follow those added before.
+   */
+  void Add(const MatrixView<T>& chunk) {
+    if (chunk.cols() != cols()) {
+      throw std::invalid_argument("chunk of " + std::to_string(chunk.cols()) +
+                                  " columns instead of " +
+                                  std::to_string(cols()));
+    }
+    T* sums = sums_.data();
+    T* mins = mins_.data();
+    T* maxs = maxs_.data();
+    size_t* argMaxs = argMaxs_.data();
+    size_t first = rows_;
+    detail::Dispatch([&] {
+      detail::ForColumnStrips(
+          chunk, [&](size_t i, const T* row, size_t j0, size_t j1) {
+            for (size_t j = j0; j < j1; ++j) {
+              sums[j] += row[j];
+              mins[j] = std::min(mins[j], row[j]);
+              bool greater = row[j] > maxs[j];
+              maxs[j] = greater ? row[j] : maxs[j];
+              argMaxs[j] = greater ? first + i : argMaxs[j];
+            }
+          });
+    });
+    rows_ += chunk.rows();
+  }
+
+  [[nodiscard]] size_t rows() const noexcept { return rows_; }
+  [[nodiscard]] size_t cols() const noexcept { return sums_.size(); }
+
+  [[nodiscard]] const std::vector<T>& sums() const noexcept { return sums_; }
+  [[nodiscard]] const std::vector<T>& mins() const noexcept { return mins_; }
+  [[nodiscard]] const std::vector<T>& maxs() const noexcept { return maxs_; }
+
+  /**
+   * Returns the first row of the maximum of each column.
+   */
+  [[nodiscard]] const std::vector<size_t>& argMaxs() const noexcept {
+    return argMaxs_;
+  }
+
+  [[nodiscard]] std::vector<T> Means() const {
+    static_assert(std::is_floating_point_v<T>, "means need floating point");
+    std::vector<T> ret(sums_);
+    for (T& x : ret) x /= rows_;
+    return ret;
+  }
+
+ private:
+  std::vector<T> sums_;
+  std::vector<T> mins_;
+  std::vector<T> maxs_;
+  std::vector<size_t> argMaxs_;
+  size_t rows_ = 0;
+};
+
+/**
+ * Streams a matrix stored in a binary file, row-major,
+ * with `cols` elements of type T per row and no header.
+ *
+ * Calls `f(chunk, firstRow)` on views of up to `chunkRows` rows,
+ * in order; 0 picks chunks of about 4 MiB.
+ * The next chunk is read asynchronously while `f` runs,
+ * so only two chunks are in memory at any time.
+ * Returns the number of rows.
+ */
+template <typename T, typename F>
+size_t ForEachRowChunk(const std::string& path, size_t cols,
+                       size_t chunkRows, F&& f) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "files hold trivially copyable elements");
+  size_t rowBytes = cols * sizeof(T);
+  size_t bytes = std::filesystem::file_size(path);
+  if (cols == 0 || bytes % rowBytes != 0) {
+    throw std::invalid_argument(path + " is not a matrix of " +
+                                std::to_string(cols) + " columns");
+  }
+  size_t rows = bytes / rowBytes;
+  if (chunkRows == 0) {
+    chunkRows = std::max<size_t>(1, (size_t(4) << 20) / rowBytes);
+  }
+  chunkRows = std::min(chunkRows, std::max<size_t>(rows, 1));
+
+  detail::BinaryFile file(path, "rb");
+  detail::Workspace<T> buffers[2];
+  for (auto& b : buffers) b.resize(chunkRows * cols);
+  ThreadPool io(2, false);
+  auto read = [&](int b) {
+    T* data = buffers[b].data();
+    size_t n = buffers[b].size();
+    detail::BinaryFile* in = &file;
+    return Async(io, {Access::Write(data, n)},
+                 [in, data, n] { return in->Read(data, n); });
+  };
+
+  Future<size_t> pending;
+  if (rows > 0) pending = read(0);
+  try {
+    for (size_t row = 0, current = 0; row < rows; current = 1 - current) {
+      size_t n = pending.get() / cols;
+      if (n == 0) throw std::runtime_error(path + " is shorter than expected");
+      if (row + n < rows) pending = read(1 - current);
+      f(MatrixView<T>(buffers[current].data(), n, cols, cols), row);
+      row += n;
+    }
+  } catch (...) {
+    if (pending.valid()) pending.wait();
+    throw;
+  }
+  return rows;
+}
+
+/**
+ * Reduces the columns of a matrix file (see `ForEachRowChunk`)
+ * without loading it whole.
+ */
+template <typename T>
+ColumnStats<T> ReduceColumns(const std::string& path, size_t cols,
+                             size_t chunkRows = 0) {
+  ColumnStats<T> stats(cols);
+  ForEachRowChunk<T>(path, cols, chunkRows,
+                     [&](const MatrixView<T>& chunk, size_t) {
+                       stats.Add(chunk);
+                     });
+  return stats;
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_REDUCE_HPP_
@@ -0,0 +1,252 @@
+#ifndef HPC_TUTOR_ROOFLINE_HPP_
+#define HPC_TUTOR_ROOFLINE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tutor {
+
+/**
+ * Sustained bandwidth of a kernel over a working set of a given size.
+ */
+struct BandwidthSample {
+  size_t threads = 1;
+  size_t bytes = 0;            ///< Working set of all threads.
+  double bytesPerSecond = 0;
+};
+
+/**
+ * Result of a STREAM kernel (copy, scale, add or triad) over arrays
+ * much larger than the caches, with the threads bound to a NUMA node,
+ * or to no node in particular if `node` is -1.
+ */
+struct StreamSample {
+  std::string kernel;
+  int node = -1;
+  size_t threads = 1;
+  double bytesPerSecond = 0;
+};
+
+/**
+ * HPC Tutor Roofline.
+ *
+ * Ceilings of the machine as measured by the calibration program
+ * (test/calibration.cpp): peak double precision FLOP/s per thread count,
+ * and the read bandwidth of working sets from L1 up to memory.
+ * A kernel that does `flops` operations on `bytes` of data
+ * cannot take less than max(flops / peak, bytes / bandwidth),
+ * where the bandwidth is that of the cache level holding its working set.
+ *
+ * Profiles are line-based text: a keyword and its values.
+ *
+ *     peak <threads> <flop/s>
+ *     bandwidth <threads> <working set bytes> <bytes/s>
+ *     stream <kernel> <node> <threads> <bytes/s>
+ *
+ * '#' starts a comment; unknown keywords are skipped,
+ * so profiles can carry notes for the reader.
+ */
+class Roofline {
+ public:
+  /**
+   * Returns the profile named by the environment variable
+   * `HPC_TUTOR_ROOFLINE`, or "roofline.txt" in the working directory.
+   * The roofline is empty if the file does not exist.
+   */
+  static Roofline Load() {
+    const char* env = std::getenv("HPC_TUTOR_ROOFLINE");
+    std::ifstream file(env != nullptr ? env : "roofline.txt");
+    if (!file) return Roofline();
+    return Read(file);
+  }
+
+  /**
+   * Parses a profile. Throws `std::invalid_argument` on malformed lines.
+   */
+  static Roofline Read(std::istream& is) {
+    Roofline ret;
+    std::string line;
+    for (size_t number = 1; std::getline(is, line); ++number) {
+      line = line.substr(0, line.find('#'));
+      std::istringstream fields(line);
+      std::string key;
+      if (!(fields >> key)) continue;
+      bool ok = true;
+      if (key == "peak") {
+        size_t threads = 0;
+        double flops = 0;
+        ok = static_cast<bool>(fields >> threads >> flops);
+        if (ok) ret.SetPeak(threads, flops);
+      } else if (key == "bandwidth") {
+        BandwidthSample s;
+        ok = static_cast<bool>(fields >> s.threads >> s.bytes >>
+                               s.bytesPerSecond);
+        if (ok) ret.Add(s);
+      } else if (key == "stream") {
+        StreamSample s;
+        ok = static_cast<bool>(fields >> s.kernel >> s.node >> s.threads >>
+                               s.bytesPerSecond);
+        if (ok) ret.Add(s);
+      }
+      if (!ok) {
+        throw std::invalid_argument("roofline line " +
+                                    std::to_string(number) + ": " + line);
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * Reads the profile in the file `path`.
+   */
+  static Roofline Read(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    return Read(file);
+  }
+
+  void Write(std::ostream& os) const {
+    // Round trips: 17 significant digits, enough for any double.
+    auto precision = os.precision(17);
+    for (const auto& [threads, flops] : peaks_) {
+      os << "peak " << threads << " " << flops << "\n";
+    }
+    for (const auto& s : bandwidths_) {
+      os << "bandwidth " << s.threads << " " << s.bytes << " "
+         << s.bytesPerSecond << "\n";
+    }
+    for (const auto& s : streams_) {
+      os << "stream " << s.kernel << " " << s.node << " " << s.threads << " "
+         << s.bytesPerSecond << "\n";
+    }
+    os.precision(precision);
+  }
+
+  void Write(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    Write(file);
+    if (!file) throw std::runtime_error("cannot write " + path);
+  }
+
+  /**
+   * Returns whether the roofline has both a compute and a memory ceiling.
+   */
+  [[nodiscard]] bool empty() const {
+    return peaks_.empty() || bandwidths_.empty();
+  }
+
+  void SetPeak(size_t threads, double flops) {
+    for (auto& peak : peaks_) {
+      if (peak.first == threads) {
+        peak.second = flops;
+        return;
+      }
+    }
+    peaks_.emplace_back(threads, flops);
+    std::sort(peaks_.begin(), peaks_.end());
+  }
+
+  void Add(const BandwidthSample& sample) {
+    bandwidths_.push_back(sample);
+    std::sort(bandwidths_.begin(), bandwidths_.end(),
+              [](const BandwidthSample& a, const BandwidthSample& b) {
+                return a.threads != b.threads ? a.threads < b.threads
+                                              : a.bytes < b.bytes;
+              });
+  }
+
+  void Add(const StreamSample& sample) { streams_.push_back(sample); }
+
+  /**
+   * Returns the peak FLOP/s of `threads` threads.
+   *
+   * Counts without a measurement use the largest measured count below,
+   * scaled by the ratio of thread counts; 0 if there is none.
+   */
+  [[nodiscard]] double Peak(size_t threads) const {
+    double ret = 0;
+    for (const auto& [t, flops] : peaks_) {
+      if (t == threads) return flops;
+      if (t < threads) ret = flops * threads / t;
+    }
+    return ret;
+  }
+
+  /**
+   * Returns the read bandwidth of `threads` threads
+   * over a working set of `bytes`.
+   *
+   * Bandwidth cannot grow with the working set, so it is the best
+   * of the samples holding `bytes`, which smooths out noisy samples,
+   * or the last sample if `bytes` is larger than every sample.
+   * Samples come from the largest thread count not above `threads`,
+   * or the smallest one. Returns 0 if there is no sample.
+   */
+  [[nodiscard]] double Bandwidth(size_t threads, size_t bytes) const {
+    size_t measured = 0;
+    for (const auto& s : bandwidths_) {
+      if (s.threads <= threads) measured = s.threads;
+    }
+    if (measured == 0 && !bandwidths_.empty()) {
+      measured = bandwidths_.front().threads;
+    }
+    double ret = 0, last = 0;
+    for (const auto& s : bandwidths_) {
+      if (s.threads != measured) continue;
+      last = s.bytesPerSecond;
+      if (s.bytes >= bytes) ret = std::max(ret, s.bytesPerSecond);
+    }
+    return ret > 0 ? ret : last;
+  }
+
+  /**
+   * Returns the shortest time, in seconds, in which `threads` threads
+   * can do `flops` operations reading `bytes` from a working set
+   * of `workingSet` bytes.
+   */
+  [[nodiscard]] double MinSeconds(size_t threads, double flops, double bytes,
+                                  size_t workingSet) const {
+    double peak = Peak(threads), bandwidth = Bandwidth(threads, workingSet);
+    double compute = peak > 0 ? flops / peak : 0;
+    double memory = bandwidth > 0 ? bytes / bandwidth : 0;
+    return std::max(compute, memory);
+  }
+
+  /**
+   * Returns whether the kernel of `MinSeconds` is bound by bandwidth
+   * rather than by compute.
+   */
+  [[nodiscard]] bool BandwidthBound(size_t threads, double flops,
+                                    double bytes, size_t workingSet) const {
+    return bytes * Peak(threads) > flops * Bandwidth(threads, workingSet);
+  }
+
+  [[nodiscard]] const std::vector<std::pair<size_t, double>>& peaks() const {
+    return peaks_;
+  }
+  [[nodiscard]] const std::vector<BandwidthSample>& bandwidths() const {
+    return bandwidths_;
+  }
+  [[nodiscard]] const std::vector<StreamSample>& streams() const {
+    return streams_;
+  }
+
+ private:
+  std::vector<std::pair<size_t, double>> peaks_;  ///< By thread count.
+  std::vector<BandwidthSample> bandwidths_;  ///< By threads, then bytes.
+  std::vector<StreamSample> streams_;
+};
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_ROOFLINE_HPP_
@@ -0,0 +1,328 @@
+#ifndef HPC_TUTOR_TASK_GRAPH_HPP_
+#define HPC_TUTOR_TASK_GRAPH_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "async.hpp"
+#include "linalg.hpp"
+#include "matrix_view.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+namespace tutor {
+
+/**
+ * HPC Tutor Task Graph.
+ *
+ * TaskGraph is a dataflow runtime for tiled algorithms.
+ * Tasks are added in sequential program order
+ * together with the tiles they read and write,
+ * in the spirit of OpenMP `depend` clauses.
+ * The graph derives read-after-write, write-after-read
+ * and write-after-write dependencies from those accesses.
+ *
+ * Dependencies are tracked per region:
+ * two accesses refer to the same data if they describe the same region.
+ * This is the case for tiles of a fixed tiling,
+ * but partially overlapping regions are not detected;
+ * use `Depend` to order such tasks explicitly.
+ *
+ * `Run` executes the graph on a thread pool.
+ * Ready tasks are picked by their bottom level,
+ * the cost of the longest path from the task to the end of the graph,
+ * so the critical path advances as soon as possible.
+ */
+class TaskGraph {
+ public:
+  using TaskId = size_t;
+
+  /**
+   * Adds a task that runs `fn` and accesses the given regions.
+   *
+   * `cost` is an estimation of the run time of the task
+   * in arbitrary units, e.g., flops. It drives the priorities.
+   * `name` labels the task in traces (see `Tracer`);
+   * it must outlive the graph, e.g., a string literal.
+   */
+  TaskId Add(std::function<void()> fn, std::initializer_list<Access> accesses,
+             double cost = 1, const char* name = "task") {
+    TaskId id = tasks_.size();
+    tasks_.push_back(Task{std::move(fn), cost, {}, 0, 0, name});
+    for (const Access& a : accesses) {
+      RegionState& region = regions_[{a.begin, a.end}];
+      if (a.write) {
+        if (region.lastWriter != kNone) Depend(region.lastWriter, id);
+        for (TaskId r : region.readers) Depend(r, id);
+        region.readers.clear();
+        region.lastWriter = id;
+      } else {
+        if (region.lastWriter != kNone) Depend(region.lastWriter, id);
+        region.readers.push_back(id);
+      }
+    }
+    return id;
+  }
+
+  /**
+   * Makes task `after` wait for task `before`.
+   *
+   * Tasks can only depend on tasks added before them.
+   */
+  void Depend(TaskId before, TaskId after) {
+    if (before == after) return;
+    auto& succ = tasks_[before].successors;
+    if (!succ.empty() && succ.back() == after) return;
+    succ.push_back(after);
+    ++tasks_[after].numPredecessors;
+  }
+
+  /**
+   * Returns the number of tasks in the graph.
+   */
+  [[nodiscard]] size_t size() const noexcept { return tasks_.size(); }
+
+  /**
+   * Returns the priority of a task,
+   * which is valid after the first call to `Run`.
+   */
+  [[nodiscard]] double priority(TaskId id) const noexcept {
+    return tasks_[id].priority;
+  }
+
+  /**
+   * Executes all the tasks on `pool` and waits for them.
+   *
+   * The graph can be run again; each run executes every task once.
+   */
+  void Run(ThreadPool& pool = ThreadPool::Global()) {
+    size_t n = tasks_.size();
+    if (n == 0) return;
+    ComputePriorities();
+    std::vector<std::atomic<size_t>> pending(n);
+    ReadyQueue ready(*this);
+    for (TaskId id = 0; id < n; ++id) {
+      pending[id].store(tasks_[id].numPredecessors, std::memory_order_relaxed);
+      if (tasks_[id].numPredecessors == 0) ready.Push(id);
+    }
+    std::atomic<size_t> finished(0);
+    auto schedule = [&](size_t, size_t) {
+      while (finished.load(std::memory_order_acquire) != n) {
+        TaskId id;
+        if (!ready.Pop(id)) {
+          detail::CpuRelax();
+          continue;
+        }
+        {
+          HPC_TUTOR_TRACE_SCOPE(tasks_[id].name, static_cast<int64_t>(id));
+          tasks_[id].fn();
+        }
+        for (TaskId s : tasks_[id].successors) {
+          if (pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.Push(s);
+          }
+        }
+        finished.fetch_add(1, std::memory_order_release);
+      }
+    };
+    pool.ParallelFor(0, pool.size(), 1, schedule);
+  }
+
+ private:
+  static constexpr TaskId kNone = static_cast<TaskId>(-1);
+
+  struct Task {
+    std::function<void()> fn;
+    double cost;
+    std::vector<TaskId> successors;
+    size_t numPredecessors;
+    double priority;
+    const char* name;
+  };
+
+  struct RegionState {
+    TaskId lastWriter = kNone;
+    std::vector<TaskId> readers;
+  };
+
+  /**
+   * Max-heap of ready tasks ordered by priority.
+   */
+  class ReadyQueue {
+   public:
+    explicit ReadyQueue(const TaskGraph& graph) : graph_(graph) {}
+
+    void Push(TaskId id) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      heap_.push_back(id);
+      std::push_heap(heap_.begin(), heap_.end(), Less{&graph_});
+    }
+
+    bool Pop(TaskId& id) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (heap_.empty()) return false;
+      std::pop_heap(heap_.begin(), heap_.end(), Less{&graph_});
+      id = heap_.back();
+      heap_.pop_back();
+      return true;
+    }
+
+   private:
+    struct Less {
+      const TaskGraph* graph;
+      bool operator()(TaskId a, TaskId b) const {
+        double pa = graph->tasks_[a].priority;
+        double pb = graph->tasks_[b].priority;
+        // Among equal priorities, older tasks first.
+        return pa < pb || (pa == pb && a > b);
+      }
+    };
+
+    const TaskGraph& graph_;
+    std::mutex mutex_;
+    std::vector<TaskId> heap_;
+  };
+
+  /**
+   * Computes the bottom level of each task.
+   * Successors always have larger ids, so one reverse sweep suffices.
+   */
+  void ComputePriorities() {
+    for (size_t id = tasks_.size(); id-- > 0;) {
+      double longest = 0;
+      for (TaskId s : tasks_[id].successors) {
+        longest = std::max(longest, tasks_[s].priority);
+      }
+      tasks_[id].priority = tasks_[id].cost + longest;
+    }
+  }
+
+  std::vector<Task> tasks_;
+  std::map<std::pair<const char*, const char*>, RegionState> regions_;
+};
+
+/**
+ * LU Factorization Routine (block decomposition, dataflow execution).
+ *
+ * This functions must produce the same result
+ * and requires the same conditions as `LuFact`.
+ * The matrix is split in `bs` x `bs` tiles
+ * and every GETRF, TRSM and GEMM step on a tile becomes a task.
+ * Tasks run as soon as the tiles they need are ready,
+ * so panel factorizations overlap with trailing updates.
+ */
+template <typename T>
+void LuFact_bt(ThreadPool& pool, MatrixView<T> m, size_t bs) {
+  size_t nt = (m.rows() + bs - 1) / bs;
+  auto tile = [&](size_t i, size_t j) {
+    return m.view(i * bs, j * bs, std::min(bs, m.rows() - i * bs),
+                  std::min(bs, m.cols() - j * bs));
+  };
+  double b3 = static_cast<double>(bs) * bs * bs;
+  TaskGraph graph;
+  for (size_t k = 0; k < nt; ++k) {
+    auto akk = tile(k, k);
+    graph.Add([akk] { detail::TileGetrf(akk); }, {Access::Write(akk)},
+              2 * b3 / 3, "getrf");
+    for (size_t j = k + 1; j < nt; ++j) {
+      auto akj = tile(k, j);
+      graph.Add([akk, akj] { detail::TileTrsmLowerUnit(akk, akj); },
+                {Access::Read(akk), Access::Write(akj)}, b3, "trsm");
+    }
+    for (size_t i = k + 1; i < nt; ++i) {
+      auto aik = tile(i, k);
+      graph.Add([akk, aik] { detail::TileTrsmUpperRight(akk, aik); },
+                {Access::Read(akk), Access::Write(aik)}, b3, "trsm");
+    }
+    for (size_t i = k + 1; i < nt; ++i) {
+      for (size_t j = k + 1; j < nt; ++j) {
+        auto aij = tile(i, j), aik = tile(i, k), akj = tile(k, j);
+        graph.Add([aij, aik, akj] { detail::TileGemmSub(aij, aik, akj); },
+                  {Access::Read(aik), Access::Read(akj), Access::Write(aij)},
+                  2 * b3, "gemm");
+      }
+    }
+  }
+  graph.Run(pool);
+}
+
+/**
+ * LU Factorization Routine (dataflow execution on the global pool).
+ */
+template <typename T>
+void LuFact_bt(MatrixView<T> m, size_t bs) {
+  LuFact_bt(ThreadPool::Global(), m, bs);
+}
+
+/**
+ * LU Factorization Routine (asynchronous).
+ *
+ * Runs `LuFact_bt` on the global pool once the call runs.
+ */
+template <typename T>
+Future<void> LuFactAsync(MatrixView<T> m, size_t bs) {
+  auto& pool = ThreadPool::Global();
+  return Async(pool, {Access::Write(m)},
+               [&pool, m, bs] { LuFact_bt(pool, m, bs); });
+}
+
+/**
+ * Cholesky Factorization Routine (block decomposition, dataflow execution).
+ *
+ * Receives a symmetric positive definite matrix
+ * and overwrites its lower half, diagonal included,
+ * with the lower triangular matrix L such that A = L L^T.
+ * The strictly upper half is not accessed.
+ * Every POTRF, TRSM, SYRK and GEMM step on a tile becomes a task.
+ */
+template <typename T>
+void Cholesky_bt(ThreadPool& pool, MatrixView<T> m, size_t bs) {
+  size_t nt = (m.rows() + bs - 1) / bs;
+  auto tile = [&](size_t i, size_t j) {
+    return m.view(i * bs, j * bs, std::min(bs, m.rows() - i * bs),
+                  std::min(bs, m.cols() - j * bs));
+  };
+  double b3 = static_cast<double>(bs) * bs * bs;
+  TaskGraph graph;
+  for (size_t k = 0; k < nt; ++k) {
+    auto akk = tile(k, k);
+    graph.Add([akk] { detail::TilePotrf(akk); }, {Access::Write(akk)},
+              b3 / 3, "potrf");
+    for (size_t i = k + 1; i < nt; ++i) {
+      auto aik = tile(i, k);
+      graph.Add([akk, aik] { detail::TileTrsmLowerTransRight(akk, aik); },
+                {Access::Read(akk), Access::Write(aik)}, b3, "trsm");
+    }
+    for (size_t i = k + 1; i < nt; ++i) {
+      auto aii = tile(i, i), aik = tile(i, k);
+      graph.Add([aii, aik] { detail::TileSyrkSub(aii, aik); },
+                {Access::Read(aik), Access::Write(aii)}, b3, "syrk");
+      for (size_t j = k + 1; j < i; ++j) {
+        auto aij = tile(i, j), ajk = tile(j, k);
+        graph.Add([aij, aik, ajk] { detail::TileGemmSubTrans(aij, aik, ajk); },
+                  {Access::Read(aik), Access::Read(ajk), Access::Write(aij)},
+                  2 * b3, "gemm");
+      }
+    }
+  }
+  graph.Run(pool);
+}
+
+/**
+ * Cholesky Factorization Routine (dataflow execution on the global pool).
+ */
+template <typename T>
+void Cholesky_bt(MatrixView<T> m, size_t bs) {
+  Cholesky_bt(ThreadPool::Global(), m, bs);
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_TASK_GRAPH_HPP_
@@ -0,0 +1,622 @@
+#ifndef HPC_TUTOR_THREAD_POOL_HPP_
+#define HPC_TUTOR_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "trace.hpp"
+
+namespace tutor {
+
+namespace detail {
+
+/**
+ * Hints the processor that the thread is busy waiting.
+ */
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+/**
+ * Unit of work executed by the thread pool.
+ *
+ * Jobs are not owned by the pool.
+ * Whoever pushes a job must keep it alive until it has run.
+ */
+struct Job {
+  void (*run)(Job* self);
+};
+
+/**
+ * Chase–Lev Work-Stealing Deque.
+ *
+ * Only the owner thread may call `Push` and `Pop`,
+ * which operate on the bottom end of the deque.
+ * Any thread may call `Steal`, which takes jobs from the top end.
+ * The implementation follows the C11 formulation by Lê, Pop, Cohen
+ * and Zappa Nardelli ("Correct and Efficient Work-Stealing for Weak
+ * Memory Models", PPoPP 2013).
+ * Buffers replaced when the deque grows are retired, not freed,
+ * because a thief may still be reading them.
+ */
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity = 256)
+      : top_(0), bottom_(0), buffer_(new Buffer(capacity)) {
+    retired_.emplace_back(buffer_.load(std::memory_order_relaxed));
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  /**
+   * Pushes a job at the bottom. Owner only.
+   */
+  void Push(Job* job) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Buffer* buf = buffer_.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(buf->capacity) - 1) {
+      buf = Grow(buf, t, b);
+    }
+    buf->Put(b, job);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  /**
+   * Pops a job from the bottom. Owner only.
+   * Returns nullptr if the deque is empty.
+   */
+  Job* Pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buf = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Job* job = buf->Get(b);
+    if (t == b) {
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        job = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  /**
+   * Steals a job from the top. Any thread.
+   * Returns nullptr if the deque is empty or the race was lost.
+   */
+  Job* Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    Buffer* buf = buffer_.load(std::memory_order_consume);
+    Job* job = buf->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return job;
+  }
+
+  /**
+   * Returns true if the deque looked empty at the time of the call.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return top_.load(std::memory_order_relaxed) >=
+           bottom_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Buffer {
+    explicit Buffer(size_t cap)
+        : capacity(cap), mask(cap - 1), slots(new std::atomic<Job*>[cap]) {}
+    Job* Get(int64_t i) const noexcept {
+      return slots[i & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, Job* job) noexcept {
+      slots[i & mask].store(job, std::memory_order_relaxed);
+    }
+    size_t capacity;
+    size_t mask;
+    std::unique_ptr<std::atomic<Job*>[]> slots;
+  };
+
+  Buffer* Grow(Buffer* old, int64_t t, int64_t b) {
+    Buffer* buf = new Buffer(old->capacity * 2);
+    for (int64_t i = t; i < b; ++i) buf->Put(i, old->Get(i));
+    retired_.emplace_back(buf);
+    buffer_.store(buf, std::memory_order_release);
+    return buf;
+  }
+
+  alignas(64) std::atomic<int64_t> top_;
+  alignas(64) std::atomic<int64_t> bottom_;
+  std::atomic<Buffer*> buffer_;
+  std::vector<std::unique_ptr<Buffer>> retired_;
+};
+
+}  // namespace detail
+
+/**
+ * HPC Tutor Thread Pool.
+ *
+ * ThreadPool is a persistent pool of worker threads
+ * meant to lower the latency of small parallel calls,
+ * where the fork/join overhead of a fresh OpenMP region dominates.
+ *
+ * Each worker owns a Chase–Lev deque.
+ * Idle workers steal from the others,
+ * spin for a short while and then park on a condition variable.
+ * The thread that calls `ParallelFor` takes part in the computation
+ * through its own deque slot, so a pool of size p uses p - 1 workers.
+ * Workers can optionally be pinned, each to one of the CPUs
+ * the process is allowed to run on.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Number of failed attempts to find work before a worker parks.
+   */
+  static constexpr size_t kSpinIterations = 4096;
+
+  /**
+   * Constructs a pool that runs parallel loops with `numThreads` threads,
+   * counting the calling thread.
+   *
+   * With `pin`, worker i is bound to the i-th CPU of the affinity mask
+   * of the constructing thread. Only pin when the process owns those
+   * CPUs: several pinned pools, e.g., one per MPI rank on a node,
+   * would share the same CPUs.
+   */
+  explicit ThreadPool(size_t numThreads = DefaultThreads(), bool pin = false)
+      : numThreads_(std::max<size_t>(numThreads, 1)),
+        deques_(numThreads_),
+        serialThreshold_(kDefaultSerialThreshold) {
+    for (auto& dq : deques_) dq = std::make_unique<detail::WorkStealingDeque>();
+    workers_.reserve(numThreads_ - 1);
+    for (size_t i = 1; i < numThreads_; ++i) {
+      workers_.emplace_back([this, i, pin] { WorkerLoop(i, pin); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Destructor.
+   *
+   * Wakes up and joins all the workers.
+   * Pending jobs must have completed before the pool is destroyed.
+   */
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      stop_ = true;
+      ++epoch_;
+    }
+    sleepCv_.notify_all();
+    for (auto& w : workers_) w.join();
+  }
+
+  /**
+   * Returns the process-wide pool.
+   *
+   * The number of threads can be set with the environment variable
+   * `HPC_TUTOR_NUM_THREADS`. It defaults to the hardware concurrency,
+   * but it is never less than two, so that there is always a worker
+   * to make progress on submitted jobs.
+   * Its workers are not pinned: other pools, OpenMP or other processes
+   * may run on the same CPUs.
+   */
+  static ThreadPool& Global() {
+    static ThreadPool pool(std::max<size_t>(DefaultThreads(), 2), false);
+    return pool;
+  }
+
+  /**
+   * Returns the number of threads that take part in a parallel loop.
+   */
+  [[nodiscard]] size_t size() const noexcept { return numThreads_; }
+
+  /**
+   * Returns the amount of work units below which loops run serially.
+   */
+  [[nodiscard]] size_t serialThreshold() const noexcept {
+    return serialThreshold_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Sets the amount of work units below which loops run serially.
+   */
+  void SetSerialThreshold(size_t work) noexcept {
+    serialThreshold_.store(work, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns true if `work` units are worth running in parallel.
+   *
+   * A work unit is roughly the cost of streaming one element from memory,
+   * e.g., a multiply-add in `MatrixEval` or a comparison in `Find`.
+   */
+  [[nodiscard]] bool ShouldParallelize(size_t work) const noexcept {
+    return numThreads_ > 1 && work >= serialThreshold();
+  }
+
+  /**
+   * Measures the fork/join latency of the pool
+   * and the serial cost of a streaming work unit,
+   * and sets the serial threshold to the amount of work
+   * that takes `factor` times as long as an empty parallel loop.
+   * Returns the new threshold.
+   */
+  size_t Calibrate(double factor = 4) {
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t kReps = 200;
+    constexpr size_t kElems = size_t(1) << 16;
+    ParallelFor(0, numThreads_, 1, [](size_t, size_t) {});
+    auto t0 = Clock::now();
+    for (size_t r = 0; r < kReps; ++r) {
+      ParallelFor(0, numThreads_, 1, [](size_t, size_t) {});
+    }
+    double forkJoin = std::chrono::duration<double>(Clock::now() - t0).count();
+    forkJoin /= kReps;
+    std::vector<double> data(kElems, 1.0);
+    volatile double sink = 0;
+    t0 = Clock::now();
+    for (size_t r = 0; r < 8; ++r) {
+      double sum = 0;
+      for (size_t i = 0; i < kElems; ++i) sum += data[i] * data[i];
+      sink = sink + sum;
+    }
+    double perUnit = std::chrono::duration<double>(Clock::now() - t0).count();
+    perUnit /= 8 * kElems;
+    size_t threshold = static_cast<size_t>(factor * forkJoin / perUnit);
+    SetSerialThreshold(threshold);
+    return threshold;
+  }
+
+  /**
+   * Parallel Loop.
+   *
+   * Calls `f(lo, hi)` over disjoint sub-ranges covering [begin, end).
+   * Sub-ranges have at most `grain` elements, unless `grain` is 0,
+   * in which case the range is split into a few chunks per thread.
+   * The call returns once every sub-range has been processed.
+   *
+   * If another external thread is already running a loop on the pool,
+   * the range is processed serially by the caller.
+   */
+  template <typename F>
+  void ParallelFor(size_t begin, size_t end, size_t grain, F&& f) {
+    if (begin >= end) return;
+    size_t n = end - begin;
+    if (grain == 0) grain = std::max<size_t>(1, n / (4 * numThreads_));
+    if (numThreads_ == 1 || n <= grain) {
+      f(begin, end);
+      return;
+    }
+    size_t slot = CurrentSlot();
+    std::unique_lock<std::mutex> callerLock;
+    if (slot == kNoSlot) {
+      callerLock = std::unique_lock<std::mutex>(callerMutex_, std::try_to_lock);
+      if (!callerLock.owns_lock()) {
+        f(begin, end);
+        return;
+      }
+      slot = 0;
+    }
+    using Fn = std::remove_reference_t<F>;
+    LoopState state;
+    state.pool = this;
+    state.ctx = const_cast<void*>(static_cast<const void*>(&f));
+    state.body = [](void* ctx, size_t lo, size_t hi) {
+      (*static_cast<Fn*>(ctx))(lo, hi);
+    };
+    state.grain = grain;
+    state.remaining.store(n, std::memory_order_relaxed);
+    state.jobs.resize(2 * ((n + grain - 1) / grain) + 1);
+    state.next.store(1, std::memory_order_relaxed);
+    state.jobs[0] = RangeJob{{&RangeJob::Run}, &state, begin, end};
+    SlotGuard guard(this, slot);
+    RangeJob::Run(&state.jobs[0].base);
+    while (state.remaining.load(std::memory_order_acquire) != 0) {
+      if (detail::Job* job = FindJob(slot)) {
+        job->run(job);
+      } else {
+        detail::CpuRelax();
+      }
+    }
+  }
+
+  /**
+   * Pushes a job to the pool.
+   *
+   * The job runs asynchronously in some worker.
+   * The pointed job must stay alive until it has run.
+   * A pool of size 1 has no workers,
+   * so its jobs only run while some thread calls `HelpUntil`.
+   */
+  void Submit(detail::Job* job) {
+    size_t slot = CurrentSlot();
+    if (slot != kNoSlot) {
+      deques_[slot]->Push(job);
+    } else {
+      std::lock_guard<std::mutex> lock(injectMutex_);
+      injected_.push_back(job);
+      injectedCount_.fetch_add(1, std::memory_order_release);
+    }
+    Notify();
+  }
+
+  /**
+   * Runs pending jobs from the calling thread until `done()` holds.
+   *
+   * Used to wait for submitted work without blocking a worker.
+   */
+  template <typename Pred>
+  void HelpUntil(Pred&& done) {
+    size_t slot = CurrentSlot();
+    size_t idle = 0;
+    while (!done()) {
+      detail::Job* job = slot != kNoSlot ? FindJob(slot) : StealAny(kNoSlot);
+      if (job == nullptr) job = TakeInjected();
+      if (job != nullptr) {
+        job->run(job);
+        idle = 0;
+      } else if (++idle < kSpinIterations) {
+        detail::CpuRelax();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kNoSlot = static_cast<size_t>(-1);
+  static constexpr size_t kDefaultSerialThreshold = size_t(1) << 15;
+
+  struct LoopState;
+
+  struct RangeJob {
+    detail::Job base;
+    LoopState* state;
+    size_t lo;
+    size_t hi;
+
+    static void Run(detail::Job* job) {
+      auto* self = reinterpret_cast<RangeJob*>(job);
+      LoopState* st = self->state;
+      ThreadPool* pool = st->pool;
+      size_t slot = pool->CurrentSlot();
+      size_t lo = self->lo, hi = self->hi;
+      // Lazy binary splitting: publish the right halves for thieves.
+      // Threads without a slot (helping from outside) run it whole.
+      while (slot != kNoSlot && hi - lo > st->grain) {
+        size_t mid = lo + (hi - lo) / 2;
+        RangeJob& right =
+            st->jobs[st->next.fetch_add(1, std::memory_order_relaxed)];
+        right = RangeJob{{&RangeJob::Run}, st, mid, hi};
+        pool->deques_[slot]->Push(&right.base);
+        pool->Notify();
+        hi = mid;
+      }
+      {
+        HPC_TUTOR_TRACE_SCOPE("ParallelFor", static_cast<int64_t>(lo));
+        st->body(st->ctx, lo, hi);
+      }
+      st->remaining.fetch_sub(hi - lo, std::memory_order_acq_rel);
+    }
+  };
+
+  struct LoopState {
+    ThreadPool* pool;
+    void* ctx;
+    void (*body)(void*, size_t, size_t);
+    size_t grain;
+    std::atomic<size_t> remaining;
+    std::atomic<size_t> next;
+    std::vector<RangeJob> jobs;
+  };
+
+  /**
+   * Binds the calling thread to a slot of this pool for a scope.
+   */
+  class SlotGuard {
+   public:
+    SlotGuard(ThreadPool* pool, size_t slot)
+        : oldPool_(CurrentPool()), oldSlot_(SlotRef()) {
+      CurrentPool() = pool;
+      SlotRef() = slot;
+    }
+    ~SlotGuard() {
+      CurrentPool() = oldPool_;
+      SlotRef() = oldSlot_;
+    }
+
+   private:
+    ThreadPool* oldPool_;
+    size_t oldSlot_;
+  };
+
+  static size_t DefaultThreads() {
+    if (const char* env = std::getenv("HPC_TUTOR_NUM_THREADS")) {
+      size_t n = std::strtoul(env, nullptr, 10);
+      if (n > 0) return n;
+    }
+    return std::max<unsigned>(1, std::thread::hardware_concurrency());
+  }
+
+  static ThreadPool*& CurrentPool() {
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static size_t& SlotRef() {
+    static thread_local size_t slot = kNoSlot;
+    return slot;
+  }
+
+  /**
+   * Returns the slot of the calling thread in this pool, if any.
+   */
+  size_t CurrentSlot() const {
+    return CurrentPool() == this ? SlotRef() : kNoSlot;
+  }
+
+  detail::Job* StealAny(size_t self) {
+    size_t start = self + 1;
+    for (size_t k = 0; k < numThreads_; ++k) {
+      size_t victim = (start + k) % numThreads_;
+      if (victim == self) continue;
+      if (detail::Job* job = deques_[victim]->Steal()) return job;
+    }
+    return nullptr;
+  }
+
+  detail::Job* TakeInjected() {
+    if (injectedCount_.load(std::memory_order_acquire) == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(injectMutex_);
+    if (injected_.empty()) return nullptr;
+    detail::Job* job = injected_.front();
+    injected_.pop_front();
+    injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+
+  detail::Job* FindJob(size_t slot) {
+    if (detail::Job* job = deques_[slot]->Pop()) return job;
+    return StealAny(slot);
+  }
+
+  void Notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) == 0) return;
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      ++epoch_;
+    }
+    sleepCv_.notify_all();
+  }
+
+  void Pin(size_t index) {
+#if defined(__linux__)
+    // Workers inherit the mask of the constructing thread,
+    // e.g., the CPUs given by taskset, a cgroup or mpiexec.
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    int count = CPU_COUNT(&allowed);
+    if (count == 0) return;
+    int target = static_cast<int>(index % count);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (!CPU_ISSET(cpu, &allowed) || target-- != 0) continue;
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      return;
+    }
+#else
+    (void)index;
+#endif
+  }
+
+  void WorkerLoop(size_t slot, bool pin) {
+    if (pin) Pin(slot);
+    HPC_TUTOR_TRACE_THREAD_NAME("pool worker " + std::to_string(slot));
+    CurrentPool() = this;
+    SlotRef() = slot;
+    size_t idle = 0;
+    while (true) {
+      detail::Job* job = FindJob(slot);
+      if (job == nullptr) job = TakeInjected();
+      if (job != nullptr) {
+        job->run(job);
+        idle = 0;
+        continue;
+      }
+      if (++idle < kSpinIterations) {
+        detail::CpuRelax();
+        continue;
+      }
+      // Park. The epoch protects against a wake-up lost between
+      // the last look for work and the wait.
+      uint64_t epoch;
+      {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        if (stop_) return;
+        epoch = epoch_;
+      }
+      sleeping_.fetch_add(1, std::memory_order_seq_cst);
+      job = FindJob(slot);
+      if (job == nullptr) job = TakeInjected();
+      if (job != nullptr) {
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        job->run(job);
+        idle = 0;
+        continue;
+      }
+      {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCv_.wait(lock, [&] { return stop_ || epoch_ != epoch; });
+        if (stop_) {
+          sleeping_.fetch_sub(1, std::memory_order_relaxed);
+          return;
+        }
+      }
+      sleeping_.fetch_sub(1, std::memory_order_relaxed);
+      idle = 0;
+    }
+  }
+
+  size_t numThreads_;
+  std::vector<std::unique_ptr<detail::WorkStealingDeque>> deques_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> serialThreshold_;
+  std::mutex callerMutex_;
+
+  std::mutex injectMutex_;
+  std::deque<detail::Job*> injected_;
+  std::atomic<size_t> injectedCount_{0};
+
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCv_;
+  std::atomic<size_t> sleeping_{0};
+  uint64_t epoch_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_THREAD_POOL_HPP_
@@ -0,0 +1,359 @@
+#ifndef HPC_TUTOR_TILED_MATRIX_HPP_
+#define HPC_TUTOR_TILED_MATRIX_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "linalg.hpp"
+#include "matrix_view.hpp"
+
+namespace tutor {
+
+/**
+ * Order in which the tiles of a TiledMatrix are stored.
+ */
+enum class TileOrder {
+  kRowMajor,  ///< Tile-major: tiles one after the other, row by row.
+  kMorton,    ///< Z-order: recursively, quadrant by quadrant.
+};
+
+namespace detail {
+
+/**
+ * Interleaves the bits of `i` and `j` (i in the odd positions).
+ */
+inline uint64_t MortonCode(uint32_t i, uint32_t j) {
+  auto spread = [](uint64_t x) {
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+  };
+  return (spread(i) << 1) | spread(j);
+}
+
+}  // namespace detail
+
+/**
+ * HPC Tutor TiledView Class.
+ *
+ * TiledView is a viewer class over a matrix stored by tiles.
+ * Every tile is a contiguous `tileSize` x `tileSize` block,
+ * so it spans as few pages as possible,
+ * and it can be accessed as a regular MatrixView through `tile`.
+ * Tiles in the last tile row and column are padded up to the full size.
+ */
+template <typename T>
+class TiledView {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+
+  /**
+   * Data Range Constructor.
+   *
+   * `offsets` holds the position of each tile in `data`
+   * (in elements and in row-major tile order).
+   */
+  constexpr TiledView(value_type* data, const size_type* offsets,
+                      size_type rows, size_type cols,
+                      size_type tileSize) noexcept
+      : data_(data),
+        offsets_(offsets),
+        rows_(rows),
+        cols_(cols),
+        tileSize_(tileSize) {}
+
+  /**
+   * Returns a view of the tile at tile position (ti, tj).
+   *
+   * The view has the actual size of the tile, without the padding,
+   * and a row stride equal to the tile size.
+   */
+  [[nodiscard]] constexpr MatrixView<value_type> tile(size_type ti,
+                                                      size_type tj) const {
+    return MatrixView<value_type>(
+        data_ + offsets_[ti * tileCols() + tj],
+        std::min(tileSize_, rows_ - ti * tileSize_),
+        std::min(tileSize_, cols_ - tj * tileSize_), tileSize_);
+  }
+
+  /**
+   * Returns value of the matrix at position (i, j)
+   */
+  [[nodiscard]] constexpr value_type& operator()(size_type i,
+                                                 size_type j) const {
+    size_type ti = i / tileSize_, tj = j / tileSize_;
+    return data_[offsets_[ti * tileCols() + tj] +
+                 (i % tileSize_) * tileSize_ + j % tileSize_];
+  }
+
+  /**
+   * Returns the number of rows in the matrix.
+   */
+  [[nodiscard]] constexpr size_type rows() const noexcept { return rows_; }
+
+  /**
+   * Returns the number of columns in the matrix.
+   */
+  [[nodiscard]] constexpr size_type cols() const noexcept { return cols_; }
+
+  /**
+   * Returns the number of rows and columns of a full tile.
+   */
+  [[nodiscard]] constexpr size_type tileSize() const noexcept {
+    return tileSize_;
+  }
+
+  /**
+   * Returns the number of tile rows.
+   */
+  [[nodiscard]] constexpr size_type tileRows() const noexcept {
+    return (rows_ + tileSize_ - 1) / tileSize_;
+  }
+
+  /**
+   * Returns the number of tile columns.
+   */
+  [[nodiscard]] constexpr size_type tileCols() const noexcept {
+    return (cols_ + tileSize_ - 1) / tileSize_;
+  }
+
+ private:
+  value_type* data_;
+  const size_type* offsets_;
+  size_type rows_;
+  size_type cols_;
+  size_type tileSize_;
+};
+
+/**
+ * HPC Tutor TiledMatrix Class.
+ *
+ * TiledMatrix is a container class that stores a rectangular matrix
+ * by contiguous square tiles,
+ * either in tile-major order or in Z-order (Morton order).
+ * In Z-order, tiles that are close in the matrix
+ * are also close in memory at every scale,
+ * which keeps the working set of blocked kernels within few pages.
+ *
+ * Elements are converted from and to row-major storage
+ * with `FromRowMajor` and `ToRowMajor`.
+ */
+template <typename T>
+class TiledMatrix {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+
+  /**
+   * Empty matrix constructor (default constructor).
+   */
+  TiledMatrix() : rows_(0), cols_(0), tileSize_(1) {}
+
+  /**
+   * Fill constructor.
+   *
+   * Constructs a matrix of size n x m stored in tiles of size
+   * `tileSize` x `tileSize`. Each element is default initialized.
+   */
+  TiledMatrix(size_type n, size_type m, size_type tileSize,
+              TileOrder order = TileOrder::kMorton)
+      : rows_(n), cols_(m), tileSize_(tileSize), order_(order) {
+    if (tileSize == 0) throw std::invalid_argument("tile size must be > 0");
+    size_type tr = (n + tileSize - 1) / tileSize;
+    size_type tc = (m + tileSize - 1) / tileSize;
+    size_type area = tileSize * tileSize;
+    std::vector<size_type> rank(tr * tc);
+    std::iota(rank.begin(), rank.end(), 0);
+    if (order == TileOrder::kMorton) {
+      std::sort(rank.begin(), rank.end(), [tc](size_type a, size_type b) {
+        return detail::MortonCode(a / tc, a % tc) <
+               detail::MortonCode(b / tc, b % tc);
+      });
+    }
+    offsets_.resize(tr * tc);
+    for (size_type pos = 0; pos < rank.size(); ++pos) {
+      offsets_[rank[pos]] = pos * area;
+    }
+    data_.resize(tr * tc * area);
+  }
+
+  /**
+   * Constructs a tiled copy of a row-major matrix.
+   */
+  static TiledMatrix FromRowMajor(const MatrixView<value_type>& m,
+                                  size_type tileSize,
+                                  TileOrder order = TileOrder::kMorton) {
+    TiledMatrix t(m.rows(), m.cols(), tileSize, order);
+    auto v = t.view();
+    for (size_type ti = 0; ti < v.tileRows(); ++ti) {
+      for (size_type tj = 0; tj < v.tileCols(); ++tj) {
+        auto dst = v.tile(ti, tj);
+        auto src = m.view(ti * tileSize, tj * tileSize, dst.rows(), dst.cols());
+        for (size_type i = 0; i < dst.rows(); ++i) {
+          std::copy(src[i], src[i] + dst.cols(), dst[i]);
+        }
+      }
+    }
+    return t;
+  }
+
+  /**
+   * Copies the matrix into a row-major matrix of the same size.
+   */
+  void ToRowMajor(MatrixView<value_type> m) const {
+    auto v = view();
+    for (size_type ti = 0; ti < v.tileRows(); ++ti) {
+      for (size_type tj = 0; tj < v.tileCols(); ++tj) {
+        auto src = v.tile(ti, tj);
+        auto dst = m.view(ti * tileSize_, tj * tileSize_, src.rows(),
+                          src.cols());
+        for (size_type i = 0; i < src.rows(); ++i) {
+          std::copy(src[i], src[i] + src.cols(), dst[i]);
+        }
+      }
+    }
+  }
+
+  /**
+   * Returns a view of the matrix.
+   */
+  [[nodiscard]] TiledView<value_type> view() const {
+    return TiledView<value_type>(const_cast<value_type*>(data_.data()),
+                                 offsets_.data(), rows_, cols_, tileSize_);
+  }
+
+  /**
+   * Returns a view of the tile at tile position (ti, tj).
+   */
+  [[nodiscard]] MatrixView<value_type> tile(size_type ti, size_type tj) {
+    return view().tile(ti, tj);
+  }
+
+  /**
+   * Returns value of the matrix at position (i, j)
+   */
+  [[nodiscard]] value_type& operator()(size_type i, size_type j) {
+    return view()(i, j);
+  }
+
+  /**
+   * Returns value of the matrix at position (i, j)
+   */
+  [[nodiscard]] const value_type& operator()(size_type i,
+                                             size_type j) const {
+    return view()(i, j);
+  }
+
+  /**
+   * Returns a pointer to the underlying array serving as element storage,
+   * padding included.
+   */
+  [[nodiscard]] value_type* data() noexcept { return data_.data(); }
+
+  /**
+   * Returns the number of rows of the matrix.
+   */
+  [[nodiscard]] size_type rows() const noexcept { return rows_; }
+
+  /**
+   * Returns the number of columns of the matrix.
+   */
+  [[nodiscard]] size_type cols() const noexcept { return cols_; }
+
+  /**
+   * Returns the number of rows and columns of a full tile.
+   */
+  [[nodiscard]] size_type tileSize() const noexcept { return tileSize_; }
+
+  /**
+   * Returns the order in which tiles are stored.
+   */
+  [[nodiscard]] TileOrder order() const noexcept { return order_; }
+
+ private:
+  size_type rows_;
+  size_type cols_;
+  size_type tileSize_;
+  TileOrder order_ = TileOrder::kMorton;
+  std::vector<size_type> offsets_;
+  std::vector<T> data_;
+};
+
+/**
+ * General Matrix Multiplication Routine (tiled storage).
+ *
+ * Adds (not stores) `lhs * rhs` to `ret`.
+ * The three matrices must share the same tile size,
+ * which acts as the block size of the decomposition.
+ */
+template <typename T>
+void Gemm_b(TiledView<T> ret, const TiledView<T>& lhs,
+            const TiledView<T>& rhs) {
+  for (size_t ti = 0; ti < ret.tileRows(); ++ti) {
+    for (size_t tk = 0; tk < lhs.tileCols(); ++tk) {
+      auto a = lhs.tile(ti, tk);
+      for (size_t tj = 0; tj < ret.tileCols(); ++tj) {
+        Gemm(ret.tile(ti, tj), a, rhs.tile(tk, tj));
+      }
+    }
+  }
+}
+
+/**
+ * LU Factorization Routine (tiled storage).
+ *
+ * Same result and requirements as `LuFact`,
+ * using the tiles of `m` as blocks.
+ */
+template <typename T>
+void LuFact_b(TiledView<T> m) {
+  size_t nt = m.tileRows();
+  for (size_t k = 0; k < nt; ++k) {
+    auto akk = m.tile(k, k);
+    detail::TileGetrf(akk);
+    for (size_t j = k + 1; j < nt; ++j) {
+      detail::TileTrsmLowerUnit(akk, m.tile(k, j));
+    }
+    for (size_t i = k + 1; i < nt; ++i) {
+      detail::TileTrsmUpperRight(akk, m.tile(i, k));
+    }
+    for (size_t i = k + 1; i < nt; ++i) {
+      auto aik = m.tile(i, k);
+      for (size_t j = k + 1; j < nt; ++j) {
+        detail::TileGemmSub(m.tile(i, j), aik, m.tile(k, j));
+      }
+    }
+  }
+}
+
+/**
+ * Transposes a square matrix in place (tiled storage).
+ */
+template <typename T>
+void Transpose(TiledView<T> m) {
+  for (size_t ti = 0; ti < m.tileRows(); ++ti) {
+    Transpose(m.tile(ti, ti));
+    for (size_t tj = ti + 1; tj < m.tileCols(); ++tj) {
+      auto a = m.tile(ti, tj);
+      auto b = m.tile(tj, ti);
+      for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+          std::swap(a[i][j], b[j][i]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace tutor
+
+#endif  // HPC_TUTOR_TILED_MATRIX_HPP_
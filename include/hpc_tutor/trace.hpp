@@ -0,0 +1,371 @@
+#ifndef HPC_TUTOR_TRACE_HPP_
+#define HPC_TUTOR_TRACE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace tutor {
+
+/**
+ * Interval of time spent by a thread in a named region.
+ *
+ * `name` must outlive the tracer, e.g., a string literal.
+ * Times are nanoseconds since the tracer was created.
+ */
+struct TraceEvent {
+  const char* name;
+  int64_t id;  ///< Optional identifier, e.g., a task; -1 if none.
+  uint64_t begin;
+  uint64_t end;
+};
+
+namespace detail {
+
+/**
+ * Ring buffer of the events of one thread.
+ *
+ * Only the owner thread records, without locks or atomic read-modify-write:
+ * when the buffer is full the oldest events are overwritten.
+ * Readers must not run while the owner records.
+ */
+class TraceBuffer {
+ public:
+  TraceBuffer(size_t tid, size_t capacity)
+      : tid_(tid), mask_(capacity - 1), events_(capacity) {}
+
+  void Record(const TraceEvent& event) noexcept {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    events_[head & mask_] = event;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /**
+   * Returns the recorded events, oldest first.
+   */
+  [[nodiscard]] std::vector<TraceEvent> Events() const {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t n = std::min<uint64_t>(head, events_.size());
+    std::vector<TraceEvent> ret;
+    ret.reserve(n);
+    for (uint64_t i = head - n; i < head; ++i) {
+      ret.push_back(events_[i & mask_]);
+    }
+    return ret;
+  }
+
+  /**
+   * Returns the number of events overwritten before being read.
+   */
+  [[nodiscard]] uint64_t dropped() const noexcept {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    return head > events_.size() ? head - events_.size() : 0;
+  }
+
+  void Clear() noexcept { head_.store(0, std::memory_order_release); }
+
+  [[nodiscard]] size_t tid() const noexcept { return tid_; }
+
+  [[nodiscard]] const std::string& name() const noexcept { return name_; }
+  void set_name(std::string name) { name_ = std::move(name); }
+
+ private:
+  size_t tid_;
+  uint64_t mask_;
+  std::vector<TraceEvent> events_;
+  std::atomic<uint64_t> head_{0};
+  std::string name_;
+};
+
+inline void WriteJsonString(std::ostream& os, const char* s) {
+  os << '"';
+  for (; *s != '\0'; ++s) {
+    if (*s == '"' || *s == '\\') {
+      os << '\\' << *s;
+    } else if (static_cast<unsigned char>(*s) < 0x20) {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", *s);
+      os << code;
+    } else {
+      os << *s;
+    }
+  }
+  os << '"';
+}
+
+}  // namespace detail
+
+/**
+ * HPC Tutor Tracer.
+ *
+ * Records which thread ran which region and when,
+ * and writes the result in the Chrome trace event format,
+ * which chrome://tracing and https://ui.perfetto.dev open.
+ *
+ * Each thread records into its own ring buffer,
+ * so recording takes no locks: two clock reads and a store.
+ * Threads get their buffer, and a lock, only on their first event.
+ * Recording is off until `Start`, or from the beginning
+ * if the environment variable `HPC_TUTOR_TRACE_FILE` names
+ * a file, which is then written at exit.
+ *
+ * The library records through `HPC_TUTOR_TRACE_SCOPE`,
+ * which compiles to nothing unless `HPC_TUTOR_TRACE` is defined
+ * (CMake option `HPC_TUTOR_TRACE`).
+ */
+class Tracer {
+ public:
+  /**
+   * Events kept per thread by default.
+   */
+  static constexpr size_t kDefaultCapacity = size_t(1) << 16;
+
+  /**
+   * Returns the process tracer.
+   *
+   * It is never destroyed, so threads can record until the very end.
+   */
+  static Tracer& Global() {
+    static Tracer* tracer = [] {
+      auto* t = new Tracer();
+      if (const char* path = std::getenv("HPC_TUTOR_TRACE_FILE")) {
+        t->exitPath_ = path;
+        t->Start();
+        std::atexit([] {
+          try {
+            Global().Write(Global().exitPath_);
+          } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+          }
+        });
+      }
+      return t;
+    }();
+    return *tracer;
+  }
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /**
+   * Starts recording. Buffers created from now on
+   * hold the last `capacity` events of their thread,
+   * rounded up to a power of two.
+   */
+  void Start(size_t capacity = kDefaultCapacity) {
+    size_t c = 1;
+    while (c < capacity) c *= 2;
+    capacity_.store(c, std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_release);
+  }
+
+  void Stop() noexcept { enabled_.store(false, std::memory_order_release); }
+
+  [[nodiscard]] bool enabled() const noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the nanoseconds since the tracer was created.
+   */
+  [[nodiscard]] uint64_t Now() const noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch_)
+            .count());
+  }
+
+  /**
+   * Records an event of the calling thread.
+   */
+  void Record(const TraceEvent& event) { Buffer().Record(event); }
+
+  /**
+   * Names the calling thread in the trace, e.g., "pool worker 3".
+   */
+  void SetThreadName(std::string name) {
+    ThreadName() = std::move(name);
+    if (BufferRef() != nullptr) BufferRef()->set_name(ThreadName());
+  }
+
+  /**
+   * Discards the recorded events.
+   *
+   * Like `Write`, it must not overlap with recording threads.
+   */
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_) buffer->Clear();
+  }
+
+  /**
+   * Returns the events of every thread, by thread and then oldest first.
+   */
+  [[nodiscard]] std::vector<std::vector<TraceEvent>> Events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::vector<TraceEvent>> ret;
+    for (const auto& buffer : buffers_) ret.push_back(buffer->Events());
+    return ret;
+  }
+
+  /**
+   * Writes the events as Chrome trace JSON.
+   *
+   * Call it when the traced work is done, e.g., after a parallel loop:
+   * buffers are read without synchronizing with their threads.
+   * Each thread is a track; events become complete ("X") events
+   * with microsecond times, and the count of overwritten events
+   * goes to "otherData".
+   */
+  void Write(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t dropped = 0;
+    bool first = true;
+    auto separator = [&] {
+      os << (first ? "\n" : ",\n");
+      first = false;
+    };
+    os << "{\"traceEvents\":[";
+    for (const auto& buffer : buffers_) {
+      dropped += buffer->dropped();
+      separator();
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+         << buffer->tid() << ",\"args\":{\"name\":";
+      std::string name = buffer->name().empty()
+                             ? "thread " + std::to_string(buffer->tid())
+                             : buffer->name();
+      detail::WriteJsonString(os, name.c_str());
+      os << "}}";
+      for (const TraceEvent& e : buffer->Events()) {
+        separator();
+        os << "{\"name\":";
+        detail::WriteJsonString(os, e.name);
+        os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid()
+           << ",\"ts\":" << Micros(e.begin)
+           << ",\"dur\":" << Micros(e.end - e.begin);
+        if (e.id >= 0) os << ",\"args\":{\"id\":" << e.id << "}";
+        os << "}";
+      }
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":"
+       << dropped << "}}\n";
+  }
+
+  /**
+   * Writes the events as Chrome trace JSON to the file `path`.
+   */
+  void Write(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    Write(file);
+    if (!file) throw std::runtime_error("cannot write " + path);
+  }
+
+ private:
+  Tracer() : epoch_(std::chrono::steady_clock::now()) {}
+
+  static std::string Micros(uint64_t ns) {
+    char us[32];
+    std::snprintf(us, sizeof(us), "%llu.%03llu",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    return us;
+  }
+
+  static std::string& ThreadName() {
+    static thread_local std::string name;
+    return name;
+  }
+
+  static detail::TraceBuffer*& BufferRef() {
+    static thread_local detail::TraceBuffer* buffer = nullptr;
+    return buffer;
+  }
+
+  /**
+   * Returns the buffer of the calling thread, created on first use.
+   */
+  detail::TraceBuffer& Buffer() {
+    detail::TraceBuffer*& buffer = BufferRef();
+    if (buffer == nullptr) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers_.push_back(std::make_unique<detail::TraceBuffer>(
+          buffers_.size(), capacity_.load(std::memory_order_relaxed)));
+      buffer = buffers_.back().get();
+      buffer->set_name(ThreadName());
+    }
+    return *buffer;
+  }
+
+  std::chrono::steady_clock::time_point epoch_;
+  std::atomic<bool> enabled_{false};
+  std::atomic<size_t> capacity_{kDefaultCapacity};
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<detail::TraceBuffer>> buffers_;
+  std::string exitPath_;
+};
+
+/**
+ * Records the lifetime of a scope as an event of the calling thread,
+ * if the tracer is recording when the scope begins.
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name, int64_t id = -1) noexcept
+      : name_(name), id_(id) {
+    Tracer& tracer = Tracer::Global();
+    if (tracer.enabled()) begin_ = tracer.Now();
+  }
+
+  ~TraceScope() {
+    if (begin_ == kOff) return;
+    Tracer& tracer = Tracer::Global();
+    tracer.Record(TraceEvent{name_, id_, begin_, tracer.Now()});
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  static constexpr uint64_t kOff = static_cast<uint64_t>(-1);
+
+  const char* name_;
+  int64_t id_;
+  uint64_t begin_ = kOff;
+};
+
+}  // namespace tutor
+
+#define HPC_TUTOR_TRACE_CONCAT2(a, b) a##b
+#define HPC_TUTOR_TRACE_CONCAT(a, b) HPC_TUTOR_TRACE_CONCAT2(a, b)
+
+#ifdef HPC_TUTOR_TRACE
+/**
+ * Traces the rest of the enclosing scope under `name`
+ * and an optional integer id.
+ */
+#define HPC_TUTOR_TRACE_SCOPE(...)                                 \
+  ::tutor::TraceScope HPC_TUTOR_TRACE_CONCAT(hpcTutorTrace, __LINE__)( \
+      __VA_ARGS__)
+/**
+ * Names the calling thread in the trace.
+ */
+#define HPC_TUTOR_TRACE_THREAD_NAME(name) \
+  ::tutor::Tracer::Global().SetThreadName(name)
+#else
+#define HPC_TUTOR_TRACE_SCOPE(...) static_cast<void>(0)
+#define HPC_TUTOR_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
+
+#endif  // HPC_TUTOR_TRACE_HPP_
@@ -3,12 +3,18 @@
 #include <catch2/catch_get_random_seed.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <cstdint>
 #include <numeric>
 #include <random>
 #include <string>
 
+#include "hpc_tutor/float16.hpp"
+#include "hpc_tutor/gemm_int.hpp"
 #include "hpc_tutor/linalg.hpp"
 #include "hpc_tutor/matrix.hpp"
+#include "hpc_tutor/tiled_matrix.hpp"
+#include "baseline_listener.hpp"
+#include "roofline_listener.hpp"
 #include "test_utils.hpp"
 
 template <typename T>
@@ -23,6 +29,15 @@ TEST_CASE("Basic LinAlg Benchmarks", "[basic-linalg]") {
   auto v = RandomVector<double>(n);
   auto w = RandomVector<double>(n);
   double scalar = RandomVector<double>(1)[0];
+  double vector = 8.0 * n, matrix = 8.0 * n * n;
+  SetRooflineWork("Inner-" + std::to_string(n), 2.0 * n, 2 * vector,
+                  2 * vector);
+  SetRooflineWork("VectorSum-" + std::to_string(n), n, 3 * vector,
+                  3 * vector);
+  SetRooflineWork("MatrixVectorMul-" + std::to_string(n), 2.0 * n * n,
+                  matrix + 2 * vector, matrix + 2 * vector);
+  SetRooflineWork("MatrixMatrixMul-" + std::to_string(n), 2.0 * n * n * n,
+                  3 * matrix, 3 * matrix);
   BENCHMARK("VectorScalarMul-" + std::to_string(n)) {
     tutor::ScalarMul(v.data(), n, scalar);
     return u[0];
@@ -56,6 +71,9 @@ TEST_CASE("Gemm Benchmark", "[gemm]") {
   auto lhs = RandomMatrix<double>(n, n);
   auto rhs = RandomMatrix<double>(n, n);
   auto ret = Matrix<double>(n, n);
+  double flops = 2.0 * n * n * n, bytes = 24.0 * n * n;
+  SetRooflineWork("Gemm-" + std::to_string(n), flops, bytes, bytes);
+  SetRooflineWork("Gemm_b-" + std::to_string(n), flops, bytes, bytes);
   BENCHMARK("Gemm-" + std::to_string(n)) {
     tutor::Gemm(ret.view(), lhs.view(), rhs.view());
     return ret[0][0];
@@ -65,6 +83,54 @@ TEST_CASE("Gemm Benchmark", "[gemm]") {
     tutor::Gemm_b(ret.view(), lhs.view(), rhs.view(), 1, 1, 1);
     return ret[0][0];
   };
+  BENCHMARK("Gemm-TN-" + std::to_string(n)) {
+    tutor::Gemm(ret.view(), tutor::Op::kTrans, lhs.view(), tutor::Op::kNoTrans,
+                rhs.view(), 1.0, 0.0);
+    return ret[0][0];
+  };
+  BENCHMARK("Gemm-NT-" + std::to_string(n)) {
+    tutor::Gemm(ret.view(), tutor::Op::kNoTrans, lhs.view(), tutor::Op::kTrans,
+                rhs.view(), 1.0, 0.0);
+    return ret[0][0];
+  };
+  auto tlhs = tutor::TiledMatrix<double>::FromRowMajor(lhs.view(), 64);
+  auto trhs = tutor::TiledMatrix<double>::FromRowMajor(rhs.view(), 64);
+  auto tret = tutor::TiledMatrix<double>(n, n, 64);
+  BENCHMARK("Gemm_b-tiled-" + std::to_string(n)) {
+    tutor::Gemm_b(tret.view(), tlhs.view(), trhs.view());
+    return tret(0, 0);
+  };
+}
+
+TEST_CASE("Integer Gemm Benchmark", "[gemm-int]") {
+  size_t n = GENERATE(500, 1000, 2000);
+  auto lhs = RandomMatrix<uint8_t>(n, n, 0, 255);
+  auto rhs = RandomMatrix<int8_t>(n, n, -128, 127);
+  auto wide = Matrix<int32_t>(n, n);
+  auto ret = Matrix<int32_t>(n, n);
+  BENCHMARK("Gemm-int32-" + std::to_string(n)) {
+    tutor::Gemm(ret.view(), wide.view(), wide.view());
+    return ret[0][0];
+  };
+  for (auto isa : {tutor::IntGemmIsa::kPortable, tutor::IntGemmIsa::kAvx2,
+                   tutor::IntGemmIsa::kAvx512Vnni}) {
+    if (!tutor::IntGemmIsaSupported(isa)) continue;
+    std::string suffix =
+        std::to_string(static_cast<int>(isa)) + "-" + std::to_string(n);
+    BENCHMARK("Gemm-u8s8-isa" + suffix) {
+      tutor::Gemm(ret.view(), lhs.view(), rhs.view(), isa);
+      return ret[0][0];
+    };
+    tutor::PackedIntRhs<uint8_t, int8_t> packed(rhs.view(), isa);
+    BENCHMARK("Gemm-u8s8-packed-isa" + suffix) {
+      tutor::Gemm(ret.view(), lhs.view(), packed);
+      return ret[0][0];
+    };
+    BENCHMARK("Gemm_t-u8s8-packed-isa" + suffix) {
+      tutor::Gemm_t(ret.view(), lhs.view(), packed);
+      return ret[0][0];
+    };
+  }
 }
 
 TEST_CASE("LuFact Benchmark", "[lu]") {
@@ -81,3 +147,113 @@ TEST_CASE("LuFact Benchmark", "[lu]") {
     return a[0][0];
   };
 }
+
+TEST_CASE("Cholesky Benchmark", "[cholesky]") {
+  size_t n = GENERATE(500, 1000, 2000, 3000, 4000);
+  constexpr size_t bs = 64;
+  auto spd = RandomSpdMatrix<double>(n);
+  auto a = spd;
+  // Each run factors a fresh copy: a factor is not positive definite.
+  BENCHMARK_ADVANCED("Cholesky_b-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = spd;
+      tutor::Cholesky_b(a.view(), bs);
+      return a[0][0];
+    });
+  };
+  BENCHMARK_ADVANCED("LuFact_b-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = spd;
+      tutor::LuFact_b(a.view(), bs);
+      return a[0][0];
+    });
+  };
+}
+
+TEST_CASE("QrFact Benchmark", "[qr]") {
+  size_t n = GENERATE(500, 1000, 2000);
+  auto m = RandomMatrix<double>(n, n, -1, 1);
+  auto a = m;
+  std::vector<double> tau(n);
+  BENCHMARK_ADVANCED("QrFact-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = m;
+      tutor::QrFact(a.view(), tau.data());
+      return a[0][0];
+    });
+  };
+  BENCHMARK_ADVANCED("QrFact_b-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = m;
+      tutor::QrFact_b(a.view(), tau.data(), 32);
+      return a[0][0];
+    });
+  };
+}
+
+TEST_CASE("Multi-Vector MatrixEval Benchmark", "[matrix-eval]") {
+  size_t n = GENERATE(1000, 2000, 4000);
+  size_t k = GENERATE(2, 8, 32);
+  auto m = RandomMatrix<double>(n, n);
+  auto vs = RandomMatrix<double>(n, k);
+  auto ret = Matrix<double>(n, k);
+  std::string suffix = std::to_string(n) + "x" + std::to_string(k);
+  std::vector<double> v(n), r(n);
+  BENCHMARK("MatrixEval-loop-" + suffix) {
+    for (size_t c = 0; c < k; ++c) {
+      for (size_t j = 0; j < n; ++j) v[j] = vs[j][c];
+      tutor::MatrixEval(r.data(), m.view(), v.data());
+      for (size_t i = 0; i < n; ++i) ret[i][c] = r[i];
+    }
+    return ret[0][0];
+  };
+  BENCHMARK("MatrixEval-multi-" + suffix) {
+    tutor::MatrixEval(ret.view(), m.view(), vs.view());
+    return ret[0][0];
+  };
+}
+
+TEST_CASE("16-bit Storage Benchmark", "[float16]") {
+  size_t n = GENERATE(2000, 4000, 8000);
+  auto m = RandomMatrix<float>(n, n, -1, 1);
+  auto half = Matrix<tutor::Half>(n, n);
+  auto bf16 = Matrix<tutor::BFloat16>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    tutor::Convert(half[i], m[i], n);
+    tutor::Convert(bf16[i], m[i], n);
+  }
+  auto v = RandomVector<float>(n, -1, 1);
+  std::vector<float> r(n);
+  BENCHMARK("MatrixEval-float-" + std::to_string(n)) {
+    tutor::MatrixEval(r.data(), m.view(), v.data());
+    return r[0];
+  };
+  for (auto isa : {tutor::Float16Isa::kPortable, tutor::Float16Isa::kAvx2,
+                   tutor::Float16Isa::kAvx512Bf16}) {
+    if (!tutor::Float16IsaSupported(isa)) continue;
+    std::string suffix =
+        std::to_string(static_cast<int>(isa)) + "-" + std::to_string(n);
+    BENCHMARK("MatrixEval-half-isa" + suffix) {
+      tutor::MatrixEval(r.data(), half.view(), v.data(), isa);
+      return r[0];
+    };
+    BENCHMARK("MatrixEval-bf16-isa" + suffix) {
+      tutor::MatrixEval(r.data(), bf16.view(), v.data(), isa);
+      return r[0];
+    };
+  }
+  if (n > 2000) return;
+  auto ret = Matrix<float>(n, n);
+  BENCHMARK("Gemm-float-" + std::to_string(n)) {
+    tutor::Gemm(ret.view(), m.view(), m.view());
+    return ret[0][0];
+  };
+  BENCHMARK("Gemm_b-half-" + std::to_string(n)) {
+    tutor::Gemm_b(ret.view(), half.view(), half.view(), 64, 256, 128);
+    return ret[0][0];
+  };
+}
@@ -2,6 +2,7 @@
 #include <catch2/catch_get_random_seed.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <limits>
 #include <numeric>
 #include <random>
 
@@ -88,3 +89,214 @@ TEST_CASE("SolveLower and SolveUpper", "[assignment-1]") {
   tutor::SolveUpper(result.data(), m.view(), aux.data());
   RequireEqual(result, truth);
 }
+
+TEST_CASE("Cholesky", "[builtin-linalg]") {
+  size_t n = GENERATE(1, 2, 29);
+  INFO("n = " << n);
+  auto m = RandomSpdMatrix<double>(n);
+  auto chol = m;
+  tutor::Cholesky(chol.view());
+  auto l = Matrix<double>(n, n);
+  auto mul = Matrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j <= i; ++j) l[i][j] = chol[i][j];
+    // The strictly upper half is left untouched.
+    for (size_t j = i + 1; j < n; ++j) REQUIRE(chol[i][j] == m[i][j]);
+  }
+  tutor::Gemm(mul.view(), tutor::Op::kNoTrans, l.view(), tutor::Op::kTrans,
+              l.view(), 1.0, 0.0);
+  RequireEqual(mul, m);
+}
+
+TEST_CASE("Cholesky_b", "[builtin-linalg]") {
+  constexpr size_t n = 31;
+  auto m = RandomSpdMatrix<double>(n);
+  auto chol = m;
+  tutor::Cholesky(m.view());
+  size_t bs = GENERATE(1, 3, 4, 16, 17, 31, 40);
+  INFO("bs = " << bs);
+  tutor::Cholesky_b(chol.view(), bs);
+  RequireEqual(chol, m);
+}
+
+TEST_CASE("CholeskySolve", "[builtin-linalg]") {
+  constexpr size_t n = 23;
+  auto m = RandomSpdMatrix<double>(n);
+  auto truth = RandomVector<double>(n);
+  auto v = std::vector<double>(n);
+  tutor::MatrixEval(v.data(), m.view(), truth.data());
+  tutor::Cholesky_b(m.view(), 8);
+  auto result = std::vector<double>(n);
+  tutor::CholeskySolve(result.data(), m.view(), v.data());
+  RequireEqual(result, truth);
+  // In place.
+  tutor::CholeskySolve(v.data(), m.view(), v.data());
+  RequireEqual(v, truth);
+}
+
+TEST_CASE("GEMM with transposes and scaling", "[builtin-linalg]") {
+  constexpr size_t n = 7;
+  constexpr size_t m = 9;
+  constexpr size_t l = 5;
+  auto opl = GENERATE(tutor::Op::kNoTrans, tutor::Op::kTrans);
+  auto opr = GENERATE(tutor::Op::kNoTrans, tutor::Op::kTrans);
+  double alpha = GENERATE(1.0, -2.5);
+  double beta = GENERATE(0.0, 1.0, 0.5);
+  auto lhs = RandomMatrix<double>(n, l);
+  auto rhs = RandomMatrix<double>(l, m);
+  auto ret = RandomMatrix<double>(n, m);
+  auto truth = Matrix<double>(n, m);
+  tutor::Gemm(truth.view(), lhs.view(), rhs.view());
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < m; ++j) {
+      truth[i][j] = alpha * truth[i][j] + beta * ret[i][j];
+    }
+  }
+  if (beta == 0) ret[0][0] = std::numeric_limits<double>::quiet_NaN();
+  auto transpose = [](const Matrix<double>& a) {
+    auto t = Matrix<double>(a.cols(), a.rows());
+    for (size_t i = 0; i < a.rows(); ++i) {
+      for (size_t j = 0; j < a.cols(); ++j) t[j][i] = a[i][j];
+    }
+    return t;
+  };
+  auto a = opl == tutor::Op::kNoTrans ? lhs : transpose(lhs);
+  auto b = opr == tutor::Op::kNoTrans ? rhs : transpose(rhs);
+  INFO("alpha = " << alpha << ", beta = " << beta);
+  SECTION("Row-major") {
+    tutor::Gemm(ret.view(), opl, a.view(), opr, b.view(), alpha, beta);
+    RequireEqual(ret, truth);
+  }
+  SECTION("Column-major") {
+    // Column-major storage of X is row-major storage of X^T.
+    auto retT = transpose(ret);
+    auto aT = transpose(a);
+    auto bT = transpose(b);
+    tutor::Gemm(tutor::Layout::kColMajor,
+                tutor::ColMajorView(retT.data(), n, m, n), opl,
+                tutor::ColMajorView(aT.data(), a.rows(), a.cols(), a.rows()),
+                opr,
+                tutor::ColMajorView(bT.data(), b.rows(), b.cols(), b.rows()),
+                alpha, beta);
+    RequireEqual(transpose(retT), truth);
+  }
+}
+
+TEST_CASE("Multi-vector MatrixEval", "[builtin-linalg]") {
+  constexpr size_t n = 23;
+  constexpr size_t l = 300;
+  size_t k = GENERATE(1, 3, 4, 8, 13);
+  auto m = RandomMatrix<double>(n, l);
+  auto vs = RandomMatrix<double>(l, k);
+  auto ret = Matrix<double>(n, k, 1.0);
+  auto truth = Matrix<double>(n, k);
+  for (size_t c = 0; c < k; ++c) {
+    std::vector<double> v(l), r(n);
+    for (size_t j = 0; j < l; ++j) v[j] = vs[j][c];
+    tutor::MatrixEval(r.data(), m.view(), v.data());
+    for (size_t i = 0; i < n; ++i) truth[i][c] = r[i];
+  }
+  INFO("k = " << k);
+  tutor::MatrixEval(ret.view(), m.view(), vs.view());
+  RequireEqual(ret, truth);
+}
+
+TEST_CASE("Reproducible reductions", "[builtin-linalg]") {
+  size_t n = GENERATE(1, 7, 1000, 100003);
+  auto u = RandomVector<double>(n, -1, 1);
+  auto v = RandomVector<double>(n, -1e6, 1e6);
+  double sum = tutor::Accumulate_r(u.data(), n);
+  double inner = tutor::Inner_r(u.data(), v.data(), n);
+  long double exactSum = 0, exactInner = 0;
+  for (size_t i = 0; i < n; ++i) {
+    exactSum += u[i];
+    exactInner += static_cast<long double>(u[i]) * v[i];
+  }
+  REQUIRE_THAT(sum, WithinAbs(static_cast<double>(exactSum), 1e-12));
+  REQUIRE_THAT(inner, WithinAbs(static_cast<double>(exactInner), 1e-6));
+
+  SECTION("Results do not depend on the order") {
+    std::vector<size_t> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::mt19937 rng(Catch::getSeed());
+    std::shuffle(perm.begin(), perm.end(), rng);
+    std::vector<double> pu(n), pv(n);
+    for (size_t i = 0; i < n; ++i) {
+      pu[i] = u[perm[i]];
+      pv[i] = v[perm[i]];
+    }
+    REQUIRE(tutor::Accumulate_r(pu.data(), n) == sum);
+    REQUIRE(tutor::Inner_r(pu.data(), pv.data(), n) == inner);
+    std::reverse(pu.begin(), pu.end());
+    REQUIRE(tutor::Accumulate_r(pu.data(), n) == sum);
+  }
+}
+
+TEST_CASE("Reproducible reductions edge cases", "[builtin-linalg]") {
+  std::vector<double> cancel = {1e16, 1, -1e16, 1, 0.5};
+  REQUIRE(tutor::Accumulate_r(cancel.data(), cancel.size()) == 2.5);
+  std::vector<double> zeros(5);
+  REQUIRE(tutor::Accumulate_r(zeros.data(), zeros.size()) == 0);
+  std::vector<double> huge = {1e308, 1e308, -1e308};
+  REQUIRE(tutor::Accumulate_r(huge.data(), huge.size()) == 1e308);
+  std::vector<double> inf = {1, std::numeric_limits<double>::infinity()};
+  REQUIRE(tutor::Accumulate_r(inf.data(), inf.size()) ==
+          std::numeric_limits<double>::infinity());
+  std::vector<float> f = {0.1f, 0.2f, 0.3f};
+  REQUIRE(tutor::Accumulate_r(f.data(), f.size()) ==
+          static_cast<float>(double(0.1f) + double(0.2f) + double(0.3f)));
+  std::vector<int> i = {1, -2, 3};
+  REQUIRE(tutor::Accumulate_r(i.data(), i.size()) == 2);
+}
+
+TEST_CASE("QrFact", "[builtin-linalg]") {
+  size_t n = GENERATE(1, 7, 30);
+  size_t m = GENERATE(1, 5, 13);
+  INFO("n = " << n << ", m = " << m);
+  auto a = RandomMatrix<double>(n, m, -1, 1);
+  auto qr = a;
+  std::vector<double> tau(std::min(n, m));
+  tutor::QrFact(qr.view(), tau.data());
+  // Rebuilds A column by column as Q (R e_j).
+  auto mul = Matrix<double>(n, m);
+  std::vector<double> col(n);
+  for (size_t j = 0; j < m; ++j) {
+    std::fill(col.begin(), col.end(), 0.0);
+    for (size_t i = 0; i <= std::min(j, n - 1); ++i) col[i] = qr[i][j];
+    for (size_t k = tau.size(); k-- > 0;) {
+      double s = col[k];
+      for (size_t i = k + 1; i < n; ++i) s += qr[i][k] * col[i];
+      s *= tau[k];
+      col[k] -= s;
+      for (size_t i = k + 1; i < n; ++i) col[i] -= s * qr[i][k];
+    }
+    for (size_t i = 0; i < n; ++i) mul[i][j] = col[i];
+  }
+  RequireEqual(mul, a);
+}
+
+TEST_CASE("QrFact_b", "[builtin-linalg]") {
+  constexpr size_t n = 41;
+  size_t m = GENERATE(17, 41, 50);
+  auto a = RandomMatrix<double>(n, m, -1, 1);
+  auto qr = a;
+  std::vector<double> tau(std::min(n, m)), tauB(tau.size());
+  tutor::QrFact(a.view(), tau.data());
+  size_t bs = GENERATE(1, 3, 8, 17, 64);
+  INFO("m = " << m << ", bs = " << bs);
+  tutor::QrFact_b(qr.view(), tauB.data(), bs);
+  RequireEqual(qr, a);
+  RequireEqual(tauB, tau);
+}
+
+TEST_CASE("QrSolve", "[builtin-linalg]") {
+  constexpr size_t n = 40;
+  constexpr size_t m = 9;
+  auto a = RandomMatrix<double>(n, m, -1, 1);
+  auto truth = RandomVector<double>(m, -1, 1);
+  std::vector<double> b(n), tau(m), result(m);
+  tutor::MatrixEval(b.data(), a.view(), truth.data());
+  tutor::QrFact_b(a.view(), tau.data(), 4);
+  tutor::QrSolve(result.data(), a.view(), tau.data(), b.data());
+  RequireEqual(result, truth);
+}
@@ -0,0 +1,247 @@
+#include <omp.h>
+
+#include <algorithm>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hpc_tutor/krylov.hpp"
+#include "hpc_tutor/linalg.hpp"
+#include "hpc_tutor/linalg_t.hpp"
+#include "hpc_tutor/matrix.hpp"
+#include "hpc_tutor/reduce.hpp"
+#include "hpc_tutor/task_graph.hpp"
+#include "baseline_listener.hpp"
+#include "roofline_listener.hpp"
+#include "test_utils.hpp"
+
+TEST_CASE("Vector Kernel Benchmarks", "[vector-t]") {
+  // Vectors as long as the n x n matrices of assignment 1,
+  // so they stream from memory.
+  size_t n = GENERATE(500, 1000, 2000, 3000, 4000);
+  size_t len = n * n;
+  auto u = RandomVector<double>(len);
+  auto v = RandomVector<double>(len);
+  auto w = RandomVector<double>(len);
+  double scalar = RandomVector<double>(1)[0];
+  std::string suffix = std::to_string(n) + "^2";
+  size_t threads = omp_get_max_threads();
+  double vector = 8.0 * len;
+  SetRooflineWork("Inner-" + suffix, 2.0 * len, 2 * vector, 2 * vector);
+  SetRooflineWork("Inner_t-" + suffix, 2.0 * len, 2 * vector, 2 * vector,
+                  threads);
+  SetRooflineWork("VectorSum-" + suffix, len, 3 * vector, 3 * vector);
+  SetRooflineWork("VectorSum_t-" + suffix, len, 3 * vector, 3 * vector,
+                  threads);
+  BENCHMARK("VectorScalarMul-" + suffix) {
+    tutor::ScalarMul(v.data(), len, scalar);
+    return v[0];
+  };
+  BENCHMARK("VectorScalarMul_t-" + suffix) {
+    tutor::ScalarMul_t(v.data(), len, scalar);
+    return v[0];
+  };
+  BENCHMARK("Inner-" + suffix) {
+    return tutor::Inner(u.data(), v.data(), len);
+  };
+  BENCHMARK("Inner_t-" + suffix) {
+    return tutor::Inner_t(u.data(), v.data(), len);
+  };
+  BENCHMARK("Inner_rt-" + suffix) {
+    return tutor::Inner_rt(u.data(), v.data(), len);
+  };
+  BENCHMARK("VectorSum-" + suffix) {
+    tutor::VectorSum(u.data(), v.data(), w.data(), len);
+    return u[0];
+  };
+  BENCHMARK("VectorSum_t-" + suffix) {
+    tutor::VectorSum_t(u.data(), v.data(), w.data(), len);
+    return u[0];
+  };
+  BENCHMARK("VectorAccumulate-" + suffix) {
+    return tutor::Accumulate(u.data(), len);
+  };
+  BENCHMARK("VectorAccumulate_t-" + suffix) {
+    return tutor::Accumulate_t(u.data(), len);
+  };
+  BENCHMARK("VectorAccumulate_r-" + suffix) {
+    return tutor::Accumulate_r(u.data(), len);
+  };
+  BENCHMARK("VectorAccumulate_rt-" + suffix) {
+    return tutor::Accumulate_rt(u.data(), len);
+  };
+}
+
+TEST_CASE("Sort Benchmark", "[sort]") {
+  size_t n = GENERATE(1000000, 16000000);
+  auto input = RandomVector<double>(n);
+  auto v = input;
+  std::string suffix = std::to_string(n);
+  BENCHMARK_ADVANCED("MergeSort-" + suffix)
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      v = input;
+      tutor::MergeSort(v.data(), n);
+      return v[0];
+    });
+  };
+  BENCHMARK_ADVANCED("MergeSort_t-" + suffix)
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      v = input;
+      tutor::MergeSort_t(v.data(), n);
+      return v[0];
+    });
+  };
+}
+
+TEST_CASE("Cholesky_t Benchmark", "[cholesky]") {
+  size_t n = GENERATE(500, 1000, 2000, 3000, 4000);
+  constexpr size_t bs = 64;
+  auto spd = RandomSpdMatrix<double>(n);
+  auto a = spd;
+  BENCHMARK_ADVANCED("Cholesky_b-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = spd;
+      tutor::Cholesky_b(a.view(), bs);
+      return a[0][0];
+    });
+  };
+  BENCHMARK_ADVANCED("Cholesky_t-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = spd;
+      tutor::Cholesky_t(a.view(), bs);
+      return a[0][0];
+    });
+  };
+}
+
+TEST_CASE("LuFact_t Benchmark", "[lu]") {
+  size_t n = GENERATE(500, 1000, 2000, 3000, 4000);
+  constexpr size_t bs = 64;
+  auto m = RandomMatrix<double>(n, n);
+  // Diagonal dominance guarantees that the unpivoted LU exists.
+  for (size_t i = 0; i < n; ++i) m[i][i] += n;
+  auto a = m;
+  BENCHMARK_ADVANCED("LuFact_t-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = m;
+      tutor::LuFact_t(a.view(), bs);
+      return a[0][0];
+    });
+  };
+  BENCHMARK_ADVANCED("LuFact_bt-" + std::to_string(n))
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = m;
+      tutor::LuFact_bt(a.view(), bs);
+      return a[0][0];
+    });
+  };
+}
+
+TEST_CASE("Tall-Skinny QR Benchmark", "[qr]") {
+  size_t n = GENERATE(100000, 1000000);
+  size_t m = GENERATE(8, 32);
+  auto mat = RandomMatrix<double>(n, m, -1, 1);
+  auto a = mat;
+  std::vector<double> tau(m);
+  std::string suffix = std::to_string(n) + "x" + std::to_string(m);
+  BENCHMARK_ADVANCED("QrFact_t-" + suffix)
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = mat;
+      tutor::QrFact_t(a.view(), tau.data(), m);
+      return a[0][0];
+    });
+  };
+  BENCHMARK_ADVANCED("Tsqr_t-" + suffix)
+  (Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      a = mat;
+      return tutor::Tsqr_t(a.view()).leaves();
+    });
+  };
+}
+
+TEST_CASE("Reduction Benchmark", "[reduce]") {
+  // Square, and tall with rows shorter than a cache line pair.
+  auto [rows, cols] = GENERATE(std::pair<size_t, size_t>{4000, 4000},
+                               std::pair<size_t, size_t>{4000000, 12});
+  auto m = RandomMatrix<double>(rows, cols);
+  std::vector<double> ret(std::max(rows, cols));
+  std::string suffix = std::to_string(rows) + "x" + std::to_string(cols);
+  size_t threads = omp_get_max_threads();
+  double bytes = 8.0 * rows * cols;
+  SetRooflineWork("ColSums-" + suffix, rows * cols, bytes, bytes);
+  SetRooflineWork("ColSums_t-" + suffix, rows * cols, bytes, bytes, threads);
+  SetRooflineWork("RowSums-" + suffix, rows * cols, bytes, bytes);
+  // Column by column, as an exercise would first write it.
+  BENCHMARK("ColSums_naive-" + suffix) {
+    for (size_t j = 0; j < cols; ++j) {
+      double sum = 0;
+      for (size_t i = 0; i < rows; ++i) sum += m[i][j];
+      ret[j] = sum;
+    }
+    return ret[0];
+  };
+  BENCHMARK("ColSums-" + suffix) {
+    tutor::ColSums(ret.data(), m.view());
+    return ret[0];
+  };
+  BENCHMARK("ColSums_t-" + suffix) {
+    tutor::ColSums_t(ret.data(), m.view());
+    return ret[0];
+  };
+  BENCHMARK("ColArgMaxs_t-" + suffix) {
+    std::vector<size_t> args(cols);
+    tutor::ColArgMaxs_t(args.data(), m.view());
+    return args[0];
+  };
+  BENCHMARK("RowSums-" + suffix) {
+    tutor::RowSums(ret.data(), m.view());
+    return ret[0];
+  };
+  BENCHMARK("RowSums_t-" + suffix) {
+    tutor::RowSums_t(ret.data(), m.view());
+    return ret[0];
+  };
+}
+
+TEST_CASE("Krylov Solver Benchmark", "[krylov]") {
+  // Memory-bound iterations: a stencil operator on long vectors.
+  size_t n = GENERATE(1000000, 4000000);
+  auto b = RandomVector<double>(n, -1, 1);
+  std::vector<double> x(n);
+  auto stencil = [n](double* y, const double* v) {
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = 4 * v[i] - (i > 0 ? v[i - 1] : 0) - (i + 1 < n ? v[i + 1] : 0);
+    }
+  };
+  // A fixed number of iterations.
+  tutor::KrylovOptions options;
+  options.tolerance = 0;
+  options.maxIterations = 20;
+  options.restart = 10;
+  std::string suffix = std::to_string(n);
+  BENCHMARK("Cg_t-" + suffix) {
+    std::fill(x.begin(), x.end(), 0.0);
+    return tutor::Cg_t(stencil, n, x.data(), b.data(), options).residual();
+  };
+  options.pipelined = true;
+  BENCHMARK("Cg_t-pipelined-" + suffix) {
+    std::fill(x.begin(), x.end(), 0.0);
+    return tutor::Cg_t(stencil, n, x.data(), b.data(), options).residual();
+  };
+  BENCHMARK("Gmres_t-" + suffix) {
+    std::fill(x.begin(), x.end(), 0.0);
+    return tutor::Gmres_t(stencil, n, x.data(), b.data(), options).residual();
+  };
+}
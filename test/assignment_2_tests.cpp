@@ -1,3 +1,5 @@
+#include <omp.h>
+
 #include <algorithm>
 #include <catch2/catch_get_random_seed.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -11,6 +13,57 @@
 #include "hpc_tutor/matrix.hpp"
 #include "test_utils.hpp"
 
+TEST_CASE("Vector kernels _t", "[assignment-2]") {
+  // Small, multi-threaded and streaming sizes (misaligned by one element).
+  size_t n = GENERATE(size_t(10), size_t(1) << 16, (size_t(1) << 20) + 3);
+  auto u = RandomVector<double>(n + 1, -1, 1);
+  auto v = RandomVector<double>(n + 1, -1, 1);
+  SECTION("ScalarMul_t") {
+    auto truth = u;
+    tutor::ScalarMul(truth.data() + 1, n, 3.0);
+    tutor::ScalarMul_t(u.data() + 1, n, 3.0);
+    RequireEqual(u, truth);
+  }
+  SECTION("VectorSum_t") {
+    std::vector<double> truth(n + 1), result(n + 1);
+    tutor::VectorSum(truth.data() + 1, u.data(), v.data() + 1, n);
+    tutor::VectorSum_t(result.data() + 1, u.data(), v.data() + 1, n);
+    RequireEqual(result, truth);
+  }
+  SECTION("Accumulate_t") {
+    double truth = tutor::Accumulate(u.data() + 1, n);
+    double result = tutor::Accumulate_t(u.data() + 1, n);
+    REQUIRE_THAT(result, WithinAbs(truth, 1e-9 * n));
+  }
+  SECTION("Inner_t") {
+    double truth = tutor::Inner(u.data(), v.data() + 1, n);
+    double result = tutor::Inner_t(u.data(), v.data() + 1, n);
+    REQUIRE_THAT(result, WithinAbs(truth, 1e-9 * n));
+  }
+  SECTION("Integer reductions are exact") {
+    auto w = RandomVector<int>(n, -100, 100);
+    REQUIRE(tutor::Accumulate_t(w.data(), n) ==
+            tutor::Accumulate(w.data(), n));
+    REQUIRE(tutor::Inner_t(w.data(), w.data(), n) ==
+            tutor::Inner(w.data(), w.data(), n));
+  }
+}
+
+TEST_CASE("Reproducible reductions _rt", "[assignment-2]") {
+  size_t n = GENERATE(size_t(100), (size_t(1) << 17) + 5);
+  auto u = RandomVector<double>(n, -1, 1);
+  auto v = RandomVector<double>(n, -1e3, 1e3);
+  double sum = tutor::Accumulate_r(u.data(), n);
+  double inner = tutor::Inner_r(u.data(), v.data(), n);
+  int maxThreads = omp_get_max_threads();
+  for (int threads : {1, 2, 3, 8}) {
+    omp_set_num_threads(threads);
+    REQUIRE(tutor::Accumulate_rt(u.data(), n) == sum);
+    REQUIRE(tutor::Inner_rt(u.data(), v.data(), n) == inner);
+  }
+  omp_set_num_threads(maxThreads);
+}
+
 TEST_CASE("Find_t", "[assignment-2]") {
   constexpr size_t n = 100;
   GIVEN("Vector is random") {
@@ -67,6 +120,19 @@ TEST_CASE("MatrixEval_t", "[assignment-2]") {
   RequireEqual(result, truth);
 }
 
+TEST_CASE("Multi-vector MatrixEval_t", "[builtin-linalg]") {
+  constexpr size_t n = 150;
+  constexpr size_t m = 40;
+  constexpr size_t k = 9;
+  auto mat = RandomMatrix<int>(n, m, 0, 10);
+  auto vs = RandomMatrix<int>(m, k, 0, 10);
+  auto truth = Matrix<int>(n, k);
+  auto result = Matrix<int>(n, k);
+  tutor::MatrixEval(truth.view(), mat.view(), vs.view());
+  tutor::MatrixEval_t(result.view(), mat.view(), vs.view());
+  RequireEqual(result, truth);
+}
+
 TEST_CASE("Gemm_t", "[assignment-2]") {
   constexpr size_t n = 10;
   constexpr size_t m = 15;
@@ -79,3 +145,80 @@ TEST_CASE("Gemm_t", "[assignment-2]") {
   tutor::Gemm_t(result.view(), lhs.view(), rhs.view());
   RequireEqual(result, truth);
 }
+
+TEST_CASE("LuFact_t", "[builtin-linalg]") {
+  constexpr size_t n = 67;
+  auto m = RandomMatrix<double>(n, n);
+  // Diagonal dominance guarantees that the unpivoted LU exists.
+  for (size_t i = 0; i < n; ++i) m[i][i] += n;
+  auto lu = m;
+  size_t bs = GENERATE(1, 8, 16, 30, 67);
+  INFO("bs = " << bs);
+  tutor::LuFact_t(lu.view(), bs);
+  auto l = Matrix<double>(n, n);
+  auto u = Matrix<double>(n, n);
+  auto mul = Matrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      (j < i ? l[i][j] : u[i][j]) = lu[i][j];
+    }
+    l[i][i] = 1;
+  }
+  tutor::Gemm(mul.view(), l.view(), u.view());
+  RequireEqual(mul, m);
+}
+
+TEST_CASE("Cholesky_t", "[builtin-linalg]") {
+  constexpr size_t n = 67;
+  auto m = RandomSpdMatrix<double>(n);
+  auto chol = m;
+  tutor::Cholesky_b(m.view(), 16);
+  size_t bs = GENERATE(1, 8, 16, 30, 67);
+  INFO("bs = " << bs);
+  tutor::Cholesky_t(chol.view(), bs);
+  RequireEqual(chol, m);
+}
+
+TEST_CASE("QrFact_t", "[builtin-linalg]") {
+  constexpr size_t n = 300;
+  constexpr size_t m = 70;
+  auto a = RandomMatrix<double>(n, m, -1, 1);
+  auto qr = a;
+  std::vector<double> tau(m), tauT(m);
+  tutor::QrFact_b(a.view(), tau.data(), 16);
+  size_t bs = GENERATE(1, 16, 32);
+  INFO("bs = " << bs);
+  tutor::QrFact_t(qr.view(), tauT.data(), bs);
+  RequireEqual(qr, a);
+  RequireEqual(tauT, tau);
+}
+
+TEST_CASE("Tsqr_t", "[builtin-linalg]") {
+  constexpr size_t n = 1000;
+  constexpr size_t m = 12;
+  size_t leaves = GENERATE(1, 2, 3, 5, 8, 0);
+  INFO("leaves = " << leaves);
+  auto a = RandomMatrix<double>(n, m, -1, 1);
+  auto truth = RandomVector<double>(m, -1, 1);
+  auto noise = RandomVector<double>(n, -1e-3, 1e-3);
+  std::vector<double> b(n), tau(m), expected(m), result(m);
+  tutor::MatrixEval(b.data(), a.view(), truth.data());
+  for (size_t i = 0; i < n; ++i) b[i] += noise[i];
+  auto qr = a;
+  tutor::QrFact_b(qr.view(), tau.data(), 4);
+  tutor::QrSolve(expected.data(), qr.view(), tau.data(), b.data());
+
+  auto tsqr = tutor::Tsqr_t(a.view(), leaves, 4);
+  if (leaves != 0) REQUIRE(tsqr.leaves() == leaves);
+  // R is unique up to the signs of its rows.
+  auto r = tsqr.r();
+  for (size_t i = 0; i < m; ++i) {
+    double sign = (r[i][i] < 0) == (qr[i][i] < 0) ? 1 : -1;
+    for (size_t j = 0; j < m; ++j) {
+      INFO("R differs at " << i << ", " << j);
+      REQUIRE_THAT(sign * r[i][j], WithinAbs(j < i ? 0 : qr[i][j], 1e-9));
+    }
+  }
+  tsqr.Solve(result.data(), b.data());
+  RequireEqual(result, expected);
+}
@@ -0,0 +1,98 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "hpc_tutor/async.hpp"
+#include "hpc_tutor/linalg.hpp"
+#include "hpc_tutor/matrix.hpp"
+#include "test_utils.hpp"
+
+TEST_CASE("Async tasks respect read/write dependencies", "[async]") {
+  tutor::ThreadPool pool(4, false);
+  std::vector<int> x(16, 0);
+  auto slowWrite = tutor::Async(pool, {tutor::Access::Write(x.data(), 8)}, [&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    x[0] = 1;
+  });
+  auto read = tutor::Async(pool, {tutor::Access::Read(x.data(), 1)},
+                           [&] { return x[0]; });
+  auto overwrite = tutor::Async(pool, {tutor::Access::Write(x.data(), 1)},
+                                [&] { x[0] = 2; });
+  auto disjoint = tutor::Async(pool, {tutor::Access::Write(x.data() + 8, 8)},
+                               [&] { x[8] = 3; });
+  REQUIRE(read.get() == 1);
+  overwrite.get();
+  disjoint.get();
+  slowWrite.get();
+  REQUIRE(x[0] == 2);
+  REQUIRE(x[8] == 3);
+}
+
+TEST_CASE("Async linalg pipeline", "[async]") {
+  constexpr size_t n = 40;
+  auto lhs = RandomMatrix<double>(n, n);
+  auto rhs = RandomMatrix<double>(n, n);
+  auto v = RandomVector<double>(n);
+  auto w = RandomVector<double>(200);
+  auto sorted = w;
+  tutor::MergeSort(sorted.data(), sorted.size());
+  auto prod = Matrix<double>(n, n);
+  auto truthProd = Matrix<double>(n, n);
+  std::vector<double> eval(n), truthEval(n);
+  tutor::Gemm(truthProd.view(), lhs.view(), rhs.view());
+  tutor::MatrixEval(truthEval.data(), truthProd.view(), v.data());
+
+  auto gemm = tutor::GemmAsync(prod.view(), lhs.view(), rhs.view());
+  auto sort = tutor::MergeSortAsync(w.data(), w.size());
+  // Reads `prod`, so it must wait for the Gemm.
+  auto mv = tutor::MatrixEvalAsync(eval.data(), prod.view(), v.data());
+  mv.get();
+  sort.get();
+  REQUIRE(gemm.ready());
+  RequireEqual(prod, truthProd);
+  RequireEqual(eval, truthEval);
+  RequireEqual(w, sorted);
+}
+
+TEST_CASE("Async propagates exceptions", "[async]") {
+  auto f = tutor::Async({}, []() -> int { throw std::runtime_error("boom"); });
+  REQUIRE_THROWS_AS(f.get(), std::runtime_error);
+}
+
+#ifdef HPC_TUTOR_HAS_COROUTINES
+namespace {
+
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+tutor::Future<int> ReadAsync(std::vector<int>* v, size_t i) {
+  return tutor::Async({tutor::Access::Read(v->data() + i, 1)},
+                      [v, i] { return (*v)[i]; });
+}
+
+Detached SumAsync(std::vector<int>* v, std::atomic<int>* out) {
+  int a = co_await ReadAsync(v, 0);
+  int b = co_await ReadAsync(v, 1);
+  out->store(a + b);
+}
+
+}  // namespace
+
+TEST_CASE("Futures can be awaited", "[async]") {
+  std::vector<int> v{20, 22};
+  std::atomic<int> out{0};
+  SumAsync(&v, &out);
+  while (out.load() == 0) std::this_thread::yield();
+  REQUIRE(out.load() == 42);
+}
+#endif
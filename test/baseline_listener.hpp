@@ -0,0 +1,61 @@
+#ifndef HPC_TUTOR_BASELINE_LISTENER_HPP_
+#define HPC_TUTOR_BASELINE_LISTENER_HPP_
+
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/baseline.hpp"
+
+/**
+ * Records the sample times of every benchmark to the file named by
+ * the environment variable `HPC_TUTOR_BENCHMARK_RESULTS`, if set,
+ * for benchmark_compare.cpp to check against a baseline.
+ *
+ * Benchmarks are named "<test case>: <benchmark>", as several test
+ * cases reuse benchmark names. Results of earlier runs in the file
+ * are kept unless rerun, so several programs can share one file.
+ */
+class BaselineListener : public Catch::EventListenerBase {
+ public:
+  using EventListenerBase::EventListenerBase;
+
+  void testCaseStarting(const Catch::TestCaseInfo& info) override {
+    testCase_ = info.name;
+  }
+
+  void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override {
+    std::vector<double> seconds;
+    seconds.reserve(stats.samples.size());
+    for (const auto& s : stats.samples) {
+      seconds.push_back(std::chrono::duration<double>(s).count());
+    }
+    results_.Set(testCase_ + ": " + stats.info.name, std::move(seconds));
+  }
+
+  void testRunEnded(const Catch::TestRunStats&) override {
+    const char* path = std::getenv("HPC_TUTOR_BENCHMARK_RESULTS");
+    if (path == nullptr || results_.empty()) return;
+    tutor::BenchmarkResults all;
+    if (std::filesystem::exists(path)) {
+      all = tutor::BenchmarkResults::Read(std::string(path));
+    }
+    all.Merge(results_);
+    all.Write(std::string(path));
+    std::printf("\nRecorded %zu benchmarks to %s\n",
+                results_.samples().size(), path);
+  }
+
+ private:
+  std::string testCase_;
+  tutor::BenchmarkResults results_;
+};
+
+CATCH_REGISTER_LISTENER(BaselineListener)
+
+#endif  // HPC_TUTOR_BASELINE_LISTENER_HPP_
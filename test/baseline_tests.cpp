@@ -0,0 +1,127 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/baseline.hpp"
+
+namespace {
+
+using Status = tutor::BenchmarkChange::Status;
+
+/**
+ * `n` times around `median`, spread by +-5%.
+ */
+std::vector<double> Samples(double median, size_t n) {
+  std::vector<double> ret;
+  for (size_t i = 0; i < n; ++i) {
+    ret.push_back(median * (0.95 + 0.1 * i / (n - 1.0)));
+  }
+  return ret;
+}
+
+}  // namespace
+
+TEST_CASE("Mann-Whitney test", "[baseline]") {
+  SECTION("Separated samples") {
+    std::vector<double> x{5, 6, 7, 8, 9, 10, 11, 12};
+    std::vector<double> y{1, 2, 3, 4};
+    auto t = tutor::MannWhitney(x, y);
+    REQUIRE(t.u == 32);
+    REQUIRE(t.z > 2.5);
+    REQUIRE(t.pGreater < 0.01);
+    REQUIRE(t.pLess > 0.99);
+    auto r = tutor::MannWhitney(y, x);
+    REQUIRE(r.u == 0);
+    REQUIRE(std::abs(r.pLess - t.pGreater) < 1e-15);
+  }
+
+  SECTION("Ties") {
+    // Mean ranks 2, 5.5, 9.5 and 12: U = 53.5 - 7 * 8 / 2,
+    // sd = sqrt(7 * 5 / 12 * (13 - (24 + 60 + 60) / (12 * 11))).
+    std::vector<double> x{1, 2, 2, 3, 3, 3, 4};
+    std::vector<double> y{1, 1, 2, 2, 3};
+    auto t = tutor::MannWhitney(x, y);
+    REQUIRE(t.u == 25.5);
+    REQUIRE(std::abs(t.pGreater - 0.101587) < 1e-6);
+  }
+
+  SECTION("Identical samples") {
+    std::vector<double> x(10, 1.0);
+    auto t = tutor::MannWhitney(x, x);
+    REQUIRE(t.pGreater == 0.5);
+    REQUIRE(t.pLess == 0.5);
+  }
+}
+
+TEST_CASE("Median", "[baseline]") {
+  REQUIRE(tutor::Median({}) == 0);
+  REQUIRE(tutor::Median({3, 1, 2}) == 2);
+  REQUIRE(tutor::Median({4, 1, 3, 2}) == 2.5);
+}
+
+TEST_CASE("Benchmark results files", "[baseline]") {
+  tutor::BenchmarkResults r;
+  r.Set("Vector Kernel Benchmarks: Inner-500^2", {1e-3, 1.25e-3, 0.1});
+  r.Set("x", {});
+  std::stringstream file;
+  file << "# comment\n\n";
+  r.Write(file);
+  auto read = tutor::BenchmarkResults::Read(file);
+  REQUIRE(read.samples() == r.samples());
+
+  tutor::BenchmarkResults other;
+  other.Set("x", {2});
+  other.Set("y", {3});
+  read.Merge(other);
+  REQUIRE(read.samples().size() == 3);
+  REQUIRE(read.samples().at("x") == std::vector<double>{2});
+
+  for (const char* bad : {"samples 2 1 name\n", "samples 1 1\n",
+                          "sample 1 1 name\n"}) {
+    std::istringstream is(bad);
+    REQUIRE_THROWS_AS(tutor::BenchmarkResults::Read(is),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("Benchmark comparison", "[baseline]") {
+  tutor::BenchmarkResults baseline, current;
+  baseline.Set("same", Samples(1.0, 20));
+  current.Set("same", Samples(1.01, 20));
+  baseline.Set("slower", Samples(1.0, 20));
+  current.Set("slower", Samples(1.2, 20));
+  baseline.Set("faster", Samples(1.0, 20));
+  current.Set("faster", Samples(0.8, 20));
+  // Significant, but below the threshold.
+  baseline.Set("slightly slower", Samples(1.0, 20));
+  current.Set("slightly slower", Samples(1.03, 20));
+  // Above the threshold, but too few samples to tell.
+  baseline.Set("noisy", {1.0, 1.3});
+  current.Set("noisy", {1.4, 1.5});
+  baseline.Set("removed", {1.0});
+  current.Set("added", {1.0});
+
+  auto changes = tutor::CompareBenchmarks(baseline, current);
+  std::map<std::string, tutor::BenchmarkChange> byName;
+  for (const auto& c : changes) byName[c.name] = c;
+  REQUIRE(changes.size() == 7);
+  REQUIRE(byName["same"].status == Status::kUnchanged);
+  REQUIRE(byName["slower"].status == Status::kRegressed);
+  REQUIRE(std::abs(byName["slower"].ratio - 1.2) < 1e-12);
+  REQUIRE(byName["faster"].status == Status::kImproved);
+  REQUIRE(byName["slightly slower"].status == Status::kUnchanged);
+  REQUIRE(byName["slightly slower"].test.pGreater < 0.01);
+  REQUIRE(byName["noisy"].status == Status::kUnchanged);
+  REQUIRE(byName["removed"].status == Status::kMissing);
+  REQUIRE(byName["added"].status == Status::kNew);
+
+  tutor::RegressionOptions strict;
+  strict.threshold = 0.02;
+  for (const auto& c : tutor::CompareBenchmarks(baseline, current, strict)) {
+    if (c.name == "slightly slower") REQUIRE(c.status == Status::kRegressed);
+  }
+}
@@ -0,0 +1,95 @@
+// Compares benchmark results with a baseline (see hpc_tutor/baseline.hpp)
+// and fails if any benchmark regressed.
+//
+//   benchmark_compare <baseline> <results> [--threshold 0.1]
+//                     [--alpha 0.01]
+//
+// Both files are recorded by the benchmark programs through
+// baseline_listener.hpp. It prints one line per benchmark and exits
+// with 1 if one regressed, 2 on usage errors, and 0 otherwise.
+// Benchmarks missing from the results are reported but do not fail,
+// so that runs can be filtered.
+
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/baseline.hpp"
+
+namespace {
+
+struct Options {
+  std::string baseline;
+  std::string results;
+  tutor::RegressionOptions regression;
+};
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--", 0) != 0) {
+      files.push_back(arg);
+      continue;
+    }
+    if (i + 1 == argc) throw std::invalid_argument("missing value of " + arg);
+    std::string value = argv[++i];
+    if (arg == "--threshold") {
+      options.regression.threshold = std::stod(value);
+    } else if (arg == "--alpha") {
+      options.regression.alpha = std::stod(value);
+    } else {
+      throw std::invalid_argument("unknown option " + arg);
+    }
+  }
+  if (files.size() != 2) throw std::invalid_argument("expected two files");
+  options.baseline = files[0];
+  options.results = files[1];
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  tutor::BenchmarkResults baseline, results;
+  try {
+    options = ParseOptions(argc, argv);
+    baseline = tutor::BenchmarkResults::Read(options.baseline);
+    results = tutor::BenchmarkResults::Read(options.results);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr,
+                 "%s\nusage: %s <baseline> <results> [--threshold t] "
+                 "[--alpha a]\n",
+                 e.what(), argv[0]);
+    return 2;
+  }
+
+  auto changes =
+      tutor::CompareBenchmarks(baseline, results, options.regression);
+  std::printf("%-10s %12s %12s %8s %9s  %s\n", "status", "baseline ms",
+              "current ms", "change", "p-value", "benchmark");
+  size_t regressed = 0;
+  for (const auto& c : changes) {
+    using Status = tutor::BenchmarkChange::Status;
+    double p = c.ratio >= 1 ? c.test.pGreater : c.test.pLess;
+    bool compared = c.status != Status::kNew && c.status != Status::kMissing;
+    std::printf("%-10s %12.4f %12.4f", tutor::StatusName(c.status),
+                1e3 * c.baseline, 1e3 * c.current);
+    if (compared) {
+      std::printf(" %+7.1f%% %9.2g", 100 * (c.ratio - 1), p);
+    } else {
+      std::printf(" %8s %9s", "-", "-");
+    }
+    std::printf("  %s\n", c.name.c_str());
+    regressed += c.status == Status::kRegressed;
+  }
+  std::printf("\n%zu of %zu benchmarks regressed (threshold %.1f%%, "
+              "alpha %g)\n",
+              regressed, changes.size(), 100 * options.regression.threshold,
+              options.regression.alpha);
+  return regressed == 0 ? 0 : 1;
+}
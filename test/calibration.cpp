@@ -0,0 +1,629 @@
+// Measures the ceilings of the machine and writes them as a roofline
+// profile (see hpc_tutor/roofline.hpp), which the benchmarks read
+// to report their results as a percentage of the attainable time.
+//
+//   calibration [--output roofline.txt] [--threads 1,2,4]
+//               [--elements 33554432] [--seconds 0.02]
+//
+// It measures:
+//  - the STREAM copy, scale, add and triad kernels per thread count,
+//    unbound and bound to each NUMA node,
+//  - the read bandwidth of working sets from 4 KiB up to memory,
+//    which shows the bandwidth of each cache level,
+//  - the peak FMA throughput at the kernel instruction set level
+//    (see hpc_tutor/cpu.hpp).
+
+#include <omp.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "hpc_tutor/cpu.hpp"
+#include "hpc_tutor/roofline.hpp"
+
+namespace {
+
+struct Options {
+  std::string output = "roofline.txt";
+  std::vector<size_t> threads;
+  size_t elements = size_t(1) << 25;  ///< Of each STREAM array.
+  double seconds = 0.02;              ///< Shortest timed batch.
+};
+
+constexpr int kTrials = 5;
+
+/**
+ * Keeps the compiler from merging or removing repeated kernel calls.
+ */
+inline void Clobber() {
+#if defined(__GNUC__)
+  asm volatile("" ::: "memory");
+#endif
+}
+
+/**
+ * Binds the calling thread to one CPU of `cpus`, chosen by its thread
+ * number, and restores its previous affinity on destruction.
+ * Does nothing if `cpus` is empty or on systems other than Linux.
+ */
+class Binding {
+ public:
+  explicit Binding(const std::vector<int>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) return;
+    bound_ = sched_getaffinity(0, sizeof(saved_), &saved_) == 0;
+    if (!bound_) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[omp_get_thread_num() % cpus.size()], &set);
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    static_cast<void>(cpus);
+#endif
+  }
+
+  ~Binding() {
+#ifdef __linux__
+    if (bound_) sched_setaffinity(0, sizeof(saved_), &saved_);
+#endif
+  }
+
+  Binding(const Binding&) = delete;
+  Binding& operator=(const Binding&) = delete;
+
+ private:
+#ifdef __linux__
+  cpu_set_t saved_;
+  bool bound_ = false;
+#endif
+};
+
+/**
+ * Parses a Linux CPU list such as "0-3,8-11".
+ */
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> ret;
+  std::istringstream is(list);
+  std::string range;
+  while (std::getline(is, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    size_t dash = range.find('-');
+    int lo = std::stoi(range.substr(0, dash));
+    int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+    for (int cpu = lo; cpu <= hi; ++cpu) ret.push_back(cpu);
+  }
+  return ret;
+}
+
+/**
+ * Returns the CPUs of each NUMA node with CPUs, by node id, from sysfs.
+ * Node ids may have gaps, and memory-only nodes are left out.
+ * Empty if the system does not describe its nodes.
+ */
+std::map<int, std::vector<int>> NumaNodes() {
+  std::map<int, std::vector<int>> ret;
+  std::error_code error;
+  std::filesystem::directory_iterator dir("/sys/devices/system/node", error);
+  for (; !error && dir != std::filesystem::directory_iterator();
+       dir.increment(error)) {
+    std::string name = dir->path().filename().string();
+    if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+        name.find_first_not_of("0123456789", 4) != std::string::npos) {
+      continue;
+    }
+    std::ifstream file(dir->path() / "cpulist");
+    std::string list;
+    if (!std::getline(file, list)) continue;
+    auto cpus = ParseCpuList(list);
+    if (!cpus.empty()) ret[std::stoi(name.substr(4))] = std::move(cpus);
+  }
+  return ret;
+}
+
+/**
+ * Returns the size in bytes of a data cache level, 0 if unknown.
+ */
+size_t CacheBytes(int level) {
+  long bytes = 0;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+  switch (level) {
+    case 1:
+      bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+      break;
+    case 2:
+      bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+      break;
+    case 3:
+      bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+      break;
+  }
+#else
+  static_cast<void>(level);
+#endif
+  return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+}
+
+/**
+ * Runs `kernel(state, reps)` on `threads` threads bound to `cpus`,
+ * where each thread gets its own `state = init()`,
+ * so its pages are first touched, and placed, by the thread itself.
+ *
+ * Returns the best time of one repetition, in seconds:
+ * the repetitions of a batch grow until it lasts `options.seconds`,
+ * then the best of `kTrials` batches is kept.
+ * Threads start and stop each batch together.
+ */
+template <typename Init, typename Kernel>
+double BestSeconds(size_t threads, const std::vector<int>& cpus,
+                   const Options& options, const Init& init,
+                   const Kernel& kernel) {
+  double best = std::numeric_limits<double>::infinity();
+  double elapsed = 0;
+#pragma omp parallel num_threads(threads)
+  {
+    Binding binding(cpus);
+    auto state = init();
+    auto batch = [&](size_t reps) {
+#pragma omp barrier
+      double start = omp_get_wtime();
+      kernel(state, reps);
+#pragma omp barrier
+#pragma omp master
+      elapsed = omp_get_wtime() - start;
+#pragma omp barrier
+      return elapsed;
+    };
+    size_t reps = 1;
+    while (batch(reps) < options.seconds) reps *= 2;
+    for (int trial = 0; trial < kTrials; ++trial) {
+      double seconds = batch(reps) / reps;
+#pragma omp master
+      best = std::min(best, seconds);
+    }
+  }
+  return best;
+}
+
+/**
+ * Arrays of a STREAM kernel, private to a thread.
+ */
+struct StreamArrays {
+  explicit StreamArrays(size_t n) : a(n, 1.0), b(n, 2.0), c(n, 0.0) {}
+  std::vector<double> a, b, c;
+};
+
+struct StreamKernel {
+  const char* name;
+  int arrays;  ///< Arrays read or written, for the byte count.
+};
+
+constexpr StreamKernel kStreamKernels[] = {
+    {"copy", 2}, {"scale", 2}, {"add", 3}, {"triad", 3}};
+
+void RunStream(int kernel, StreamArrays& s, size_t reps) {
+  constexpr double kScalar = 3.0;
+  size_t n = s.a.size();
+  double* a = s.a.data();
+  double* b = s.b.data();
+  double* c = s.c.data();
+  tutor::detail::Dispatch([&] {
+    for (size_t r = 0; r < reps; ++r) {
+      switch (kernel) {
+        case 0:
+          for (size_t i = 0; i < n; ++i) c[i] = a[i];
+          break;
+        case 1:
+          for (size_t i = 0; i < n; ++i) b[i] = kScalar * c[i];
+          break;
+        case 2:
+          for (size_t i = 0; i < n; ++i) c[i] = a[i] + b[i];
+          break;
+        default:
+          for (size_t i = 0; i < n; ++i) a[i] = b[i] + kScalar * c[i];
+          break;
+      }
+      Clobber();
+    }
+  });
+}
+
+// Kernels of the read sweep and of the peak, one per instruction set level:
+// their throughput must not depend on what the compiler vectorizes.
+// Independent chains of operations in registers hide the latency of
+// the units, so the loads or the FMA units are the bottleneck.
+
+constexpr int kChains = 12;
+
+/**
+ * Returns the doubles per vector of the kernels of `DetectIsa`.
+ */
+size_t Lanes() {
+  switch (tutor::DetectIsa()) {
+#ifdef HPC_TUTOR_X86_KERNELS
+    case tutor::Isa::kAvx512:
+      return 8;
+    case tutor::Isa::kAvx2:
+      return 4;
+#endif
+    default:
+#ifdef __SSE2__
+      return 2;
+#else
+      return 1;
+#endif
+  }
+}
+
+#ifdef __SSE2__
+
+double RunReadBaseline(const double* x, size_t n, size_t reps) {
+  __m128d acc[kChains];
+  for (auto& a : acc) a = _mm_setzero_pd();
+  for (size_t r = 0; r < reps; ++r) {
+    for (size_t i = 0; i + 2 * kChains <= n; i += 2 * kChains) {
+#pragma GCC unroll 16
+      for (int k = 0; k < kChains; ++k) {
+        acc[k] = _mm_add_pd(acc[k], _mm_loadu_pd(x + i + 2 * k));
+      }
+    }
+    Clobber();
+  }
+  for (int k = 1; k < kChains; ++k) acc[0] = _mm_add_pd(acc[0], acc[k]);
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc[0]);
+  return lanes[0] + lanes[1];
+}
+
+/**
+ * Multiply and add, 2 FLOPs per lane, as SSE2 has no FMA.
+ */
+double RunPeakBaseline(size_t reps) {
+  __m128d acc[kChains], a = _mm_set1_pd(0.999), b = _mm_set1_pd(0.001);
+  for (int k = 0; k < kChains; ++k) acc[k] = _mm_set1_pd(k);
+  for (size_t r = 0; r < reps * 1024; ++r) {
+#pragma GCC unroll 16
+    for (int k = 0; k < kChains; ++k) {
+      acc[k] = _mm_add_pd(_mm_mul_pd(acc[k], a), b);
+    }
+  }
+  for (int k = 1; k < kChains; ++k) acc[0] = _mm_add_pd(acc[0], acc[k]);
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc[0]);
+  return lanes[0] + lanes[1];
+}
+
+#else
+
+double RunReadBaseline(const double* x, size_t n, size_t reps) {
+  double acc[kChains] = {};
+  for (size_t r = 0; r < reps; ++r) {
+    for (size_t i = 0; i + kChains <= n; i += kChains) {
+#pragma GCC unroll 16
+      for (int k = 0; k < kChains; ++k) acc[k] += x[i + k];
+    }
+    Clobber();
+  }
+  double sum = 0;
+  for (double a : acc) sum += a;
+  return sum;
+}
+
+double RunPeakBaseline(size_t reps) {
+  double acc[kChains], a = 0.999, b = 0.001;
+  for (int k = 0; k < kChains; ++k) acc[k] = k;
+  for (size_t r = 0; r < reps * 1024; ++r) {
+#pragma GCC unroll 16
+    for (int k = 0; k < kChains; ++k) acc[k] = acc[k] * a + b;
+  }
+  double sum = 0;
+  for (double v : acc) sum += v;
+  return sum;
+}
+
+#endif  // __SSE2__
+
+#ifdef HPC_TUTOR_X86_KERNELS
+
+__attribute__((target("avx2,fma"))) double RunReadAvx2(const double* x,
+                                                        size_t n,
+                                                        size_t reps) {
+  __m256d acc[kChains];
+  for (auto& a : acc) a = _mm256_setzero_pd();
+  for (size_t r = 0; r < reps; ++r) {
+    for (size_t i = 0; i + 4 * kChains <= n; i += 4 * kChains) {
+#pragma GCC unroll 16
+      for (int k = 0; k < kChains; ++k) {
+        acc[k] = _mm256_add_pd(acc[k], _mm256_loadu_pd(x + i + 4 * k));
+      }
+    }
+    Clobber();
+  }
+  for (int k = 1; k < kChains; ++k) acc[0] = _mm256_add_pd(acc[0], acc[k]);
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc[0]);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx2,fma"))) double RunPeakAvx2(size_t reps) {
+  __m256d acc[kChains], a = _mm256_set1_pd(0.999), b = _mm256_set1_pd(0.001);
+  for (int k = 0; k < kChains; ++k) acc[k] = _mm256_set1_pd(k);
+  for (size_t r = 0; r < reps * 1024; ++r) {
+#pragma GCC unroll 16
+    for (int k = 0; k < kChains; ++k) acc[k] = _mm256_fmadd_pd(acc[k], a, b);
+  }
+  for (int k = 1; k < kChains; ++k) acc[0] = _mm256_add_pd(acc[0], acc[k]);
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc[0]);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// GCC 12 warns about the undefined upper halves in _mm512_reduce_add_pd.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f"))) double RunReadAvx512(const double* x,
+                                                         size_t n,
+                                                         size_t reps) {
+  __m512d acc[kChains];
+  for (auto& a : acc) a = _mm512_setzero_pd();
+  for (size_t r = 0; r < reps; ++r) {
+    for (size_t i = 0; i + 8 * kChains <= n; i += 8 * kChains) {
+#pragma GCC unroll 16
+      for (int k = 0; k < kChains; ++k) {
+        acc[k] = _mm512_add_pd(acc[k], _mm512_loadu_pd(x + i + 8 * k));
+      }
+    }
+    Clobber();
+  }
+  for (int k = 1; k < kChains; ++k) acc[0] = _mm512_add_pd(acc[0], acc[k]);
+  return _mm512_reduce_add_pd(acc[0]);
+}
+
+__attribute__((target("avx512f"))) double RunPeakAvx512(size_t reps) {
+  __m512d acc[kChains], a = _mm512_set1_pd(0.999), b = _mm512_set1_pd(0.001);
+  for (int k = 0; k < kChains; ++k) acc[k] = _mm512_set1_pd(k);
+  for (size_t r = 0; r < reps * 1024; ++r) {
+#pragma GCC unroll 16
+    for (int k = 0; k < kChains; ++k) acc[k] = _mm512_fmadd_pd(acc[k], a, b);
+  }
+  for (int k = 1; k < kChains; ++k) acc[0] = _mm512_add_pd(acc[0], acc[k]);
+  return _mm512_reduce_add_pd(acc[0]);
+}
+
+#pragma GCC diagnostic pop
+
+#endif  // HPC_TUTOR_X86_KERNELS
+
+/**
+ * Sums `x` `reps` times. Reads the multiples of `Lanes() * kChains`.
+ */
+double RunRead(const std::vector<double>& x, size_t reps) {
+  switch (tutor::DetectIsa()) {
+#ifdef HPC_TUTOR_X86_KERNELS
+    case tutor::Isa::kAvx512:
+      return RunReadAvx512(x.data(), x.size(), reps);
+    case tutor::Isa::kAvx2:
+      return RunReadAvx2(x.data(), x.size(), reps);
+#endif
+    default:
+      return RunReadBaseline(x.data(), x.size(), reps);
+  }
+}
+
+/**
+ * Runs `reps` repetitions of 1024 multiply-adds per chain.
+ */
+double RunPeak(size_t reps) {
+  switch (tutor::DetectIsa()) {
+#ifdef HPC_TUTOR_X86_KERNELS
+    case tutor::Isa::kAvx512:
+      return RunPeakAvx512(reps);
+    case tutor::Isa::kAvx2:
+      return RunPeakAvx2(reps);
+#endif
+    default:
+      return RunPeakBaseline(reps);
+  }
+}
+
+/**
+ * Returns the FLOPs of one repetition of `RunPeak`.
+ */
+double PeakFlops() { return 2.0 * kChains * Lanes() * 1024; }
+
+/**
+ * Keeps the results of the kernels alive.
+ */
+volatile double sink;
+
+std::string Bytes(size_t bytes) {
+  const char* units[] = {"B", "KiB", "MiB", "GiB"};
+  int u = 0;
+  while (u < 3 && bytes >= 1024 && bytes % 1024 == 0) {
+    bytes /= 1024;
+    ++u;
+  }
+  return std::to_string(bytes) + " " + units[u];
+}
+
+/**
+ * Returns the smallest cache level holding `bytes` per thread,
+ * as a label.
+ */
+std::string Level(size_t bytes) {
+  for (int level = 1; level <= 3; ++level) {
+    size_t cache = CacheBytes(level);
+    if (cache != 0 && bytes <= cache) return "L" + std::to_string(level);
+  }
+  return "memory";
+}
+
+void MeasureStream(const Options& options, int node,
+                   const std::vector<int>& cpus, size_t threads,
+                   tutor::Roofline& roofline) {
+  size_t n = options.elements / threads;
+  std::printf("%-8s %4d %8zu", node < 0 ? "any" : "bound", node, threads);
+  for (int k = 0; k < 4; ++k) {
+    double seconds = BestSeconds(
+        threads, cpus, options, [&] { return StreamArrays(n); },
+        [&](StreamArrays& s, size_t reps) { RunStream(k, s, reps); });
+    double bytes = 1.0 * kStreamKernels[k].arrays * sizeof(double) * n *
+                   threads;
+    roofline.Add(tutor::StreamSample{kStreamKernels[k].name, node, threads,
+                                     bytes / seconds});
+    std::printf(" %10.1f", bytes / seconds / 1e9);
+  }
+  std::printf("\n");
+}
+
+void MeasureSweep(const Options& options, size_t threads,
+                  tutor::Roofline& roofline) {
+  size_t largest = 3 * options.elements * sizeof(double);
+  for (size_t bytes = size_t(4) << 10; bytes <= largest; bytes *= 2) {
+    size_t block = Lanes() * kChains;
+    size_t n = bytes / sizeof(double) / threads / block * block;
+    if (n == 0) continue;
+    double seconds = BestSeconds(
+        threads, {}, options, [&] { return std::vector<double>(n, 1.0); },
+        [&](const std::vector<double>& x, size_t reps) {
+          sink = RunRead(x, reps);
+        });
+    double rate = 1.0 * n * sizeof(double) * threads / seconds;
+    roofline.Add(tutor::BandwidthSample{threads, bytes, rate});
+    std::printf("%8zu %12s %-8s %10.1f\n", threads, Bytes(bytes).c_str(),
+                Level(bytes / threads).c_str(), rate / 1e9);
+  }
+}
+
+void MeasurePeak(const Options& options, size_t threads,
+                 tutor::Roofline& roofline) {
+  double seconds = BestSeconds(
+      threads, {}, options, [] { return 0; },
+      [](int, size_t reps) { sink = RunPeak(reps); });
+  double flops = PeakFlops() * threads / seconds;
+  roofline.SetPeak(threads, flops);
+  std::printf("%8zu %12.1f %12.1f\n", threads, flops / 1e9,
+              flops / 1e9 / threads);
+}
+
+std::vector<size_t> ParseThreads(const std::string& list) {
+  std::vector<size_t> ret;
+  for (int cpu : ParseCpuList(list)) {
+    if (cpu <= 0) throw std::invalid_argument("thread counts must be > 0");
+    ret.push_back(static_cast<size_t>(cpu));
+  }
+  return ret;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 == argc) throw std::invalid_argument("missing value of " + arg);
+    std::string value = argv[++i];
+    if (arg == "--output") {
+      options.output = value;
+    } else if (arg == "--threads") {
+      options.threads = ParseThreads(value);
+    } else if (arg == "--elements") {
+      options.elements = std::stoull(value);
+    } else if (arg == "--seconds") {
+      options.seconds = std::stod(value);
+    } else {
+      throw std::invalid_argument("unknown option " + arg);
+    }
+  }
+  if (options.threads.empty()) {
+    size_t max = omp_get_max_threads();
+    for (size_t t = 1; t < max; t *= 2) options.threads.push_back(t);
+    options.threads.push_back(max);
+  }
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  try {
+    options = ParseOptions(argc, argv);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr,
+                 "%s\nusage: %s [--output file] [--threads 1,2,4] "
+                 "[--elements n] [--seconds s]\n",
+                 e.what(), argv[0]);
+    return 2;
+  }
+  tutor::Roofline roofline;
+  std::printf("Kernel instruction set: %s\n",
+              tutor::IsaName(tutor::DetectIsa()));
+  for (int level = 1; level <= 3; ++level) {
+    if (CacheBytes(level) != 0) {
+      std::printf("L%d data cache: %s\n", level,
+                  Bytes(CacheBytes(level)).c_str());
+    }
+  }
+  if (options.elements * sizeof(double) < 4 * CacheBytes(3)) {
+    std::printf("Warning: STREAM arrays smaller than 4 times the L3 cache\n");
+  }
+
+  std::printf("\nPeak FMA throughput (GFLOP/s)\n%8s %12s %12s\n", "threads",
+              "total", "per thread");
+  for (size_t threads : options.threads) {
+    MeasurePeak(options, threads, roofline);
+  }
+
+  std::printf("\nSTREAM bandwidth (GB/s), %s per array\n",
+              Bytes(options.elements * sizeof(double)).c_str());
+  std::printf("%-8s %4s %8s %10s %10s %10s %10s\n", "binding", "node",
+              "threads", "copy", "scale", "add", "triad");
+  for (size_t threads : options.threads) {
+    MeasureStream(options, -1, {}, threads, roofline);
+  }
+  auto nodes = NumaNodes();
+  if (nodes.size() > 1) {
+    for (const auto& [node, cpus] : nodes) {
+      for (size_t threads : options.threads) {
+        if (threads > cpus.size()) break;
+        MeasureStream(options, node, cpus, threads, roofline);
+      }
+    }
+  }
+
+  std::printf("\nRead bandwidth by working set (GB/s)\n%8s %12s %-8s %10s\n",
+              "threads", "working set", "level", "read");
+  for (size_t threads : options.threads) {
+    MeasureSweep(options, threads, roofline);
+  }
+
+  std::ofstream file(options.output);
+  file << "# hpc_tutor roofline profile, written by calibration\n"
+       << "# isa " << tutor::IsaName(tutor::DetectIsa()) << "\n";
+  roofline.Write(file);
+  if (!file) {
+    std::fprintf(stderr, "cannot write %s\n", options.output.c_str());
+    return 1;
+  }
+  std::printf("\nWrote %s\n", options.output.c_str());
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/cpu.hpp"
+#include "hpc_tutor/float16.hpp"
+#include "hpc_tutor/gemm_int.hpp"
+#include "hpc_tutor/linalg.hpp"
+#include "test_utils.hpp"
+
+using tutor::Isa;
+
+TEST_CASE("Isa detection", "[cpu]") {
+  Isa isa = tutor::DetectIsa();
+  INFO("isa = " << tutor::IsaName(isa));
+  REQUIRE(tutor::IsaSupported(isa));
+  REQUIRE(tutor::IsaSupported(Isa::kBaseline));
+  // Levels include the previous ones.
+  for (auto level : {Isa::kSse42, Isa::kAvx2, Isa::kAvx512}) {
+    if (tutor::IsaSupported(level)) {
+      REQUIRE(tutor::IsaSupported(static_cast<Isa>(static_cast<int>(level) -
+                                                    1)));
+    }
+  }
+  if (const char* env = std::getenv("HPC_TUTOR_ISA")) {
+    // The override caps the level of every kernel family.
+    for (auto level : {Isa::kBaseline, Isa::kSse42, Isa::kAvx2}) {
+      if (std::string(env) == tutor::IsaName(level)) REQUIRE(isa <= level);
+    }
+    if (isa < Isa::kAvx2) {
+      REQUIRE(tutor::DetectIntGemmIsa() == tutor::IntGemmIsa::kPortable);
+      REQUIRE(tutor::DetectFloat16Isa() == tutor::Float16Isa::kPortable);
+    }
+  } else {
+    for (auto level : {Isa::kSse42, Isa::kAvx2, Isa::kAvx512}) {
+      if (tutor::IsaSupported(level)) REQUIRE(level <= isa);
+    }
+  }
+}
+
+TEST_CASE("Dispatch", "[cpu]") {
+  std::vector<double> v(1000);
+  for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<double>(i);
+  SECTION("Values") {
+    auto sum = tutor::detail::Dispatch([&] {
+      double s = 0;
+      for (double x : v) s += x;
+      return s;
+    });
+    REQUIRE(sum == 999.0 * 1000 / 2);
+  }
+
+  SECTION("Side effects") {
+    tutor::detail::Dispatch([&] {
+      for (double& x : v) x *= 2;
+    });
+    REQUIRE(v[999] == 1998);
+  }
+
+  SECTION("Nested kernels") {
+    auto sum = tutor::detail::Dispatch(
+        [&] { return tutor::Inner(v.data(), v.data(), v.size()); });
+    REQUIRE(sum == 999.0 * 1000 * 1999 / 6);
+  }
+}
+
+TEST_CASE("Dispatched kernels", "[cpu]") {
+  // Small integers are exact: every level gives the same results.
+  constexpr size_t n = 37;
+  auto a = RandomMatrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) a[i][j] = static_cast<int>(a[i][j] * 8);
+  }
+  auto truth = Matrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      for (size_t k = 0; k < n; ++k) truth[i][j] += a[i][k] * a[k][j];
+    }
+  }
+  auto ret = Matrix<double>(n, n);
+  tutor::Gemm(ret.view(), a.view(), a.view());
+  RequireEqual(ret, truth);
+  tutor::Gemm(ret.view(), tutor::Op::kTrans, a.view(), tutor::Op::kTrans,
+              a.view(), 1.0, 0.0);
+  // (a^T a^T)[i][j] is column i of a times row j.
+  std::vector<double> column(n), result(n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t k = 0; k < n; ++k) column[k] = a[k][i];
+    for (size_t j = 0; j < n; ++j) {
+      REQUIRE(ret[i][j] == tutor::Inner(column.data(), a[j], n));
+    }
+  }
+  tutor::MatrixEval(result.data(), a.view(), a[0]);
+  for (size_t i = 0; i < n; ++i) {
+    REQUIRE(result[i] == tutor::Inner(a[i], a[0], n));
+  }
+}
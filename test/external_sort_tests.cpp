@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/external_sort.hpp"
+#include "test_utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+template <typename T>
+void WriteFile(const fs::path& path, const std::vector<T>& v) {
+  tutor::detail::BinaryFile(path.string(), "wb").Write(v.data(), v.size());
+}
+
+template <typename T>
+std::vector<T> ReadFile(const fs::path& path) {
+  std::vector<T> v(fs::file_size(path) / sizeof(T));
+  tutor::detail::BinaryFile(path.string(), "rb").Read(v.data(), v.size());
+  return v;
+}
+
+}  // namespace
+
+TEST_CASE("Loser tree", "[external-sort]") {
+  size_t k = GENERATE(1, 2, 5, 8);
+  std::vector<std::vector<int>> lists(k);
+  std::vector<int> truth;
+  for (size_t i = 0; i < k; ++i) {
+    lists[i] = RandomVector<int>(i * 7, 0, 20);
+    std::sort(lists[i].begin(), lists[i].end());
+    truth.insert(truth.end(), lists[i].begin(), lists[i].end());
+  }
+  std::sort(truth.begin(), truth.end());
+  tutor::detail::LoserTree<int> tree(k);
+  std::vector<size_t> pos(k);
+  for (size_t i = 0; i < k; ++i) {
+    if (!lists[i].empty()) tree.Set(i, lists[i][0]);
+  }
+  tree.Build();
+  std::vector<int> result;
+  while (tree.live()) {
+    size_t w = tree.winner();
+    result.push_back(tree.key(w));
+    if (++pos[w] < lists[w].size()) {
+      tree.Set(w, lists[w][pos[w]]);
+    } else {
+      tree.Close(w);
+    }
+    tree.Replay(w);
+  }
+  REQUIRE(result == truth);
+}
+
+#ifdef __linux__
+TEST_CASE("Failed flushes throw on close", "[external-sort]") {
+  // Small writes stay in the stdio buffer until the file is closed.
+  std::vector<int> v(16);
+  tutor::detail::BinaryFile file("/dev/full", "wb");
+  file.Write(v.data(), v.size());
+  REQUIRE_THROWS_AS(file.Close(), std::runtime_error);
+}
+#endif
+
+TEST_CASE("Run sort", "[external-sort]") {
+  tutor::ThreadPool pool(3, false);
+  size_t n = GENERATE(0, 100, 5000, 100000);
+  auto v = RandomVector<int>(n, 0, 1000);
+  std::vector<int> aux(n);
+  auto truth = v;
+  std::sort(truth.begin(), truth.end());
+  const int* sorted = tutor::detail::SortRun(pool, v.data(), n, aux.data());
+  REQUIRE(std::vector<int>(sorted, sorted + n) == truth);
+}
+
+TEST_CASE("ExternalSort", "[external-sort]") {
+  fs::path dir = fs::temp_directory_path() / "hpc_tutor_external_sort_tests";
+  fs::create_directories(dir);
+  tutor::ExternalSortOptions options;
+  options.tempDir = dir.string();
+  options.ioBlockBytes = 1024;
+  // One run, one merge pass, and several merge passes.
+  size_t n = GENERATE(0, 1000, 40000, 200000);
+  options.memoryBytes = GENERATE(size_t(1) << 16, size_t(1) << 22);
+  auto v = RandomVector<uint64_t>(n, 0, 1000000);
+  WriteFile(dir / "input", v);
+
+  auto stats = tutor::ExternalSort<uint64_t>(
+      (dir / "input").string(), (dir / "output").string(), options);
+  std::sort(v.begin(), v.end());
+  REQUIRE(ReadFile<uint64_t>(dir / "output") == v);
+
+  size_t bytes = n * sizeof(uint64_t);
+  size_t runBytes = options.memoryBytes / 2;
+  REQUIRE(stats.numRuns == (bytes + runBytes - 1) / runBytes);
+  REQUIRE(stats.runs.bytesRead == bytes);
+  REQUIRE(stats.merge.bytesWritten == bytes * stats.mergePasses);
+  REQUIRE(stats.fanIn <= options.memoryBytes / (2 * options.ioBlockBytes));
+  if (stats.numRuns > stats.fanIn) REQUIRE(stats.mergePasses > 1);
+  // Only the input and the output are left.
+  REQUIRE(std::distance(fs::directory_iterator(dir),
+                        fs::directory_iterator()) == 2);
+  fs::remove_all(dir);
+}
@@ -0,0 +1,262 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include "hpc_tutor/float16.hpp"
+#include "hpc_tutor/linalg.hpp"
+#include "test_utils.hpp"
+
+using tutor::BFloat16;
+using tutor::Float16Isa;
+using tutor::Half;
+
+namespace {
+
+std::vector<Float16Isa> SupportedIsas() {
+  std::vector<Float16Isa> isas;
+  for (auto isa : {Float16Isa::kPortable, Float16Isa::kAvx2,
+                   Float16Isa::kAvx512Bf16}) {
+    if (tutor::Float16IsaSupported(isa)) isas.push_back(isa);
+  }
+  return isas;
+}
+
+float FromBits(uint32_t u) {
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+template <typename H>
+std::vector<H> Narrow(const std::vector<float>& v) {
+  std::vector<H> ret(v.size());
+  for (size_t i = 0; i < v.size(); ++i) ret[i] = H(v[i]);
+  return ret;
+}
+
+template <typename H>
+Matrix<H> Narrow(const Matrix<float>& m) {
+  Matrix<H> ret(m.rows(), m.cols());
+  for (size_t i = 0; i < m.rows(); ++i) {
+    for (size_t j = 0; j < m.cols(); ++j) ret[i][j] = H(m[i][j]);
+  }
+  return ret;
+}
+
+/**
+ * Every 16-bit value converts to float and back to itself.
+ */
+template <typename H>
+void CheckRoundTrip() {
+  for (uint32_t bits = 0; bits <= 0xffff; ++bits) {
+    auto h = H::FromBits(static_cast<uint16_t>(bits));
+    float f = h;
+    if (std::isnan(f)) {
+      REQUIRE(std::isnan(static_cast<float>(H(f))));
+    } else if (H(f).bits() != h.bits()) {
+      FAIL("Round trip changes " << bits << " to " << H(f).bits());
+    }
+  }
+}
+
+/**
+ * The SIMD conversions give the bits of the scalar ones.
+ */
+template <typename H>
+void CheckConvert() {
+  constexpr size_t n = 1003;
+  auto patterns = RandomVector<uint32_t>(n, 0, 0xffffffffu);
+  std::vector<float> floats(n);
+  for (size_t i = 0; i < n; ++i) floats[i] = FromBits(patterns[i]);
+  // Values around the ranges of the 16-bit types.
+  auto small = RandomVector<float>(n / 2, -1e-6f, 1e-6f);
+  auto large = RandomVector<float>(n / 2, -70000, 70000);
+  std::copy(small.begin(), small.end(), floats.begin());
+  std::copy(large.begin(), large.end(), floats.begin() + n / 2);
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    std::vector<H> narrow(n);
+    std::vector<float> wide(n);
+    tutor::Convert(narrow.data(), floats.data(), n, isa);
+    tutor::Convert(wide.data(), narrow.data(), n, isa);
+    for (size_t i = 0; i < n; ++i) {
+      INFO("Conversions differ at position " << i << " for " << floats[i]);
+      if (std::isnan(floats[i])) {
+        REQUIRE(std::isnan(wide[i]));
+      } else {
+        REQUIRE(narrow[i].bits() == H(floats[i]).bits());
+        float truth = narrow[i];
+        REQUIRE(std::memcmp(&wide[i], &truth, sizeof(float)) == 0);
+      }
+    }
+  }
+}
+
+template <typename H>
+void CheckInner(size_t n) {
+  auto lhs = Narrow<H>(RandomVector<float>(n, -1, 1));
+  auto rhs = Narrow<H>(RandomVector<float>(n, -1, 1));
+  double truth = 0, scale = 1e-30;
+  for (size_t i = 0; i < n; ++i) {
+    truth += static_cast<double>(lhs[i]) * static_cast<double>(rhs[i]);
+    scale += std::abs(static_cast<double>(lhs[i]) * rhs[i]);
+  }
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    float result = tutor::Inner(lhs.data(), rhs.data(), n, isa);
+    REQUIRE_THAT(result, WithinAbs(truth, 1e-5 * scale));
+  }
+}
+
+template <typename H>
+void CheckMatrixEval(size_t n, size_t m) {
+  auto a = Narrow<H>(RandomMatrix<float>(n, m, -1, 1));
+  auto v = RandomVector<float>(m, -1, 1);
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    std::vector<float> result(n);
+    tutor::MatrixEval(result.data(), a.view(), v.data(), isa);
+    for (size_t i = 0; i < n; ++i) {
+      double truth = 0, scale = 1e-30;
+      for (size_t j = 0; j < m; ++j) {
+        truth += static_cast<double>(a[i][j]) * v[j];
+        scale += std::abs(static_cast<double>(a[i][j]) * v[j]);
+      }
+      INFO("Results differ at position " << i);
+      REQUIRE_THAT(result[i], WithinAbs(truth, 1e-5 * scale));
+    }
+  }
+}
+
+template <typename H>
+void CheckGemm(size_t n, size_t l, size_t m) {
+  auto lhs = Narrow<H>(RandomMatrix<float>(n, l, -1, 1));
+  auto rhs = Narrow<H>(RandomMatrix<float>(l, m, -1, 1));
+  auto init = RandomMatrix<float>(n, m, -1, 1);
+  auto [nbs, mbs, lbs] = GENERATE(std::tuple<size_t, size_t, size_t>{1, 1, 1},
+                                  std::tuple<size_t, size_t, size_t>{4, 16, 8},
+                                  std::tuple<size_t, size_t, size_t>{
+                                      64, 256, 128});
+  INFO("block sizes = " << nbs << ", " << mbs << ", " << lbs);
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    auto result = init;
+    tutor::Gemm_b(result.view(), lhs.view(), rhs.view(), nbs, mbs, lbs, isa);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < m; ++j) {
+        double truth = init[i][j];
+        for (size_t k = 0; k < l; ++k) {
+          truth += static_cast<double>(lhs[i][k]) * rhs[k][j];
+        }
+        INFO("Results differ at position " << i << ", " << j);
+        REQUIRE_THAT(result[i][j], WithinAbs(truth, 1e-5 * (l + 1)));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Float16 round trip", "[float16]") {
+  CheckRoundTrip<BFloat16>();
+  CheckRoundTrip<Half>();
+}
+
+TEST_CASE("Float16 rounding", "[float16]") {
+  SECTION("BFloat16") {
+    REQUIRE(BFloat16(1.0f).bits() == 0x3f80);
+    REQUIRE(BFloat16(-2.0f).bits() == 0xc000);
+    // Ties go to even mantissas.
+    REQUIRE(BFloat16(1.0f + 0x1p-8f).bits() == 0x3f80);
+    REQUIRE(BFloat16(1.0f + 0x3p-8f).bits() == 0x3f82);
+    REQUIRE(BFloat16(1.0f + 0x1p-8f + 0x1p-20f).bits() == 0x3f81);
+    REQUIRE(BFloat16(std::numeric_limits<float>::max()).bits() == 0x7f80);
+    REQUIRE(BFloat16(std::numeric_limits<float>::infinity()).bits() ==
+            0x7f80);
+    REQUIRE(std::isnan(static_cast<float>(
+        BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+    // A NaN whose payload is in the low bits must not become infinity.
+    REQUIRE(std::isnan(static_cast<float>(BFloat16(FromBits(0x7f800001)))));
+  }
+
+  SECTION("Half") {
+    REQUIRE(Half(1.0f).bits() == 0x3c00);
+    REQUIRE(Half(-2.0f).bits() == 0xc000);
+    REQUIRE(Half(65504.0f).bits() == 0x7bff);
+    REQUIRE(Half(65519.0f).bits() == 0x7bff);
+    REQUIRE(Half(65520.0f).bits() == 0x7c00);
+    REQUIRE(Half(1e10f).bits() == 0x7c00);
+    REQUIRE(Half(-1e10f).bits() == 0xfc00);
+    REQUIRE(std::isnan(static_cast<float>(
+        Half(std::numeric_limits<float>::quiet_NaN()))));
+    // Subnormals are multiples of 2^-24.
+    REQUIRE(Half(0x1p-24f).bits() == 0x0001);
+    REQUIRE(Half(0x1p-25f).bits() == 0x0000);
+    REQUIRE(Half(0x3p-26f).bits() == 0x0001);
+    REQUIRE(Half(0x3p-25f).bits() == 0x0002);
+    REQUIRE(Half(0x1p-14f).bits() == 0x0400);
+    REQUIRE(Half(0x3ffp-24f).bits() == 0x03ff);
+    REQUIRE(static_cast<float>(Half::FromBits(0x0001)) == 0x1p-24f);
+    REQUIRE(static_cast<float>(Half::FromBits(0x8000)) == 0.0f);
+    REQUIRE(std::signbit(static_cast<float>(Half::FromBits(0x8000))));
+  }
+}
+
+TEST_CASE("Float16 Convert", "[float16]") {
+  CheckConvert<BFloat16>();
+  CheckConvert<Half>();
+}
+
+TEST_CASE("Float16 Inner", "[float16]") {
+  size_t n = GENERATE(0, 1, 7, 100, 1000, 4099);
+  INFO("n = " << n);
+  CheckInner<BFloat16>(n);
+  CheckInner<Half>(n);
+  // The generic Inner is still selected for other types.
+  // Float sums of n terms are off by up to about n * eps relative,
+  // so compare with a sum accumulated in double.
+  auto v = RandomVector<float>(n);
+  double truth = 0;
+  for (float x : v) truth += double(x) * x;
+  double eps = std::numeric_limits<float>::epsilon();
+  REQUIRE_THAT(tutor::Inner(v.data(), v.data(), n), WithinRel(truth, n * eps));
+}
+
+TEST_CASE("Float16 MatrixEval", "[float16]") {
+  auto [n, m] = GENERATE(std::tuple<size_t, size_t>{1, 1},
+                         std::tuple<size_t, size_t>{5, 7},
+                         std::tuple<size_t, size_t>{37, 1000});
+  INFO("sizes = " << n << ", " << m);
+  CheckMatrixEval<BFloat16>(n, m);
+  CheckMatrixEval<Half>(n, m);
+}
+
+TEST_CASE("Float16 Gemm_b", "[float16]") {
+  auto [n, l, m] = GENERATE(std::tuple<size_t, size_t, size_t>{1, 1, 1},
+                            std::tuple<size_t, size_t, size_t>{5, 7, 3},
+                            std::tuple<size_t, size_t, size_t>{70, 301, 65});
+  INFO("sizes = " << n << ", " << l << ", " << m);
+  CheckGemm<BFloat16>(n, l, m);
+  CheckGemm<Half>(n, l, m);
+}
+
+TEST_CASE("Float16 Matrix", "[float16]") {
+  auto eye = Matrix<Half>::eye(3);
+  REQUIRE(eye[1][1] == 1.0f);
+  REQUIRE(eye[0][1] == 0.0f);
+  Matrix<BFloat16> m(2, 2, BFloat16(0.5f));
+  auto copy = m;
+  copy[0][0] = BFloat16(copy[0][0] * 3);
+  REQUIRE(copy[0][0] == 1.5f);
+  REQUIRE(m[0][0] == 0.5f);
+  std::ostringstream os;
+  os << copy[0][0];
+  REQUIRE(os.str() == "1.5");
+}
@@ -0,0 +1,105 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "hpc_tutor/gemm_int.hpp"
+#include "hpc_tutor/linalg.hpp"
+#include "test_utils.hpp"
+
+namespace {
+
+template <typename T>
+Matrix<int32_t> Widen(const Matrix<T>& m) {
+  Matrix<int32_t> ret(m.rows(), m.cols());
+  for (size_t i = 0; i < m.rows(); ++i) {
+    for (size_t j = 0; j < m.cols(); ++j) ret[i][j] = m[i][j];
+  }
+  return ret;
+}
+
+std::vector<tutor::IntGemmIsa> SupportedIsas() {
+  std::vector<tutor::IntGemmIsa> isas;
+  for (auto isa : {tutor::IntGemmIsa::kPortable, tutor::IntGemmIsa::kAvx2,
+                   tutor::IntGemmIsa::kAvx512Vnni}) {
+    if (tutor::IntGemmIsaSupported(isa)) isas.push_back(isa);
+  }
+  return isas;
+}
+
+/**
+ * Checks the integer Gemm against the generic one on int32 copies.
+ */
+template <typename A, typename B>
+void CheckGemm(size_t n, size_t l, size_t m) {
+  auto lhs = RandomMatrix<A>(n, l, std::numeric_limits<A>::min(),
+                             std::numeric_limits<A>::max());
+  auto rhs = RandomMatrix<B>(l, m, std::numeric_limits<B>::min(),
+                             std::numeric_limits<B>::max());
+  auto init = RandomMatrix<int32_t>(n, m, -1000, 1000);
+  auto truth = init;
+  tutor::Gemm(truth.view(), Widen(lhs).view(), Widen(rhs).view());
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    auto result = init;
+    tutor::Gemm(result.view(), lhs.view(), rhs.view(), isa);
+    RequireEqual(result, truth);
+    result = init;
+    tutor::Gemm_t(result.view(), lhs.view(),
+                  tutor::PackedIntRhs<A, B>(rhs.view(), isa));
+    RequireEqual(result, truth);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Integer Gemm", "[gemm-int]") {
+  auto [n, l, m] = GENERATE(std::tuple<size_t, size_t, size_t>{1, 1, 1},
+                            std::tuple<size_t, size_t, size_t>{5, 7, 3},
+                            std::tuple<size_t, size_t, size_t>{13, 37, 29},
+                            std::tuple<size_t, size_t, size_t>{70, 301, 65});
+  INFO("sizes = " << n << ", " << l << ", " << m);
+  CheckGemm<uint8_t, int8_t>(n, l, m);
+  CheckGemm<int8_t, int8_t>(n, l, m);
+  CheckGemm<uint8_t, uint8_t>(n, l, m);
+  CheckGemm<int8_t, uint8_t>(n, l, m);
+  CheckGemm<int16_t, int16_t>(n, l, m);
+  CheckGemm<int16_t, int8_t>(n, l, m);
+  CheckGemm<uint8_t, int16_t>(n, l, m);
+}
+
+TEST_CASE("Integer Gemm extremes", "[gemm-int]") {
+  // 255 * -128 pairs overflow the 16-bit sums of vpmaddubsw.
+  constexpr size_t n = 6, l = 64, m = 40;
+  Matrix<uint8_t> lhs(n, l, 255);
+  Matrix<int8_t> rhs(l, m, -128);
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    Matrix<int32_t> result(n, m);
+    tutor::Gemm(result.view(), lhs.view(), rhs.view(), isa);
+    RequireEqual(result, Matrix<int32_t>(n, m, 255 * -128 * int32_t(l)));
+  }
+  // Sums wrap modulo 2^32 on every path.
+  Matrix<int16_t> a(2, 4, -32768), b(4, 3, -32768);
+  for (auto isa : SupportedIsas()) {
+    INFO("isa = " << static_cast<int>(isa));
+    Matrix<int32_t> result(2, 3);
+    tutor::Gemm(result.view(), a.view(), b.view(), isa);
+    RequireEqual(result, Matrix<int32_t>(2, 3, 0));
+  }
+}
+
+TEST_CASE("Integer Gemm ISA detection", "[gemm-int]") {
+  REQUIRE(tutor::IntGemmIsaSupported(tutor::IntGemmIsa::kPortable));
+  REQUIRE(tutor::IntGemmIsaSupported(tutor::DetectIntGemmIsa()));
+  auto rhs = Matrix<int8_t>(3, 3);
+  for (auto isa : {tutor::IntGemmIsa::kAvx2, tutor::IntGemmIsa::kAvx512Vnni}) {
+    if (!tutor::IntGemmIsaSupported(isa)) {
+      REQUIRE_THROWS_AS((tutor::PackedIntRhs<int8_t, int8_t>(rhs.view(), isa)),
+                        std::invalid_argument);
+    }
+  }
+}
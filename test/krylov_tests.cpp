@@ -0,0 +1,151 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <vector>
+
+#include "hpc_tutor/krylov.hpp"
+#include "hpc_tutor/linalg.hpp"
+#include "test_utils.hpp"
+
+namespace {
+
+/**
+ * Returns ||b - Ax|| / ||b||.
+ */
+double RelativeResidual(const Matrix<double>& a, const std::vector<double>& x,
+                        const std::vector<double>& b) {
+  double rr = 0, bb = 0;
+  for (size_t i = 0; i < a.rows(); ++i) {
+    double ri = b[i];
+    for (size_t j = 0; j < a.cols(); ++j) ri -= a[i][j] * x[j];
+    rr += ri * ri;
+    bb += b[i] * b[i];
+  }
+  return std::sqrt(rr / bb);
+}
+
+/**
+ * Matrix-free SPD operator: the stencil (-1, 4, -1).
+ */
+void Stencil(double* y, const double* x, size_t n) {
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < n; ++i) {
+    y[i] = 4 * x[i] - (i > 0 ? x[i - 1] : 0) - (i + 1 < n ? x[i + 1] : 0);
+  }
+}
+
+void CheckStats(const tutor::KrylovStats& stats) {
+  REQUIRE(stats.residualHistory.size() == stats.iterations + 1);
+  REQUIRE(stats.iterationSeconds.size() == stats.iterations);
+  REQUIRE(stats.seconds >= 0);
+}
+
+}  // namespace
+
+TEST_CASE("Cg_t", "[krylov]") {
+  constexpr size_t n = 300;
+  bool pipelined = GENERATE(false, true);
+  INFO("pipelined = " << pipelined);
+  auto a = RandomSpdMatrix<double>(n);
+  auto b = RandomVector<double>(n, -1, 1);
+  std::vector<double> x(n);
+  tutor::KrylovOptions options;
+  options.tolerance = 1e-10;
+  options.pipelined = pipelined;
+  auto stats = tutor::Cg_t(a.view(), x.data(), b.data(), options);
+  CheckStats(stats);
+  REQUIRE(stats.converged);
+  REQUIRE(stats.residual() <= 1e-10);
+  REQUIRE(RelativeResidual(a, x, b) <= 1e-8);
+}
+
+TEST_CASE("Cg_t matrix-free", "[krylov]") {
+  constexpr size_t n = 100000;
+  bool pipelined = GENERATE(false, true);
+  INFO("pipelined = " << pipelined);
+  auto truth = RandomVector<double>(n, -1, 1);
+  std::vector<double> b(n), x(n);
+  Stencil(b.data(), truth.data(), n);
+  tutor::KrylovOptions options;
+  options.tolerance = 1e-12;
+  options.pipelined = pipelined;
+  auto op = [](double* y, const double* v) { Stencil(y, v, n); };
+  auto stats = tutor::Cg_t(op, n, x.data(), b.data(), options);
+  CheckStats(stats);
+  REQUIRE(stats.converged);
+  // The condition number is below 3: few iterations are needed.
+  REQUIRE(stats.iterations < 40);
+  for (size_t i = 0; i < n; ++i) {
+    INFO("Solutions differ at position " << i);
+    REQUIRE_THAT(x[i], WithinAbs(truth[i], 1e-9));
+  }
+}
+
+TEST_CASE("Gmres_t", "[krylov]") {
+  constexpr size_t n = 200;
+  size_t restart = GENERATE(5, 30, 200);
+  INFO("restart = " << restart);
+  // Nonsymmetric and diagonally dominant.
+  auto a = RandomMatrix<double>(n, n, -1, 1);
+  for (size_t i = 0; i < n; ++i) a[i][i] += n;
+  auto b = RandomVector<double>(n, -1, 1);
+  std::vector<double> x(n);
+  tutor::KrylovOptions options;
+  options.tolerance = 1e-10;
+  options.restart = restart;
+  auto stats = tutor::Gmres_t(a.view(), x.data(), b.data(), options);
+  CheckStats(stats);
+  REQUIRE(stats.converged);
+  REQUIRE(RelativeResidual(a, x, b) <= 1e-8);
+  // GMRES minimizes the residual: it never grows.
+  for (size_t i = 1; i < stats.residualHistory.size(); ++i) {
+    REQUIRE(stats.residualHistory[i] <= stats.residualHistory[i - 1] * 1.0001);
+  }
+}
+
+TEST_CASE("Gmres_t matrix-free", "[krylov]") {
+  constexpr size_t n = 50000;
+  auto truth = RandomVector<double>(n, -1, 1);
+  std::vector<double> b(n), x(n);
+  Stencil(b.data(), truth.data(), n);
+  tutor::KrylovOptions options;
+  options.tolerance = 1e-12;
+  options.restart = 8;
+  auto op = [](double* y, const double* v) { Stencil(y, v, n); };
+  auto stats = tutor::Gmres_t(op, n, x.data(), b.data(), options);
+  CheckStats(stats);
+  REQUIRE(stats.converged);
+  for (size_t i = 0; i < n; ++i) {
+    INFO("Solutions differ at position " << i);
+    REQUIRE_THAT(x[i], WithinAbs(truth[i], 1e-9));
+  }
+}
+
+TEST_CASE("Krylov limits", "[krylov]") {
+  constexpr size_t n = 50;
+  auto a = RandomSpdMatrix<double>(n);
+  std::vector<double> x(n, 1.0), zero(n);
+  tutor::KrylovOptions options;
+
+  SECTION("Zero right-hand side") {
+    auto cg = tutor::Cg_t(a.view(), x.data(), zero.data(), options);
+    // The residual is absolute for a zero b.
+    REQUIRE(cg.converged);
+    for (double xi : x) REQUIRE_THAT(xi, WithinAbs(0, 1e-8));
+  }
+
+  SECTION("Iteration cap") {
+    auto b = RandomVector<double>(n, -1, 1);
+    options.maxIterations = 2;
+    options.tolerance = 0;
+    auto cg = tutor::Cg_t(a.view(), x.data(), b.data(), options);
+    REQUIRE(cg.iterations == 2);
+    REQUIRE_FALSE(cg.converged);
+    options.restart = 3;
+    options.maxIterations = 7;
+    auto gmres = tutor::Gmres_t(a.view(), x.data(), b.data(), options);
+    REQUIRE(gmres.iterations == 7);
+    REQUIRE_FALSE(gmres.converged);
+  }
+}
@@ -0,0 +1,70 @@
+#include <mpi.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstdio>
+#include <string>
+
+#include "hpc_tutor/linalg_m.hpp"
+#include "hpc_tutor/matrix.hpp"
+#include "test_utils.hpp"
+
+namespace {
+
+constexpr int kIterations = 5;
+
+/**
+ * Returns the mean seconds of `f` over `kIterations` runs,
+ * after a warm-up run, on the slowest process.
+ *
+ * Catch2 benchmarks pick their iteration counts from the clock
+ * of each process, so processes could call collectives a different
+ * number of times: all processes run the same count here instead.
+ */
+template <typename F>
+double MeanSeconds(const F& f) {
+  f();
+  MPI_Barrier(MPI_COMM_WORLD);
+  double start = MPI_Wtime();
+  for (int i = 0; i < kIterations; ++i) f();
+  double seconds = (MPI_Wtime() - start) / kIterations;
+  MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+                MPI_COMM_WORLD);
+  return seconds;
+}
+
+}  // namespace
+
+TEST_CASE("Cannon Gemm Benchmark", "[gemm-m]") {
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  // Size of the local blocks.
+  size_t n = GENERATE(250, 500, 1000);
+  auto lhs = RandomMatrix<double>(n, n);
+  auto rhs = RandomMatrix<double>(n, n);
+  auto ret = Matrix<double>(n, n);
+  std::string suffix = std::to_string(n) + "x" + std::to_string(size);
+  double sm = MeanSeconds(
+      [&] { tutor::Gemm_sm(ret.view(), lhs.view(), rhs.view()); });
+  double am = MeanSeconds(
+      [&] { tutor::Gemm_am(ret.view(), lhs.view(), rhs.view()); });
+  if (rank == 0) {
+    std::printf("Gemm_sm-%s: %.3f ms\nGemm_am-%s: %.3f ms\n",
+                suffix.c_str(), 1e3 * sm, suffix.c_str(), 1e3 * am);
+  }
+
+  // Communication exposed by each version, slowest process.
+  tutor::GemmStats sync, async;
+  tutor::Gemm_sm(ret.view(), lhs.view(), rhs.view(), MPI_COMM_WORLD, 64,
+                 &sync);
+  tutor::Gemm_am(ret.view(), lhs.view(), rhs.view(), MPI_COMM_WORLD, 64,
+                 &async);
+  double comm[2] = {sync.commSeconds, async.commSeconds};
+  MPI_Allreduce(MPI_IN_PLACE, comm, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  if (rank == 0 && comm[0] > 0) {
+    std::printf("Gemm_am-%s hides %.1f%% of the communication (%g of %g s)\n",
+                suffix.c_str(), 100 * (1 - comm[1] / comm[0]),
+                comm[0] - comm[1], comm[0]);
+  }
+}
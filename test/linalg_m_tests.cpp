@@ -0,0 +1,184 @@
+#include <mpi.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vector>
+
+#include "hpc_tutor/linalg.hpp"
+#include "hpc_tutor/linalg_m.hpp"
+#include "test_utils.hpp"
+
+namespace {
+
+/**
+ * Returns the uneven part [first, last) of n elements of this process:
+ * process r gets a share proportional to r + 1.
+ */
+std::pair<size_t, size_t> Part(size_t n) {
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  size_t weights = static_cast<size_t>(size) * (size + 1) / 2;
+  size_t before = static_cast<size_t>(rank) * (rank + 1) / 2;
+  return {n * before / weights, n * (before + rank + 1) / weights};
+}
+
+}  // namespace
+
+// Every process generates the same full vectors and reduces its part.
+// CHECK keeps the processes in step when an assertion fails.
+
+TEST_CASE("Accumulate_cm and Inner_cm", "[linalg-m]") {
+  size_t n = GENERATE(0, 5, 10000);
+  auto [first, last] = Part(n);
+  auto u = RandomVector<int>(n, -100, 100);
+  auto v = RandomVector<int>(n, -100, 100);
+  CHECK(tutor::Accumulate_cm(u.data() + first, last - first) ==
+        tutor::Accumulate(u.data(), n));
+  CHECK(tutor::Inner_cm(u.data() + first, v.data() + first, last - first) ==
+        tutor::Inner(u.data(), v.data(), n));
+}
+
+TEST_CASE("Reproducible reductions _rcm", "[linalg-m]") {
+  size_t n = GENERATE(0, 5, 100003);
+  auto [first, last] = Part(n);
+  auto u = RandomVector<double>(n, -1, 1);
+  auto v = RandomVector<double>(n, -1e6, 1e6);
+  CHECK(tutor::Accumulate_rcm(u.data() + first, last - first) ==
+        tutor::Accumulate_r(u.data(), n));
+  CHECK(tutor::Inner_rcm(u.data() + first, v.data() + first, last - first) ==
+        tutor::Inner_r(u.data(), v.data(), n));
+  CHECK_THAT(tutor::Accumulate_cm(u.data() + first, last - first),
+             WithinAbs(tutor::Accumulate_r(u.data(), n), 1e-9));
+}
+
+TEST_CASE("MergeSort_cm", "[linalg-m]") {
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  size_t n = GENERATE(0, 3, 1000, 50000);
+  // Uniform, duplicate-heavy and constant keys.
+  int high = GENERATE(1000000, 3, 0);
+  auto v = RandomVector<int>(n, 0, high);
+  auto [first, last] = Part(n);
+  tutor::SortBalance balance;
+  auto mine = tutor::MergeSort_cm(v.data() + first, last - first,
+                                  MPI_COMM_WORLD, &balance);
+  CHECK(std::is_sorted(mine.begin(), mine.end()));
+
+  // Gather the pieces in rank order and compare with a serial sort.
+  int count = static_cast<int>(mine.size());
+  std::vector<int> counts(size), displs(size);
+  MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT,
+                MPI_COMM_WORLD);
+  for (int r = 1; r < size; ++r) displs[r] = displs[r - 1] + counts[r - 1];
+  std::vector<int> result(n);
+  MPI_Allgatherv(mine.data(), count, MPI_INT, result.data(), counts.data(),
+                 displs.data(), MPI_INT, MPI_COMM_WORLD);
+  std::sort(v.begin(), v.end());
+  CHECK(result == v);
+
+  CHECK(balance.totalKeys == n);
+  CHECK(balance.minKeys <= balance.maxKeys);
+  // Regular sampling bounds the largest piece by about twice the average.
+  CHECK(balance.maxKeys <= 2 * n / size + size);
+}
+
+TEST_CASE("MatrixEval_cm and MatrixEval_am", "[linalg-m]") {
+  size_t n = GENERATE(1, 10, 301);
+  auto a = RandomMatrix<double>(n, n, -1, 1);
+  auto x = RandomVector<double>(n, -1, 1);
+  auto blocks = tutor::RowBlocks::Even(n);
+  auto mine = a.view(blocks.offset(), 0, blocks.localRows(), n);
+
+  // A few steps of the power iteration.
+  std::vector<double> truth = x, tmp(n);
+  for (int k = 0; k < 3; ++k) {
+    tutor::MatrixEval(tmp.data(), a.view(), truth.data());
+    truth.swap(tmp);
+  }
+
+  SECTION("MatrixEval_cm") {
+    std::vector<double> y = x;
+    for (int k = 0; k < 3; ++k) {
+      tutor::MatrixEval_cm(tmp.data(), mine, y.data(), blocks);
+      y.swap(tmp);
+    }
+    RequireEqual(y, truth);
+  }
+  SECTION("MatrixEval_am, two interleaved sequences") {
+    std::vector<double> y = x, z = x, ty(n), tz(n);
+    for (int k = 0; k < 3; ++k) {
+      auto ry = tutor::MatrixEval_am(ty.data(), mine, y.data(), blocks);
+      auto rz = tutor::MatrixEval_am(tz.data(), mine, z.data(), blocks);
+      ry.wait();
+      rz.wait();
+      y.swap(ty);
+      z.swap(tz);
+    }
+    RequireEqual(y, truth);
+    CHECK(y == z);
+  }
+  SECTION("MatrixEval_am, dependent iterations") {
+    std::vector<double> y = x, ty(n);
+    tutor::MpiRequest r;
+    for (int k = 0; k < 3; ++k) {
+      r = tutor::MatrixEval_am(ty.data(), mine, y.data(), r, blocks);
+      y.swap(ty);
+    }
+    r.wait();
+    RequireEqual(y, truth);
+  }
+}
+
+TEST_CASE("Gemm_sm and Gemm_am", "[linalg-m]") {
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  int q = 1;
+  while ((q + 1) * (q + 1) <= size) ++q;
+  // Cannon runs on the largest square subset of the processes.
+  MPI_Comm grid;
+  MPI_Comm_split(MPI_COMM_WORLD, rank < q * q ? 0 : MPI_UNDEFINED, rank,
+                 &grid);
+  size_t mb = GENERATE(1, 7), nb = GENERATE(1, 5), lb = GENERATE(1, 6);
+  auto lhs = RandomMatrix<double>(q * mb, q * lb, -1, 1);
+  auto rhs = RandomMatrix<double>(q * lb, q * nb, -1, 1);
+  auto truth = RandomMatrix<double>(q * mb, q * nb, -1, 1);
+  auto sync = truth;
+  auto async = truth;
+  tutor::Gemm(truth.view(), lhs.view(), rhs.view());
+  if (grid == MPI_COMM_NULL) return;
+
+  size_t i = rank / q, j = rank % q;
+  auto block = [&](Matrix<double>& m, size_t r, size_t c) {
+    return m.view(i * r, j * c, r, c);
+  };
+  tutor::GemmStats stats;
+  tutor::Gemm_sm(block(sync, mb, nb), block(lhs, mb, lb), block(rhs, lb, nb),
+                 grid, 4, &stats);
+  CHECK(stats.totalSeconds >= stats.computeSeconds + stats.commSeconds);
+  tutor::Gemm_am(block(async, mb, nb), block(lhs, mb, lb),
+                 block(rhs, lb, nb), grid, 4, &stats);
+  CHECK(stats.totalSeconds >= stats.computeSeconds + stats.commSeconds);
+  MPI_Comm_free(&grid);
+
+  auto expected = block(truth, mb, nb);
+  for (size_t r = 0; r < mb; ++r) {
+    for (size_t c = 0; c < nb; ++c) {
+      CHECK_THAT(block(sync, mb, nb)[r][c], WithinAbs(expected[r][c], 1e-12));
+      CHECK_THAT(block(async, mb, nb)[r][c], WithinAbs(expected[r][c], 1e-12));
+    }
+  }
+}
+
+TEST_CASE("RowBlocks", "[linalg-m]") {
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  tutor::RowBlocks blocks(rank + 1);
+  CHECK(blocks.rows() == static_cast<size_t>(size * (size + 1) / 2));
+  CHECK(blocks.offset() == static_cast<size_t>(rank * (rank + 1) / 2));
+  CHECK(blocks.localRows() == static_cast<size_t>(rank + 1));
+}
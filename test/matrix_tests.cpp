@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <catch2/catch_test_macros.hpp>
+#include <cstdint>
 #include <numeric>
 
 #include "hpc_tutor/matrix.hpp"
@@ -85,3 +86,54 @@ TEST_CASE("Initializer List Constructor", "[constructors]") {
     }
   }
 }
+
+TEST_CASE("Uninitialized Constructor", "[constructors]") {
+  size_t n = 7, m = 9;
+  Matrix<double> a(n, m, tutor::uninitialized);
+  CHECK(a.rows() == n);
+  CHECK(a.cols() == m);
+  std::iota(a.data(), a.data() + a.size(), 0.0);
+  REQUIRE(a[n - 1][m - 1] == static_cast<double>(n * m - 1));
+}
+
+TEST_CASE("Pool allocated Matrix", "[memory]") {
+  using PoolMatrix = tutor::Matrix<double, tutor::PoolAllocator<double>>;
+  const double* first;
+  {
+    PoolMatrix a(30, 40, 1.0);
+    first = a.data();
+    REQUIRE(reinterpret_cast<uintptr_t>(first) %
+                tutor::MemoryPool::kAlignment ==
+            0);
+  }
+  // A block freed by this thread is reused by the next request of its class.
+  PoolMatrix b(40, 30, tutor::uninitialized);
+  REQUIRE(b.data() == first);
+  PoolMatrix c(40, 30);
+  for (size_t i = 0; i < c.rows(); ++i) {
+    for (size_t j = 0; j < c.cols(); ++j) {
+      REQUIRE(c[i][j] == 0);
+    }
+  }
+}
+
+TEST_CASE("Memory pool size classes", "[memory]") {
+  using tutor::MemoryPool;
+  for (size_t bytes : {1, 64, 65, 100, 128, 129, 1000, 4096, 1 << 20,
+                       (1 << 20) + 1, 72000000}) {
+    size_t block = MemoryPool::BlockSize(bytes);
+    INFO("bytes = " << bytes << ", block = " << block);
+    REQUIRE(block >= bytes);
+    REQUIRE(block <= std::max<size_t>(64, bytes + bytes / 4));
+  }
+  auto& pool = MemoryPool::Global();
+  size_t big = size_t(1) << 22;
+  void* p = pool.Allocate(big);
+  size_t before = pool.cachedBytes();
+  pool.Deallocate(p, big);
+  REQUIRE(pool.cachedBytes() == before + MemoryPool::BlockSize(big));
+  REQUIRE(pool.Allocate(big) == p);
+  pool.Deallocate(p, big);
+  pool.Trim();
+  REQUIRE(pool.cachedBytes() == 0);
+}
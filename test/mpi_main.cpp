@@ -0,0 +1,28 @@
+#include <mpi.h>
+
+#include <catch2/catch_session.hpp>
+#include <cstdio>
+
+/**
+ * Catch2 entry point of the programs that run on several processes.
+ */
+int main(int argc, char* argv[]) {
+  // Only the main thread calls MPI; OpenMP threads compute.
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  if (provided < MPI_THREAD_FUNNELED) {
+    std::fprintf(stderr, "MPI does not support MPI_THREAD_FUNNELED\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  Catch::Session session;
+  int result = session.applyCommandLine(argc, argv);
+  if (result == 0) {
+    // All processes must draw the same random inputs.
+    auto seed = session.configData().rngSeed;
+    MPI_Bcast(&seed, sizeof(seed), MPI_BYTE, 0, MPI_COMM_WORLD);
+    session.configData().rngSeed = seed;
+    result = session.run();
+  }
+  MPI_Finalize();
+  return result;
+}
@@ -0,0 +1,91 @@
+#include <omp.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "hpc_tutor/matrix.hpp"
+#include "hpc_tutor/random.hpp"
+#include "test_utils.hpp"
+
+TEST_CASE("Philox known answers", "[random]") {
+  // Reference values of Philox4x32-10 from the Random123 distribution.
+  REQUIRE(tutor::detail::Philox4x32(0, 0, 0) == 0xe169c58d6627e8d5ull);
+  REQUIRE(tutor::detail::Philox4x32(~0ull, ~0ull, ~0ull) ==
+          0x41c83b0e408f276dull);
+}
+
+TEST_CASE("Uniform ranges", "[random]") {
+  std::vector<double> d(10000);
+  tutor::FillUniform(d.data(), d.size(), -2.0, 3.0, 7);
+  double sum = 0;
+  for (double x : d) {
+    REQUIRE(x >= -2.0);
+    REQUIRE(x < 3.0);
+    sum += x;
+  }
+  REQUIRE(sum / d.size() > 0.4);
+  REQUIRE(sum / d.size() < 0.6);
+
+  std::vector<int> v(10000);
+  tutor::FillUniform(v.data(), v.size(), -3, 3, 7);
+  std::vector<size_t> hist(7);
+  for (int x : v) {
+    REQUIRE(x >= -3);
+    REQUIRE(x <= 3);
+    ++hist[x + 3];
+  }
+  for (size_t h : hist) REQUIRE(h > 1000);
+}
+
+TEST_CASE("Uniform range limits", "[random]") {
+  using tutor::detail::UniformFromBits;
+  REQUIRE(UniformFromBits<float>(~0ull, 0, 1) < 1.0f);
+  REQUIRE(UniformFromBits<float>(0, 0, 1) == 0.0f);
+  REQUIRE(UniformFromBits<double>(~0ull, 1, 2) < 2.0);
+  REQUIRE(UniformFromBits<float>(~0ull, -1e30f, 1e30f) < 1e30f);
+
+  constexpr int32_t kMin = std::numeric_limits<int32_t>::min();
+  constexpr int32_t kMax = std::numeric_limits<int32_t>::max();
+  REQUIRE(UniformFromBits<int32_t>(0, kMin, kMax) == kMin);
+  REQUIRE(UniformFromBits<int32_t>(~0ull, kMin, kMax) == kMax);
+  REQUIRE(UniformFromBits<int64_t>(~0ull, std::numeric_limits<int64_t>::min(),
+                                   std::numeric_limits<int64_t>::max()) ==
+          std::numeric_limits<int64_t>::max());
+}
+
+TEST_CASE("Reproducible fills", "[random]") {
+  size_t rows = GENERATE(1, 37, 300);
+  size_t cols = GENERATE(1, 5, 257);
+  Matrix<float> serial(rows, cols), parallel(rows, cols);
+  tutor::FillUniform(serial.view(), 0.0f, 1.0f, 42, 3);
+  for (int threads : {1, 2, 5}) {
+    omp_set_num_threads(threads);
+    tutor::FillUniform_t(parallel.view(), 0.0f, 1.0f, 42, 3);
+    REQUIRE(parallel == serial);
+  }
+
+  SECTION("Views take the values of their logical position") {
+    Matrix<float> big(rows, cols + 3);
+    tutor::FillUniform_t(big.view(0, 1, rows, cols), 0.0f, 1.0f, 42, 3);
+    for (size_t i = 0; i < rows; ++i) {
+      for (size_t j = 0; j < cols; ++j) REQUIRE(big[i][j + 1] == serial[i][j]);
+    }
+  }
+
+  SECTION("Vectors match the rows of a matrix") {
+    std::vector<float> v(rows * cols);
+    tutor::FillUniform_t(v.data(), v.size(), 0.0f, 1.0f, 42, 3);
+    REQUIRE(std::equal(v.begin(), v.end(), serial.data()));
+  }
+
+  SECTION("Streams and seeds are independent") {
+    tutor::FillUniform(parallel.view(), 0.0f, 1.0f, 42, 4);
+    if (rows * cols > 1) REQUIRE_FALSE(parallel == serial);
+    tutor::FillUniform(parallel.view(), 0.0f, 1.0f, 43, 3);
+    if (rows * cols > 1) REQUIRE_FALSE(parallel == serial);
+  }
+}
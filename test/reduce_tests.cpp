@@ -0,0 +1,207 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "hpc_tutor/reduce.hpp"
+#include "test_utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+template <typename T>
+struct Naive {
+  std::vector<T> rowSums, rowMins, rowMaxs, colSums, colMins, colMaxs;
+  std::vector<size_t> rowArgMaxs, colArgMaxs;
+
+  explicit Naive(const tutor::MatrixView<T>& m)
+      : rowSums(m.rows(), 0),
+        rowMins(m.rows(), tutor::detail::MinIdentity<T>()),
+        rowMaxs(m.rows(), tutor::detail::MaxIdentity<T>()),
+        colSums(m.cols(), 0),
+        colMins(m.cols(), tutor::detail::MinIdentity<T>()),
+        colMaxs(m.cols(), tutor::detail::MaxIdentity<T>()),
+        rowArgMaxs(m.rows(), 0),
+        colArgMaxs(m.cols(), 0) {
+    for (size_t j = 0; j < m.cols(); ++j) {
+      for (size_t i = 0; i < m.rows(); ++i) {
+        T x = m[i][j];
+        colSums[j] += x;
+        colMins[j] = std::min(colMins[j], x);
+        if (x > colMaxs[j]) colMaxs[j] = x, colArgMaxs[j] = i;
+      }
+    }
+    for (size_t i = 0; i < m.rows(); ++i) {
+      for (size_t j = 0; j < m.cols(); ++j) {
+        T x = m[i][j];
+        rowSums[i] += x;
+        rowMins[i] = std::min(rowMins[i], x);
+        if (x > rowMaxs[i]) rowMaxs[i] = x, rowArgMaxs[i] = j;
+      }
+    }
+  }
+};
+
+template <typename T>
+void WriteFile(const fs::path& path, const Matrix<T>& m) {
+  tutor::detail::BinaryFile(path.string(), "wb").Write(m.data(), m.size());
+}
+
+}  // namespace
+
+TEST_CASE("Row and column reductions", "[reduce]") {
+  // Strips of columns and a tail; the sub-view has a row stride.
+  auto cols = GENERATE(size_t(1), size_t(7), size_t(300), size_t(601));
+  auto whole = RandomMatrix<int>(53, cols + 3, -50, 50);
+  auto m = whole.view(2, 1, 50, cols);
+  Naive<int> truth(m);
+
+  std::vector<int> rows(m.rows()), columns(m.cols());
+  std::vector<size_t> rowArgs(m.rows()), colArgs(m.cols());
+
+  tutor::RowSums(rows.data(), m);
+  RequireEqual(rows, truth.rowSums);
+  tutor::RowMins(rows.data(), m);
+  RequireEqual(rows, truth.rowMins);
+  tutor::RowMaxs(rows.data(), m);
+  RequireEqual(rows, truth.rowMaxs);
+  // Ties are frequent with these values: the first index wins.
+  tutor::RowArgMaxs(rowArgs.data(), m);
+  REQUIRE(rowArgs == truth.rowArgMaxs);
+
+  tutor::ColSums(columns.data(), m);
+  RequireEqual(columns, truth.colSums);
+  tutor::ColMins(columns.data(), m);
+  RequireEqual(columns, truth.colMins);
+  tutor::ColMaxs(columns.data(), m);
+  RequireEqual(columns, truth.colMaxs);
+  tutor::ColArgMaxs(colArgs.data(), m);
+  REQUIRE(colArgs == truth.colArgMaxs);
+}
+
+TEST_CASE("Means", "[reduce]") {
+  auto m = RandomMatrix<double>(37, 45);
+  Naive<double> truth(m.view());
+
+  std::vector<double> rows(m.rows()), columns(m.cols());
+  tutor::RowMeans(rows.data(), m.view());
+  for (double& x : truth.rowSums) x /= m.cols();
+  RequireEqual(rows, truth.rowSums);
+  tutor::ColMeans(columns.data(), m.view());
+  for (double& x : truth.colSums) x /= m.rows();
+  RequireEqual(columns, truth.colSums);
+}
+
+TEST_CASE("NaN are skipped", "[reduce]") {
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  Matrix<double> m(2, 3);
+  m[0][0] = nan, m[0][1] = 2, m[0][2] = -1;
+  m[1][0] = nan, m[1][1] = nan, m[1][2] = nan;
+
+  std::vector<double> rows(2), columns(3);
+  std::vector<size_t> rowArgs(2), colArgs(3);
+  tutor::RowMaxs(rows.data(), m.view());
+  REQUIRE(rows[0] == 2);
+  REQUIRE(rows[1] == -std::numeric_limits<double>::infinity());
+  tutor::RowArgMaxs(rowArgs.data(), m.view());
+  REQUIRE(rowArgs == std::vector<size_t>{1, 0});
+  tutor::ColMins(columns.data(), m.view());
+  REQUIRE(columns[0] == std::numeric_limits<double>::infinity());
+  REQUIRE(columns[2] == -1);
+  tutor::ColArgMaxs(colArgs.data(), m.view());
+  REQUIRE(colArgs == std::vector<size_t>{0, 0, 0});
+}
+
+TEST_CASE("Threaded reductions", "[reduce]") {
+  // Tall and narrow, and large enough to run on several threads.
+  auto rows = GENERATE(size_t(3), size_t(20000));
+  auto m = RandomMatrix<int>(rows, 17, -1000, 1000);
+  Naive<int> truth(m.view());
+
+  std::vector<int> r(m.rows()), c(m.cols());
+  std::vector<size_t> rowArgs(m.rows()), colArgs(m.cols());
+  tutor::RowSums_t(r.data(), m.view());
+  RequireEqual(r, truth.rowSums);
+  tutor::RowMins_t(r.data(), m.view());
+  RequireEqual(r, truth.rowMins);
+  tutor::RowMaxs_t(r.data(), m.view());
+  RequireEqual(r, truth.rowMaxs);
+  tutor::RowArgMaxs_t(rowArgs.data(), m.view());
+  REQUIRE(rowArgs == truth.rowArgMaxs);
+
+  tutor::ColSums_t(c.data(), m.view());
+  RequireEqual(c, truth.colSums);
+  tutor::ColMins_t(c.data(), m.view());
+  RequireEqual(c, truth.colMins);
+  tutor::ColMaxs_t(c.data(), m.view());
+  RequireEqual(c, truth.colMaxs);
+  tutor::ColArgMaxs_t(colArgs.data(), m.view());
+  REQUIRE(colArgs == truth.colArgMaxs);
+
+  auto d = RandomMatrix<double>(rows, 17);
+  std::vector<double> means(d.cols()), serial(d.cols());
+  tutor::ColMeans_t(means.data(), d.view());
+  tutor::ColMeans(serial.data(), d.view());
+  RequireEqual(means, serial);
+}
+
+TEST_CASE("Column statistics by chunks", "[reduce]") {
+  auto m = RandomMatrix<int>(101, 13, 0, 10);
+  Naive<int> truth(m.view());
+
+  tutor::ColumnStats<int> stats(m.cols());
+  for (size_t i = 0; i < m.rows(); i += 10) {
+    stats.Add(m.view(i, 0, std::min<size_t>(10, m.rows() - i), m.cols()));
+  }
+  REQUIRE(stats.rows() == m.rows());
+  REQUIRE(stats.sums() == truth.colSums);
+  REQUIRE(stats.mins() == truth.colMins);
+  REQUIRE(stats.maxs() == truth.colMaxs);
+  REQUIRE(stats.argMaxs() == truth.colArgMaxs);
+  REQUIRE_THROWS_AS(stats.Add(m.view(0, 0, 1, 12)), std::invalid_argument);
+}
+
+TEST_CASE("Streamed column reductions", "[reduce]") {
+  fs::path dir = fs::temp_directory_path() / "hpc_tutor_reduce_tests";
+  fs::create_directories(dir);
+  fs::path path = dir / "matrix.bin";
+
+  auto m = RandomMatrix<double>(1000, 33);
+  WriteFile(path, m);
+  Naive<double> truth(m.view());
+
+  auto chunkRows = GENERATE(size_t(0), size_t(1), size_t(7), size_t(1000));
+  size_t next = 0;
+  size_t rows = tutor::ForEachRowChunk<double>(
+      path.string(), m.cols(), chunkRows,
+      [&](const tutor::MatrixView<double>& chunk, size_t first) {
+        REQUIRE(first == next);
+        REQUIRE(chunk.cols() == m.cols());
+        for (size_t i = 0; i < chunk.rows(); ++i) {
+          REQUIRE(chunk[i][5] == m[first + i][5]);
+        }
+        next += chunk.rows();
+      });
+  REQUIRE(rows == m.rows());
+  REQUIRE(next == m.rows());
+
+  auto stats = tutor::ReduceColumns<double>(path.string(), m.cols(), chunkRows);
+  REQUIRE(stats.rows() == m.rows());
+  // Each column is added in row order, as by the naive loop.
+  REQUIRE(stats.sums() == truth.colSums);
+  REQUIRE(stats.mins() == truth.colMins);
+  REQUIRE(stats.maxs() == truth.colMaxs);
+  REQUIRE(stats.argMaxs() == truth.colArgMaxs);
+  std::vector<double> means(m.cols());
+  tutor::ColMeans(means.data(), m.view());
+  RequireEqual(stats.Means(), means);
+
+  REQUIRE_THROWS_AS(tutor::ReduceColumns<double>(path.string(), 31),
+                    std::invalid_argument);
+  fs::remove_all(dir);
+}
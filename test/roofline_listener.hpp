@@ -0,0 +1,93 @@
+#ifndef HPC_TUTOR_ROOFLINE_LISTENER_HPP_
+#define HPC_TUTOR_ROOFLINE_LISTENER_HPP_
+
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/roofline.hpp"
+
+/**
+ * Work done by one run of a benchmark.
+ */
+struct RooflineWork {
+  double flops = 0;
+  double bytes = 0;       ///< Moved from or to the working set.
+  size_t workingSet = 0;  ///< Bytes, to pick the cache level.
+  size_t threads = 1;
+};
+
+inline std::map<std::string, RooflineWork>& RooflineWorks() {
+  static std::map<std::string, RooflineWork> works;
+  return works;
+}
+
+/**
+ * Declares the work of benchmark `name`, so that its mean time
+ * is reported against the roofline profile (see calibration.cpp).
+ */
+inline void SetRooflineWork(const std::string& name, double flops,
+                            double bytes, size_t workingSet,
+                            size_t threads = 1) {
+  RooflineWorks()[name] = {flops, bytes, workingSet, threads};
+}
+
+/**
+ * Prints, at the end of the run, the benchmarks with declared work
+ * as a percentage of the shortest time allowed by the roofline profile
+ * of `tutor::Roofline::Load`.
+ */
+class RooflineListener : public Catch::EventListenerBase {
+ public:
+  using EventListenerBase::EventListenerBase;
+
+  void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override {
+    auto work = RooflineWorks().find(stats.info.name);
+    if (work == RooflineWorks().end()) return;
+    double seconds =
+        std::chrono::duration<double>(stats.mean.point).count();
+    results_.push_back({stats.info.name, work->second, seconds});
+  }
+
+  void testRunEnded(const Catch::TestRunStats&) override {
+    if (results_.empty()) return;
+    auto roofline = tutor::Roofline::Load();
+    if (roofline.empty()) {
+      std::printf(
+          "\nNo roofline profile: run calibration, "
+          "or set HPC_TUTOR_ROOFLINE to its output.\n");
+      return;
+    }
+    std::printf("\n%-32s %10s %10s %10s %s\n", "benchmark", "GFLOP/s",
+                "GB/s", "roofline", "bound");
+    for (const auto& r : results_) {
+      const RooflineWork& w = r.work;
+      double best =
+          roofline.MinSeconds(w.threads, w.flops, w.bytes, w.workingSet);
+      bool bandwidth =
+          roofline.BandwidthBound(w.threads, w.flops, w.bytes, w.workingSet);
+      std::printf("%-32s %10.2f %10.2f %9.1f%% %s\n", r.name.c_str(),
+                  w.flops / r.seconds / 1e9, w.bytes / r.seconds / 1e9,
+                  100 * best / r.seconds,
+                  bandwidth ? "bandwidth" : "compute");
+    }
+  }
+
+ private:
+  struct Result {
+    std::string name;
+    RooflineWork work;
+    double seconds;
+  };
+
+  std::vector<Result> results_;
+};
+
+CATCH_REGISTER_LISTENER(RooflineListener)
+
+#endif  // HPC_TUTOR_ROOFLINE_LISTENER_HPP_
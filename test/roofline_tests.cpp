@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <stdexcept>
+
+#include "hpc_tutor/roofline.hpp"
+
+namespace {
+
+tutor::Roofline Example() {
+  tutor::Roofline r;
+  r.SetPeak(1, 50e9);
+  r.SetPeak(4, 180e9);
+  // 1 thread: L1, L2, then memory.
+  r.Add(tutor::BandwidthSample{1, 32 << 10, 200e9});
+  r.Add(tutor::BandwidthSample{1, 1 << 20, 80e9});
+  r.Add(tutor::BandwidthSample{1, 1 << 30, 10e9});
+  r.Add(tutor::BandwidthSample{4, 1 << 30, 30e9});
+  r.Add(tutor::StreamSample{"triad", -1, 1, 9e9});
+  return r;
+}
+
+}  // namespace
+
+TEST_CASE("Roofline ceilings", "[roofline]") {
+  auto r = Example();
+  REQUIRE_FALSE(r.empty());
+  REQUIRE(tutor::Roofline().empty());
+
+  SECTION("Peak") {
+    REQUIRE(r.Peak(1) == 50e9);
+    REQUIRE(r.Peak(4) == 180e9);
+    // Scaled from the largest measured count below.
+    REQUIRE(r.Peak(2) == 100e9);
+    REQUIRE(r.Peak(8) == 360e9);
+  }
+
+  SECTION("Bandwidth by working set") {
+    REQUIRE(r.Bandwidth(1, 1024) == 200e9);
+    REQUIRE(r.Bandwidth(1, 32 << 10) == 200e9);
+    REQUIRE(r.Bandwidth(1, 64 << 10) == 80e9);
+    REQUIRE(r.Bandwidth(1, size_t(1) << 34) == 10e9);
+    // Samples of the largest measured count not above.
+    REQUIRE(r.Bandwidth(2, 1024) == 200e9);
+    REQUIRE(r.Bandwidth(8, 1024) == 30e9);
+    // Samples below that of a larger working set are noise.
+    r.Add(tutor::BandwidthSample{1, 4 << 20, 90e9});
+    REQUIRE(r.Bandwidth(1, 64 << 10) == 90e9);
+    REQUIRE(r.Bandwidth(1, 2 << 20) == 90e9);
+  }
+
+  SECTION("Attainable time") {
+    // Triad-like: 2 FLOPs per 24 bytes from memory.
+    double n = 1e8;
+    REQUIRE(r.MinSeconds(1, 2 * n, 24 * n, 1 << 30) == 24 * n / 10e9);
+    REQUIRE(r.BandwidthBound(1, 2 * n, 24 * n, 1 << 30));
+    // Gemm-like: 2n^3 FLOPs on 3n^2 doubles in L2.
+    double m = 200;
+    double bytes = 24 * m * m;
+    REQUIRE(r.MinSeconds(1, 2 * m * m * m, bytes, bytes) ==
+            2 * m * m * m / 50e9);
+    REQUIRE_FALSE(r.BandwidthBound(1, 2 * m * m * m, bytes, bytes));
+  }
+}
+
+TEST_CASE("Roofline profiles", "[roofline]") {
+  auto r = Example();
+  std::stringstream file;
+  file << "# comment\n\nnote unknown keywords are skipped\n";
+  r.Write(file);
+  auto read = tutor::Roofline::Read(file);
+  REQUIRE(read.peaks() == r.peaks());
+  REQUIRE(read.bandwidths().size() == r.bandwidths().size());
+  for (size_t i = 0; i < r.bandwidths().size(); ++i) {
+    REQUIRE(read.bandwidths()[i].threads == r.bandwidths()[i].threads);
+    REQUIRE(read.bandwidths()[i].bytes == r.bandwidths()[i].bytes);
+    REQUIRE(read.bandwidths()[i].bytesPerSecond ==
+            r.bandwidths()[i].bytesPerSecond);
+  }
+  REQUIRE(read.streams().size() == 1);
+  REQUIRE(read.streams()[0].kernel == "triad");
+  REQUIRE(read.streams()[0].node == -1);
+  REQUIRE(read.streams()[0].bytesPerSecond == 9e9);
+
+  std::istringstream bad("peak 1\n");
+  REQUIRE_THROWS_AS(tutor::Roofline::Read(bad), std::invalid_argument);
+}
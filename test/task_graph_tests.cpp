@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <mutex>
+#include <vector>
+
+#include "hpc_tutor/linalg.hpp"
+#include "hpc_tutor/matrix.hpp"
+#include "hpc_tutor/task_graph.hpp"
+#include "test_utils.hpp"
+
+TEST_CASE("TaskGraph follows access dependencies", "[task-graph]") {
+  tutor::ThreadPool pool(4, false);
+  std::vector<int> x(2, 0);
+  std::vector<int> log;
+  std::mutex mutex;
+  auto record = [&](int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    log.push_back(id);
+  };
+  auto a = tutor::Access::Write(x.data(), 1);
+  auto ra = tutor::Access::Read(x.data(), 1);
+  auto b = tutor::Access::Write(x.data() + 1, 1);
+  tutor::TaskGraph graph;
+  graph.Add([&] { record(0); }, {a});
+  graph.Add([&] { record(1); }, {ra});
+  graph.Add([&] { record(2); }, {ra});
+  graph.Add([&] { record(3); }, {a});
+  graph.Add([&] { record(4); }, {b}, 10);
+  graph.Run(pool);
+  REQUIRE(log.size() == 5);
+  auto pos = [&](int id) {
+    return std::find(log.begin(), log.end(), id) - log.begin();
+  };
+  REQUIRE(pos(0) < pos(1));
+  REQUIRE(pos(0) < pos(2));
+  REQUIRE(pos(1) < pos(3));
+  REQUIRE(pos(2) < pos(3));
+  REQUIRE(graph.priority(0) == 3);
+  REQUIRE(graph.priority(4) == 10);
+}
+
+TEST_CASE("LuFact_bt", "[task-graph]") {
+  constexpr size_t n = 37;
+  auto m = RandomMatrix<double>(n, n);
+  // Diagonal dominance guarantees that the unpivoted LU exists.
+  for (size_t i = 0; i < n; ++i) m[i][i] += n;
+  auto lu = m;
+  tutor::ThreadPool pool(3, false);
+  size_t bs = GENERATE(1, 4, 8, 37, 40);
+  INFO("bs = " << bs);
+  tutor::LuFact_bt(pool, lu.view(), bs);
+  auto l = Matrix<double>(n, n);
+  auto u = Matrix<double>(n, n);
+  auto mul = Matrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      (j < i ? l[i][j] : u[i][j]) = lu[i][j];
+    }
+    l[i][i] = 1;
+  }
+  tutor::Gemm(mul.view(), l.view(), u.view());
+  RequireEqual(mul, m);
+}
+
+TEST_CASE("LuFactAsync", "[task-graph]") {
+  constexpr size_t n = 37;
+  auto m = RandomMatrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) m[i][i] += n;
+  auto lu = m;
+  tutor::LuFact_bt(m.view(), 8);
+  auto f = tutor::LuFactAsync(lu.view(), 8);
+  f.wait();
+  // Same tasks on the same tiles, in the same order per tile.
+  REQUIRE(lu == m);
+}
+
+TEST_CASE("Cholesky_bt", "[task-graph]") {
+  constexpr size_t n = 29;
+  auto b = RandomMatrix<double>(n, n);
+  auto spd = Matrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      for (size_t k = 0; k < n; ++k) spd[i][j] += b[i][k] * b[j][k];
+    }
+    spd[i][i] += n;
+  }
+  auto chol = spd;
+  tutor::ThreadPool pool(3, false);
+  size_t bs = GENERATE(1, 5, 8, 29);
+  INFO("bs = " << bs);
+  tutor::Cholesky_bt(pool, chol.view(), bs);
+  auto l = Matrix<double>(n, n);
+  auto lt = Matrix<double>(n, n);
+  auto mul = Matrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j <= i; ++j) l[i][j] = lt[j][i] = chol[i][j];
+  }
+  tutor::Gemm(mul.view(), l.view(), lt.view());
+  RequireEqual(mul, spd);
+}
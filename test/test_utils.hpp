@@ -1,111 +1,327 @@
 #ifndef HPC_TUTOR_TEST_UTILS_HPP_
 #define HPC_TUTOR_TEST_UTILS_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
-#include <functional>
-#include <random>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
 #include <type_traits>
 #include <vector>
 
+#include "hpc_tutor/cpu.hpp"
 #include "hpc_tutor/matrix.hpp"
+#include "hpc_tutor/random.hpp"
+#include "hpc_tutor/thread_pool.hpp"
 
 template <typename T>
 using Matrix = tutor::Matrix<T>;
 using Catch::Matchers::WithinAbs;
 using Catch::Matchers::WithinRel;
 
+/**
+ * Returns a new stream of the test random sequence.
+ * Every call to the generators below draws from a different stream,
+ * so inputs are independent but reproducible for a given seed.
+ */
+inline uint64_t NextRandomStream() {
+  static std::atomic<uint64_t> stream(0);
+  return stream.fetch_add(1, std::memory_order_relaxed);
+}
+
 template <typename T, std::enable_if_t<std::is_integral_v<T>, bool> = true>
 Matrix<T> RandomMatrix(size_t rows, size_t cols, T low = 0, T high = 100) {
-  static std::mt19937 rng;
-  if (rng == std::mt19937{}) rng.seed(Catch::getSeed());
-  auto dist = std::uniform_int_distribution<T>(low, high);
-  Matrix<T> m(rows, cols);
-  std::generate_n(m.data(), m.size(), std::bind(dist, rng));
+  Matrix<T> m(rows, cols, tutor::uninitialized);
+  tutor::FillUniform_t(m.view(), low, high, Catch::getSeed(),
+                       NextRandomStream());
   return m;
 }
 
 template <typename T,
           std::enable_if_t<std::is_floating_point_v<T>, bool> = true>
 Matrix<T> RandomMatrix(size_t rows, size_t cols, T low = 0, T high = 1) {
-  static std::mt19937 rng;
-  if (rng == std::mt19937{}) rng.seed(Catch::getSeed());
-  auto dist = std::uniform_real_distribution<T>(low, high);
-  Matrix<T> m(rows, cols);
-  std::generate_n(m.data(), m.size(), std::bind(dist, rng));
+  Matrix<T> m(rows, cols, tutor::uninitialized);
+  tutor::FillUniform_t(m.view(), low, high, Catch::getSeed(),
+                       NextRandomStream());
+  return m;
+}
+
+/**
+ * Returns a random symmetric positive definite matrix:
+ * off-diagonal values in [0, 1) and diagonal values in [n, n + 1),
+ * so it is strictly diagonally dominant.
+ */
+template <typename T,
+          std::enable_if_t<std::is_floating_point_v<T>, bool> = true>
+Matrix<T> RandomSpdMatrix(size_t n) {
+  auto m = RandomMatrix<T>(n, n);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < i; ++j) m[j][i] = m[i][j];
+    m[i][i] += static_cast<T>(n);
+  }
   return m;
 }
 
 template <typename T, std::enable_if_t<std::is_integral_v<T>, bool> = true>
 std::vector<T> RandomVector(size_t n, T low = 0, T high = 100) {
-  static std::mt19937 rng;
-  if (rng == std::mt19937{}) rng.seed(Catch::getSeed());
-  auto dist = std::uniform_int_distribution<T>(low, high);
   std::vector<T> v(n);
-  std::generate(v.begin(), v.end(), std::bind(dist, rng));
+  tutor::FillUniform_t(v.data(), n, low, high, Catch::getSeed(),
+                       NextRandomStream());
   return v;
 }
 
 template <typename T,
           std::enable_if_t<std::is_floating_point_v<T>, bool> = true>
 std::vector<T> RandomVector(size_t n, T low = 0, T high = 1) {
-  static std::mt19937 rng;
-  if (rng == std::mt19937{}) rng.seed(Catch::getSeed());
-  auto dist = std::uniform_real_distribution<T>(low, high);
   std::vector<T> v(n);
-  std::generate(v.begin(), v.end(), std::bind(dist, rng));
+  tutor::FillUniform_t(v.data(), n, low, high, Catch::getSeed(),
+                       NextRandomStream());
   return v;
 }
 
-template <typename T, std::enable_if_t<std::is_integral_v<T>, bool> = true>
-void RequireEqual(const Matrix<T>& result, const Matrix<T>& truth) {
-  INFO("Matrix result differs from matrix truth");
-  INFO("result:\n" << result << "\ntruth:\n" << truth);
-  REQUIRE(result.rows() == truth.rows());
-  REQUIRE(result.cols() == truth.cols());
-  for (size_t i = 0; i < truth.rows(); ++i) {
-    for (size_t j = 0; j < truth.cols(); ++j) {
-      INFO("Matrices differ at position " << i << ", " << j);
-      REQUIRE(result[i][j] == truth[i][j]);
+/**
+ * Element-wise differences between a result and its truth.
+ */
+struct Comparison {
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  size_t count = 0;              ///< Elements compared.
+  size_t mismatches = 0;         ///< Elements out of tolerance.
+  size_t firstMismatch = kNone;  ///< Index of the first of them.
+  double maxAbsError = 0;        ///< NaN if an element is NaN.
+  size_t maxAbsIndex = kNone;
+  double maxRelError = 0;  ///< Relative to max(|result|, |truth|).
+  /**
+   * Distance in units in the last place: the number of representable
+   * values between result and truth, or their difference for integers.
+   */
+  uint64_t maxUlps = 0;
+  double meanUlps = 0;
+};
+
+/**
+ * Returns the ULP distance of `a` and `b`.
+ */
+template <typename T>
+uint64_t UlpDistance(T a, T b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    // Maps the bits to integers in the order of the values,
+    // with -0 and +0 both at 0.
+    using Bits = std::conditional_t<sizeof(T) == 8, int64_t, int32_t>;
+    static_assert(sizeof(T) == sizeof(Bits));
+    Bits x, y;
+    std::memcpy(&x, &a, sizeof(T));
+    std::memcpy(&y, &b, sizeof(T));
+    int64_t ox = x < 0 ? std::numeric_limits<Bits>::min() - x : x;
+    int64_t oy = y < 0 ? std::numeric_limits<Bits>::min() - y : y;
+    return ox > oy ? static_cast<uint64_t>(ox) - static_cast<uint64_t>(oy)
+                   : static_cast<uint64_t>(oy) - static_cast<uint64_t>(ox);
+  } else {
+    return a > b ? static_cast<uint64_t>(a) - static_cast<uint64_t>(b)
+                 : static_cast<uint64_t>(b) - static_cast<uint64_t>(a);
+  }
+}
+
+/**
+ * Returns whether `result` is within tolerance of `truth`:
+ * equal, or with an absolute or a relative error of at most `tolerance`.
+ * Integers must be equal.
+ */
+template <typename T>
+bool WithinTolerance(T result, T truth, double tolerance) {
+  if constexpr (std::is_floating_point_v<T>) {
+    double diff = std::abs(static_cast<double>(result) - truth);
+    double scale = std::max(std::abs(static_cast<double>(result)),
+                            std::abs(static_cast<double>(truth)));
+    return result == truth || diff <= tolerance || diff <= tolerance * scale;
+  } else {
+    static_cast<void>(tolerance);
+    return result == truth;
+  }
+}
+
+/**
+ * Compares `n` elements in one pass, without branches,
+ * so that the loop vectorizes; the first mismatch is only searched
+ * in the block that has it.
+ */
+template <typename T>
+Comparison CompareBlock(const T* result, const T* truth, size_t n,
+                        double tolerance) {
+  Comparison c;
+  c.count = n;
+  double sumUlps = 0;
+  tutor::detail::Dispatch([&] {
+    size_t mismatches = 0, nans = 0;
+    double maxAbs = 0, maxRel = 0;
+    uint64_t maxUlps = 0;
+    for (size_t i = 0; i < n; ++i) {
+      double diff = std::abs(static_cast<double>(result[i]) -
+                             static_cast<double>(truth[i]));
+      double scale = std::max(std::abs(static_cast<double>(result[i])),
+                              std::abs(static_cast<double>(truth[i])));
+      double rel = diff == 0 ? 0 : diff / scale;
+      uint64_t ulps = UlpDistance(result[i], truth[i]);
+      mismatches += !WithinTolerance(result[i], truth[i], tolerance);
+      nans += std::isnan(diff);
+      maxAbs = std::max(maxAbs, diff);
+      maxRel = std::max(maxRel, rel);
+      maxUlps = std::max(maxUlps, ulps);
+      sumUlps += static_cast<double>(ulps);
+    }
+    c.mismatches = mismatches;
+    c.maxAbsError = nans == 0 ? maxAbs : std::nan("");
+    c.maxRelError = maxRel;
+    c.maxUlps = maxUlps;
+  });
+  c.meanUlps = n == 0 ? 0 : sumUlps / n;
+  for (size_t i = 0; c.mismatches != 0 && i < n; ++i) {
+    if (!WithinTolerance(result[i], truth[i], tolerance)) {
+      c.firstMismatch = i;
+      break;
     }
   }
+  return c;
 }
 
-template <typename T,
-          std::enable_if_t<std::is_floating_point_v<T>, bool> = true>
-void RequireEqual(const Matrix<T>& result, const Matrix<T>& truth) {
-  INFO("Matrix result differs from matrix truth");
-  INFO("result:\n" << result << "\ntruth:\n" << truth);
-  REQUIRE(result.rows() == truth.rows());
-  REQUIRE(result.cols() == truth.cols());
-  for (size_t i = 0; i < truth.rows(); ++i) {
-    for (size_t j = 0; j < truth.cols(); ++j) {
-      INFO("Matrices differ at position " << i << ", " << j);
-      REQUIRE_THAT(result[i][j], WithinRel(truth[i][j], 1e-6) ||
-                                     WithinAbs(truth[i][j], 1e-6));
+/**
+ * Compares `n` elements of `result` with those of `truth`.
+ *
+ * Blocks of elements are compared in parallel on the global thread pool,
+ * then merged in order, so the statistics do not depend on the threads.
+ * Floating point elements match if they are within `tolerance`,
+ * absolute or relative; integers must be equal.
+ */
+template <typename T>
+Comparison Compare(const T* result, const T* truth, size_t n,
+                   double tolerance = 1e-6) {
+  constexpr size_t kBlock = size_t(1) << 16;
+  size_t blocks = std::max<size_t>(1, (n + kBlock - 1) / kBlock);
+  std::vector<Comparison> partials(blocks);
+  auto compare = [&](size_t lo, size_t hi) {
+    for (size_t b = lo; b < hi; ++b) {
+      size_t begin = b * kBlock, len = std::min(n - begin, kBlock);
+      partials[b] = CompareBlock(result + begin, truth + begin, len,
+                                 tolerance);
+    }
+  };
+  if (blocks == 1) {
+    compare(0, 1);
+  } else {
+    tutor::ThreadPool::Global().ParallelFor(0, blocks, 1, compare);
+  }
+
+  Comparison ret;
+  double sumUlps = 0;
+  size_t maxBlock = 0;
+  for (size_t b = 0; b < blocks; ++b) {
+    const Comparison& p = partials[b];
+    if (ret.firstMismatch == Comparison::kNone &&
+        p.firstMismatch != Comparison::kNone) {
+      ret.firstMismatch = b * kBlock + p.firstMismatch;
+    }
+    // NaN, once seen, stays.
+    if (!std::isnan(ret.maxAbsError) && !(p.maxAbsError <= ret.maxAbsError)) {
+      ret.maxAbsError = p.maxAbsError;
+      maxBlock = b;
+    }
+    ret.count += p.count;
+    ret.mismatches += p.mismatches;
+    ret.maxRelError = std::max(ret.maxRelError, p.maxRelError);
+    ret.maxUlps = std::max(ret.maxUlps, p.maxUlps);
+    sumUlps += p.meanUlps * p.count;
+  }
+  ret.meanUlps = n == 0 ? 0 : sumUlps / n;
+  // Locates the largest error in its block, NaN first.
+  for (size_t i = maxBlock * kBlock; i < std::min(n, (maxBlock + 1) * kBlock);
+       ++i) {
+    double diff = std::abs(static_cast<double>(result[i]) -
+                           static_cast<double>(truth[i]));
+    if (diff == ret.maxAbsError || std::isnan(diff)) {
+      ret.maxAbsIndex = i;
+      break;
     }
   }
+  return ret;
 }
 
-template <typename T, std::enable_if_t<std::is_integral_v<T>, bool> = true>
-void RequireEqual(const std::vector<T>& result, const std::vector<T>& truth) {
-  INFO("Vector result differs from vector truth");
-  REQUIRE(result.size() == truth.size());
-  for (size_t i = 0; i < truth.size(); ++i) {
-    INFO("Vectors differ at position " << i);
-    REQUIRE(result[i] == truth[i]);
+/**
+ * Returns a description of the differences of `comparison`:
+ * its statistics and, around the first mismatch,
+ * a window of the `rows` x `cols` result and truth,
+ * with mismatches marked by '*'.
+ */
+template <typename T>
+std::string DiffReport(const T* result, const T* truth, size_t rows,
+                       size_t cols, const Comparison& comparison,
+                       double tolerance = 1e-6) {
+  constexpr size_t kRadius = 2;
+  std::ostringstream os;
+  auto at = [&](size_t index) {
+    return "(" + std::to_string(index / cols) + ", " +
+           std::to_string(index % cols) + ")";
+  };
+  os << comparison.mismatches << " of " << comparison.count
+     << " elements differ\nmax abs error " << comparison.maxAbsError;
+  if (comparison.maxAbsIndex != Comparison::kNone) {
+    os << " at " << at(comparison.maxAbsIndex);
+  }
+  os << ", max rel error " << comparison.maxRelError << ", max ULPs "
+     << comparison.maxUlps << ", mean ULPs " << comparison.meanUlps;
+  if (comparison.firstMismatch == Comparison::kNone) return os.str();
+  size_t i = comparison.firstMismatch / cols;
+  size_t j = comparison.firstMismatch % cols;
+  auto precision = os.precision(std::numeric_limits<T>::max_digits10);
+  os << "\nfirst mismatch at " << at(comparison.firstMismatch) << ": "
+     << +result[comparison.firstMismatch] << " instead of "
+     << +truth[comparison.firstMismatch];
+  os.precision(precision);
+  size_t i0 = i > kRadius ? i - kRadius : 0;
+  size_t i1 = std::min(rows, i + kRadius + 1);
+  size_t j0 = j > kRadius ? j - kRadius : 0;
+  size_t j1 = std::min(cols, j + kRadius + 1);
+  for (const T* m : {result, truth}) {
+    os << "\n" << (m == result ? "result" : "truth") << " rows " << i0
+       << "-" << i1 - 1 << ", cols " << j0 << "-" << j1 - 1 << ":";
+    for (size_t r = i0; r < i1; ++r) {
+      os << "\n ";
+      for (size_t c = j0; c < j1; ++c) {
+        size_t k = r * cols + c;
+        bool bad = !WithinTolerance(result[k], truth[k], tolerance);
+        os << std::setw(12) << +m[k] << (bad ? '*' : ' ');
+      }
+    }
   }
+  return os.str();
 }
 
-template <typename T,
-          std::enable_if_t<std::is_floating_point_v<T>, bool> = true>
+template <typename T>
+void RequireEqual(const Matrix<T>& result, const Matrix<T>& truth) {
+  INFO("Matrix result differs from matrix truth");
+  REQUIRE(result.rows() == truth.rows());
+  REQUIRE(result.cols() == truth.cols());
+  auto c = Compare(result.data(), truth.data(), truth.size());
+  INFO((c.mismatches == 0 ? std::string()
+                          : DiffReport(result.data(), truth.data(),
+                                       truth.rows(), truth.cols(), c)));
+  REQUIRE(c.mismatches == 0);
+}
+
+template <typename T>
 void RequireEqual(const std::vector<T>& result, const std::vector<T>& truth) {
   INFO("Vector result differs from vector truth");
   REQUIRE(result.size() == truth.size());
-  for (size_t i = 0; i < truth.size(); ++i) {
-    INFO("Vectors differ at position " << i);
-    REQUIRE_THAT(result[i],
-                 WithinRel(truth[i], 1e-6) || WithinAbs(truth[i], 1e-6));
-  }
+  auto c = Compare(result.data(), truth.data(), truth.size());
+  INFO((c.mismatches == 0 ? std::string()
+                          : DiffReport(result.data(), truth.data(), 1,
+                                       truth.size(), c)));
+  REQUIRE(c.mismatches == 0);
 }
 
 #endif  // HPC_TUTOR_TEST_UTILS_HPP_
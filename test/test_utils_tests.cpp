@@ -0,0 +1,95 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "test_utils.hpp"
+
+TEST_CASE("UlpDistance", "[test-utils]") {
+  REQUIRE(UlpDistance(1.0, 1.0) == 0);
+  REQUIRE(UlpDistance(1.0, std::nextafter(1.0, 2.0)) == 1);
+  REQUIRE(UlpDistance(std::nextafter(1.0f, 0.0f), 1.0f) == 1);
+  REQUIRE(UlpDistance(-0.0, 0.0) == 0);
+  double tiny = std::numeric_limits<double>::denorm_min();
+  REQUIRE(UlpDistance(-tiny, tiny) == 2);
+  REQUIRE(UlpDistance(-3, 4) == 7);
+  REQUIRE(UlpDistance(std::numeric_limits<int64_t>::min(),
+                      std::numeric_limits<int64_t>::max()) ==
+          std::numeric_limits<uint64_t>::max());
+}
+
+TEST_CASE("Compare", "[test-utils]") {
+  // Several blocks of the parallel comparison.
+  constexpr size_t rows = 700, cols = 1000;
+  auto truth = RandomMatrix<double>(rows, cols, 1, 2);
+  auto result = truth;
+
+  SECTION("Equal") {
+    auto c = Compare(result.data(), truth.data(), truth.size());
+    REQUIRE(c.count == rows * cols);
+    REQUIRE(c.mismatches == 0);
+    REQUIRE(c.firstMismatch == Comparison::kNone);
+    REQUIRE(c.maxAbsError == 0);
+    REQUIRE(c.maxUlps == 0);
+    RequireEqual(result, truth);
+  }
+
+  SECTION("Within tolerance") {
+    for (size_t i = 0; i < rows; i += 2) {
+      result[i][7] = std::nextafter(truth[i][7], 3.0);
+    }
+    auto c = Compare(result.data(), truth.data(), truth.size());
+    REQUIRE(c.mismatches == 0);
+    REQUIRE(c.maxUlps == 1);
+    REQUIRE(c.meanUlps == 350.0 / (rows * cols));
+    REQUIRE(c.maxAbsIndex == 7);
+    RequireEqual(result, truth);
+  }
+
+  SECTION("Mismatches") {
+    result[400][3] += 1e-3;
+    result[650][999] -= 0.5;
+    result[600][0] += 1e-2;
+    auto c = Compare(result.data(), truth.data(), truth.size());
+    REQUIRE(c.mismatches == 3);
+    REQUIRE(c.firstMismatch == 400 * cols + 3);
+    REQUIRE(c.maxAbsIndex == 650 * cols + 999);
+    REQUIRE(std::abs(c.maxAbsError - 0.5) < 1e-12);
+    REQUIRE(c.maxRelError <= 0.5);
+
+    auto report = DiffReport(result.data(), truth.data(), rows, cols, c);
+    REQUIRE(report.find("3 of 700000 elements differ") != std::string::npos);
+    REQUIRE(report.find("first mismatch at (400, 3)") != std::string::npos);
+    REQUIRE(report.find("rows 398-402, cols 1-5") != std::string::npos);
+    // One mismatch in each window.
+    size_t stars = 0;
+    for (char ch : report) stars += ch == '*';
+    REQUIRE(stars == 2);
+  }
+
+  SECTION("NaN") {
+    result[10][10] = std::numeric_limits<double>::quiet_NaN();
+    auto c = Compare(result.data(), truth.data(), truth.size());
+    REQUIRE(c.mismatches == 1);
+    REQUIRE(c.firstMismatch == 10 * cols + 10);
+    REQUIRE(std::isnan(c.maxAbsError));
+    REQUIRE(c.maxAbsIndex == 10 * cols + 10);
+  }
+}
+
+TEST_CASE("Compare integers", "[test-utils]") {
+  auto truth = RandomVector<int>(100000);
+  auto result = truth;
+  result[99999] += 3;
+  auto c = Compare(result.data(), truth.data(), truth.size());
+  REQUIRE(c.mismatches == 1);
+  REQUIRE(c.firstMismatch == 99999);
+  REQUIRE(c.maxUlps == 3);
+  auto report =
+      DiffReport(result.data(), truth.data(), 1, truth.size(), c);
+  REQUIRE(report.find("first mismatch at (0, 99999)") != std::string::npos);
+  result[99999] -= 3;
+  RequireEqual(result, truth);
+}
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "hpc_tutor/linalg.hpp"
+#include "hpc_tutor/linalg_t.hpp"
+#include "hpc_tutor/thread_pool.hpp"
+#include "test_utils.hpp"
+
+TEST_CASE("ParallelFor covers the range once", "[thread-pool]") {
+  size_t threads = GENERATE(1, 2, 4);
+  size_t grain = GENERATE(0, 1, 7, 1000);
+  tutor::ThreadPool pool(threads, false);
+  constexpr size_t n = 10000;
+  std::vector<std::atomic<int>> hits(n);
+  pool.ParallelFor(0, n, grain, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) hits[i].fetch_add(1);
+  });
+  for (size_t i = 0; i < n; ++i) {
+    INFO("threads = " << threads << ", grain = " << grain << ", i = " << i);
+    REQUIRE(hits[i].load() == 1);
+  }
+}
+
+#ifdef __linux__
+TEST_CASE("Pinned workers stay in the affinity mask", "[thread-pool]") {
+  cpu_set_t allowed;
+  REQUIRE(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+  tutor::ThreadPool pool(4, true);
+  auto caller = std::this_thread::get_id();
+  std::mutex mutex;
+  std::vector<cpu_set_t> workerMasks;
+  pool.ParallelFor(0, 64, 1, [&](size_t, size_t) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (std::this_thread::get_id() == caller) return;
+    cpu_set_t mask;
+    pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask);
+    std::lock_guard<std::mutex> lock(mutex);
+    workerMasks.push_back(mask);
+  });
+  for (auto& mask : workerMasks) {
+    cpu_set_t inside;
+    CPU_AND(&inside, &mask, &allowed);
+    REQUIRE(CPU_COUNT(&mask) == 1);
+    REQUIRE(CPU_EQUAL(&inside, &mask));
+  }
+}
+#endif
+
+TEST_CASE("Nested ParallelFor", "[thread-pool]") {
+  tutor::ThreadPool pool(4, false);
+  constexpr size_t n = 64;
+  std::vector<std::atomic<int>> hits(n * n);
+  pool.ParallelFor(0, n, 1, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) {
+      pool.ParallelFor(0, n, 4, [&](size_t jlo, size_t jhi) {
+        for (size_t j = jlo; j < jhi; ++j) hits[i * n + j].fetch_add(1);
+      });
+    }
+  });
+  REQUIRE(std::all_of(hits.begin(), hits.end(),
+                      [](const auto& h) { return h.load() == 1; }));
+}
+
+TEST_CASE("Pool backed _t routines", "[thread-pool]") {
+  tutor::ThreadPool pool(4, false);
+  size_t threshold = GENERATE(0, size_t(1) << 30);
+  pool.SetSerialThreshold(threshold);
+  INFO("serial threshold = " << threshold);
+  SECTION("Find_t") {
+    constexpr size_t n = 5000;
+    auto v = RandomVector<int>(n, 0, 1000);
+    REQUIRE(tutor::Find_t(pool, v.data(), n, v[n / 3]) ==
+            tutor::Find(v.data(), n, v[n / 3]));
+    REQUIRE(tutor::Find_t(pool, v.data(), n, -1) == n);
+  }
+  SECTION("MatrixEval_t") {
+    auto mat = RandomMatrix<int>(100, 37, 0, 10);
+    auto v = RandomVector<int>(37, 0, 10);
+    std::vector<int> truth(100), result(100);
+    tutor::MatrixEval(truth.data(), mat.view(), v.data());
+    tutor::MatrixEval_t(pool, result.data(), mat.view(), v.data());
+    RequireEqual(result, truth);
+    // No columns: the result is all zeros.
+    tutor::MatrixEval_t(pool, result.data(), mat.view(0, 0, 100, 0), v.data());
+    REQUIRE(std::all_of(result.begin(), result.end(),
+                        [](int x) { return x == 0; }));
+  }
+  SECTION("Gemm_t") {
+    auto lhs = RandomMatrix<int>(33, 20, -3, 3);
+    auto rhs = RandomMatrix<int>(20, 17, -3, 3);
+    auto truth = Matrix<int>(33, 17);
+    auto result = Matrix<int>(33, 17);
+    tutor::Gemm(truth.view(), lhs.view(), rhs.view());
+    tutor::Gemm_t(pool, result.view(), lhs.view(), rhs.view());
+    RequireEqual(result, truth);
+  }
+}
+
+TEST_CASE("Calibrate sets the serial threshold", "[thread-pool]") {
+  tutor::ThreadPool pool(2, false);
+  size_t threshold = pool.Calibrate();
+  REQUIRE(pool.serialThreshold() == threshold);
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "hpc_tutor/linalg.hpp"
+#include "hpc_tutor/matrix.hpp"
+#include "hpc_tutor/tiled_matrix.hpp"
+#include "test_utils.hpp"
+
+using tutor::TileOrder;
+using tutor::TiledMatrix;
+
+TEST_CASE("Morton order", "[tiled-matrix]") {
+  TiledMatrix<int> t(8, 8, 2, TileOrder::kMorton);
+  size_t area = 4;
+  REQUIRE(t.tile(0, 0).data() == t.data());
+  REQUIRE(t.tile(0, 1).data() == t.data() + 1 * area);
+  REQUIRE(t.tile(1, 0).data() == t.data() + 2 * area);
+  REQUIRE(t.tile(1, 1).data() == t.data() + 3 * area);
+  REQUIRE(t.tile(0, 2).data() == t.data() + 4 * area);
+  REQUIRE(t.tile(2, 0).data() == t.data() + 8 * area);
+  REQUIRE(t.tile(3, 3).data() == t.data() + 15 * area);
+}
+
+TEST_CASE("Row-major round trip", "[tiled-matrix]") {
+  auto order = GENERATE(TileOrder::kRowMajor, TileOrder::kMorton);
+  size_t ts = GENERATE(1, 3, 4, 64);
+  auto m = RandomMatrix<int>(13, 21);
+  auto t = TiledMatrix<int>::FromRowMajor(m.view(), ts, order);
+  for (size_t i = 0; i < m.rows(); ++i) {
+    for (size_t j = 0; j < m.cols(); ++j) {
+      REQUIRE(t(i, j) == m[i][j]);
+    }
+  }
+  auto back = Matrix<int>(13, 21);
+  t.ToRowMajor(back.view());
+  RequireEqual(back, m);
+}
+
+TEST_CASE("Tiled Gemm_b", "[tiled-matrix]") {
+  size_t ts = GENERATE(2, 5, 8);
+  auto lhs = RandomMatrix<double>(17, 11);
+  auto rhs = RandomMatrix<double>(11, 14);
+  auto truth = Matrix<double>(17, 14);
+  tutor::Gemm(truth.view(), lhs.view(), rhs.view());
+  auto tl = TiledMatrix<double>::FromRowMajor(lhs.view(), ts);
+  auto tr = TiledMatrix<double>::FromRowMajor(rhs.view(), ts);
+  TiledMatrix<double> tret(17, 14, ts);
+  tutor::Gemm_b(tret.view(), tl.view(), tr.view());
+  auto result = Matrix<double>(17, 14);
+  tret.ToRowMajor(result.view());
+  RequireEqual(result, truth);
+}
+
+TEST_CASE("Tiled Transpose and LuFact_b", "[tiled-matrix]") {
+  constexpr size_t n = 19;
+  size_t ts = GENERATE(1, 4, 7, 19);
+  auto m = RandomMatrix<double>(n, n);
+  for (size_t i = 0; i < n; ++i) m[i][i] += n;
+  SECTION("Transpose") {
+    auto t = TiledMatrix<double>::FromRowMajor(m.view(), ts);
+    tutor::Transpose(t.view());
+    auto result = Matrix<double>(n, n);
+    t.ToRowMajor(result.view());
+    tutor::Transpose(m.view());
+    RequireEqual(result, m);
+  }
+  SECTION("LuFact_b") {
+    auto t = TiledMatrix<double>::FromRowMajor(m.view(), ts);
+    tutor::LuFact_b(t.view());
+    auto l = Matrix<double>(n, n);
+    auto u = Matrix<double>(n, n);
+    auto mul = Matrix<double>(n, n);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < n; ++j) (j < i ? l[i][j] : u[i][j]) = t(i, j);
+      l[i][i] = 1;
+    }
+    tutor::Gemm(mul.view(), l.view(), u.view());
+    RequireEqual(mul, m);
+  }
+}
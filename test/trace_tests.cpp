@@ -0,0 +1,120 @@
+#ifndef HPC_TUTOR_TRACE
+#define HPC_TUTOR_TRACE
+#endif
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hpc_tutor/linalg_t.hpp"
+#include "hpc_tutor/task_graph.hpp"
+#include "hpc_tutor/trace.hpp"
+#include "test_utils.hpp"
+
+namespace {
+
+std::vector<tutor::TraceEvent> AllEvents() {
+  std::vector<tutor::TraceEvent> ret;
+  for (const auto& thread : tutor::Tracer::Global().Events()) {
+    ret.insert(ret.end(), thread.begin(), thread.end());
+  }
+  return ret;
+}
+
+size_t Count(const std::string& s, const std::string& what) {
+  size_t n = 0;
+  for (size_t p = s.find(what); p != std::string::npos;
+       p = s.find(what, p + 1)) {
+    ++n;
+  }
+  return n;
+}
+
+}  // namespace
+
+TEST_CASE("TraceBuffer keeps the last events", "[trace]") {
+  tutor::detail::TraceBuffer buffer(0, 4);
+  for (int64_t i = 0; i < 10; ++i) {
+    buffer.Record({"event", i, static_cast<uint64_t>(i), 0});
+  }
+  auto events = buffer.Events();
+  REQUIRE(events.size() == 4);
+  for (int64_t i = 0; i < 4; ++i) REQUIRE(events[i].id == 6 + i);
+  REQUIRE(buffer.dropped() == 6);
+  buffer.Clear();
+  REQUIRE(buffer.Events().empty());
+  REQUIRE(buffer.dropped() == 0);
+}
+
+TEST_CASE("Tracer records scopes only while started", "[trace]") {
+  auto& tracer = tutor::Tracer::Global();
+  tracer.Clear();
+  { HPC_TUTOR_TRACE_SCOPE("before"); }
+  tracer.Start();
+  {
+    HPC_TUTOR_TRACE_SCOPE("outer", 7);
+    HPC_TUTOR_TRACE_SCOPE("inner");
+  }
+  tracer.Stop();
+  { HPC_TUTOR_TRACE_SCOPE("after"); }
+  auto events = AllEvents();
+  REQUIRE(events.size() == 2);
+  // Scopes end in reverse order.
+  REQUIRE(std::string(events[0].name) == "inner");
+  REQUIRE(events[0].id == -1);
+  REQUIRE(std::string(events[1].name) == "outer");
+  REQUIRE(events[1].id == 7);
+  REQUIRE(events[1].begin <= events[0].begin);
+  REQUIRE(events[0].end <= events[1].end);
+}
+
+TEST_CASE("Tracer records pool chunks and tasks", "[trace]") {
+  auto& tracer = tutor::Tracer::Global();
+  tracer.Clear();
+  tracer.Start();
+  tutor::ThreadPool pool(3, false);
+  std::vector<double> v(100000, 1.0);
+  pool.ParallelFor(0, v.size(), 1000, [&](size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; ++i) v[i] *= 2;
+  });
+  auto a = RandomSpdMatrix<double>(64);
+  tutor::Cholesky_bt(pool, a.view(), 16);
+  tracer.Stop();
+
+  std::multiset<std::string> names;
+  for (const auto& e : AllEvents()) {
+    REQUIRE(e.begin <= e.end);
+    names.insert(e.name);
+  }
+  REQUIRE(names.count("ParallelFor") >= 100);
+  // 4 x 4 tiles: 4 potrf, 6 trsm, 6 syrk and 4 gemm tasks.
+  REQUIRE(names.count("potrf") == 4);
+  REQUIRE(names.count("trsm") == 6);
+  REQUIRE(names.count("syrk") == 6);
+  REQUIRE(names.count("gemm") == 4);
+
+  std::ostringstream os;
+  tracer.Write(os);
+  std::string json = os.str();
+  REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+  REQUIRE(Count(json, "{") == Count(json, "}"));
+  REQUIRE(Count(json, "\"ph\":\"X\"") == names.size());
+  // Workers have a track once they run something.
+  REQUIRE(Count(json, "pool worker") <= 2);
+  REQUIRE(Count(json, "\"dropped\":0") == 1);
+}
+
+TEST_CASE("Tracer escapes names", "[trace]") {
+  auto& tracer = tutor::Tracer::Global();
+  tracer.Clear();
+  tracer.Start();
+  { HPC_TUTOR_TRACE_SCOPE("a \"quoted\\ name\n"); }
+  tracer.Stop();
+  std::ostringstream os;
+  tracer.Write(os);
+  REQUIRE(os.str().find("\"a \\\"quoted\\\\ name\\u000a\"") !=
+          std::string::npos);
+}